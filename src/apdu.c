@@ -82,9 +82,25 @@ static int handle_git(void) {
 #define CLA 0x80  /// The only APDU class that will be used
 
 /// Packet indexes
-#define P1_FIRST       0x00u  /// First packet
-#define P1_NEXT        0x01u  /// Other packet
-#define P1_LAST_MARKER 0x80u  /// Last packet
+#define P1_FIRST          0x00u  /// First packet
+#define P1_NEXT           0x01u  /// Other packet
+#define P1_AUTHORIZED_KEY 0x02u  /// Single packet signed with the authorized key
+#define P1_LAST_MARKER    0x80u  /// Last packet
+
+/// Sub-commands of AUTHORIZE_BAKING
+#define P1_AUTHORIZE_REPLACE   0x00u  /// Authorize the key as the only authorized key
+#define P1_AUTHORIZE_ADD       0x01u  /// Add the key to the authorized keys
+#define P1_AUTHORIZE_COMPANION 0x02u  /// Register the key as the companion key
+
+/// Sub-commands of QUERY_AUTH_KEY_WITH_CURVE
+#define P1_AUTH_KEY_FIRST 0x00u  /// Get the first authorized key
+#define P1_AUTH_KEY_ALL   0x01u  /// Get all the authorized keys
+
+/// Sub-commands of QUERY_PERF
+#define P1_PERF_QUERY     0x00u  /// Get the phase timers
+#define P1_PERF_RESET     0x01u  /// Reset the phase timers, the latency histograms and the counts
+#define P1_PERF_HISTOGRAM 0x02u  /// Get the latency histogram of the instruction in P2
+#define P1_PERF_SIGNED    0x03u  /// Get the counts of signed baking messages of each kind
 
 int apdu_dispatcher(const command_t* cmd) {
     tz_exc exc = SW_OK;
@@ -145,14 +161,23 @@ int apdu_dispatcher(const command_t* cmd) {
         case INS_PROMPT_PUBLIC_KEY:
         case INS_AUTHORIZE_BAKING:
 
-            ASSERT_NO_P1;
+            if (cmd->ins == INS_AUTHORIZE_BAKING) {
+                TZ_ASSERT((cmd->p1 == P1_AUTHORIZE_REPLACE) || (cmd->p1 == P1_AUTHORIZE_ADD) ||
+                              (cmd->p1 == P1_AUTHORIZE_COMPANION),
+                          EXC_WRONG_PARAM);
+            } else {
+                ASSERT_NO_P1;
+            }
             READ_P2_DERIVATION_TYPE;
             READ_DATA;
 
             bool authorize = cmd->ins == INS_AUTHORIZE_BAKING;
             bool prompt = (cmd->ins == INS_AUTHORIZE_BAKING) || (cmd->ins == INS_PROMPT_PUBLIC_KEY);
+            bool add = authorize && (cmd->p1 == P1_AUTHORIZE_ADD);
+            bool companion = authorize && (cmd->p1 == P1_AUTHORIZE_COMPANION);
 
-            result = handle_get_public_key(&buf, derivation_type, authorize, prompt);
+            result =
+                handle_get_public_key(&buf, derivation_type, authorize, add, companion, prompt);
 
             break;
         case INS_DEAUTHORIZE:
@@ -193,11 +218,19 @@ int apdu_dispatcher(const command_t* cmd) {
             break;
         case INS_QUERY_AUTH_KEY_WITH_CURVE:
 
-            ASSERT_NO_P1;
             ASSERT_NO_P2;
             ASSERT_NO_DATA;
 
-            result = handle_query_auth_key_with_curve();
+            switch (cmd->p1) {
+                case P1_AUTH_KEY_FIRST:
+                    result = handle_query_auth_key_with_curve();
+                    break;
+                case P1_AUTH_KEY_ALL:
+                    result = handle_query_all_auth_keys();
+                    break;
+                default:
+                    TZ_FAIL(EXC_WRONG_PARAM);
+            }
 
             break;
         case INS_QUERY_MAIN_HWM:
@@ -217,6 +250,14 @@ int apdu_dispatcher(const command_t* cmd) {
 
             result = handle_query_all_hwm();
 
+            break;
+        case INS_QUERY_CHAINS_HWM:
+
+            ASSERT_NO_P1;
+            ASSERT_NO_DATA;
+
+            result = handle_query_chains_hwm(cmd->p2);
+
             break;
         case INS_SIGN:
         case INS_SIGN_WITH_HASH:
@@ -240,12 +281,44 @@ int apdu_dispatcher(const command_t* cmd) {
 
                     result = handle_sign(&buf, last, with_hash);
 
+                    break;
+                case P1_AUTHORIZED_KEY:
+
+                    // The message must fit in a single packet
+                    TZ_ASSERT((cmd->p1 & P1_LAST_MARKER) != 0, EXC_WRONG_PARAM);
+                    ASSERT_NO_P2;
+                    READ_DATA;
+
+                    result = handle_sign_with_authorized_key(&buf, cmd->ins == INS_SIGN_WITH_HASH);
+
                     break;
                 default:
                     TZ_FAIL(EXC_WRONG_PARAM);
             }
 
             break;
+        case INS_SIGN_BATCH:
+            TZ_ASSERT(os_global_pin_is_validated() == BOLOS_UX_OK, EXC_SECURITY);
+
+            ASSERT_NO_P1;
+            ASSERT_NO_P2;
+            READ_DATA;
+
+            result = handle_sign_batch(&buf);
+
+            break;
+#ifndef TARGET_NANOS
+        case INS_SIGN_WITH_COMPANION:
+            TZ_ASSERT(os_global_pin_is_validated() == BOLOS_UX_OK, EXC_SECURITY);
+
+            ASSERT_NO_P1;
+            ASSERT_NO_P2;
+            READ_DATA;
+
+            result = handle_sign_with_companion(&buf);
+
+            break;
+#endif
         case INS_HMAC:
 
             ASSERT_NO_P1;
@@ -255,6 +328,42 @@ int apdu_dispatcher(const command_t* cmd) {
             result = handle_hmac(&buf, derivation_type);
 
             break;
+        case INS_HMAC_BATCH:
+
+            ASSERT_NO_P1;
+            READ_P2_DERIVATION_TYPE;
+            READ_DATA;
+
+            result = handle_hmac_batch(&buf, derivation_type);
+
+            break;
+#ifdef HAVE_PERF_COUNTERS
+        case INS_QUERY_PERF:
+
+            ASSERT_NO_DATA;
+
+            switch (cmd->p1) {
+                case P1_PERF_QUERY:
+                    ASSERT_NO_P2;
+                    result = handle_query_perf();
+                    break;
+                case P1_PERF_RESET:
+                    ASSERT_NO_P2;
+                    result = handle_reset_perf();
+                    break;
+                case P1_PERF_HISTOGRAM:
+                    result = handle_query_perf_histogram(cmd->p2);
+                    break;
+                case P1_PERF_SIGNED:
+                    ASSERT_NO_P2;
+                    result = handle_query_perf_signed();
+                    break;
+                default:
+                    TZ_FAIL(EXC_WRONG_PARAM);
+            }
+
+            break;
+#endif
         default:
             TZ_FAIL(EXC_INVALID_INS);
     }
@@ -55,6 +55,11 @@
 #define INS_QUERY_AUTH_KEY_WITH_CURVE 0x0Du
 #define INS_HMAC                      0x0Eu
 #define INS_SIGN_WITH_HASH            0x0Fu
+#define INS_SIGN_BATCH                0x10u
+#define INS_QUERY_PERF                0x11u
+#define INS_HMAC_BATCH                0x12u
+#define INS_QUERY_CHAINS_HWM          0x13u
+#define INS_SIGN_WITH_COMPANION       0x14u
 
 /**
  * @brief Dispatch APDU command received to the right handler
@@ -21,39 +21,88 @@
 
 #include "globals.h"
 #include "keys.h"
+#include "os_pin.h"
 
-#define G global.apdu.u.hmac
+#define G            global.apdu.u.hmac
+#define G_hmac_cache global.hmac_key_cache
+
+/// Maximum number of messages of a batch, one hmac of each fits in a response
+#define MAX_HMAC_BATCH_SIZE 7u
+
+void clear_hmac_key_cache(void) {
+    explicit_bzero(&G_hmac_cache, sizeof(G_hmac_cache));
+}
 
 /**
- * @brief Generate the hmac of a message
+ * @brief Looks up the HMAC key of a given key in the cache
+ *
+ *        Marks the entry found as the most recently used.
+ *
+ * @param path_with_curve: bip32 path and curve of the key
+ * @return hmac_key_cache_entry_t *: the cache entry, NULL if not cached
+ */
+static hmac_key_cache_entry_t *find_hmac_key(
+    bip32_path_with_curve_t const *const path_with_curve) {
+    for (size_t i = 0u; i < HMAC_KEY_CACHE_SIZE; i++) {
+        hmac_key_cache_entry_t *const entry = &G_hmac_cache.entries[i];
+        if (entry->is_set && bip32_path_with_curve_eq(&entry->path_with_curve, path_with_curve)) {
+            G_hmac_cache.use_counter++;
+            entry->last_use = G_hmac_cache.use_counter;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Stores the HMAC key of a given key in the cache
+ *
+ *        Replaces a free entry if any, the least recently used one otherwise.
+ *
+ * @param path_with_curve: bip32 path and curve of the key
+ * @param hmac_key: HMAC key to store
+ */
+static void store_hmac_key(bip32_path_with_curve_t const *const path_with_curve,
+                           uint8_t const hmac_key[CX_SHA512_SIZE]) {
+    hmac_key_cache_entry_t *slot = &G_hmac_cache.entries[0];
+    for (size_t i = 0u; i < HMAC_KEY_CACHE_SIZE; i++) {
+        hmac_key_cache_entry_t *const entry = &G_hmac_cache.entries[i];
+        if (!entry->is_set) {
+            slot = entry;
+            break;
+        }
+        if (entry->last_use < slot->last_use) {
+            slot = entry;
+        }
+    }
+
+    G_hmac_cache.use_counter++;
+    slot->is_set = true;
+    slot->last_use = G_hmac_cache.use_counter;
+    memcpy(&slot->path_with_curve, path_with_curve, sizeof(slot->path_with_curve));
+    memcpy(slot->hashed_signed_hmac_key, hmac_key, sizeof(slot->hashed_signed_hmac_key));
+}
+
+/**
+ * @brief Get the hmac-key of a given key
  *
  *        The hmac-key is the signature of a fixed message signed with a given key
  *
- * @param out: result output
- * @param out_size: output size
+ * @param hmac_key: output pointer to the hmac-key, CX_SHA512_SIZE bytes long
  * @param state: hmac state
- * @param in: input message
- * @param in_size: input size
- * @param bip32_path: key path
- * @param derivation_type: key curve
+ * @param path_with_curve: bip32 path and curve of the key
  * @return tz_exc: exception, SW_OK if none
  */
-static inline tz_exc hmac(uint8_t *const out,
-                          size_t *const out_size,
-                          apdu_hmac_state_t *const state,
-                          uint8_t const *const in,
-                          size_t const in_size,
-                          bip32_path_with_curve_t const *const path_with_curve) {
+static tz_exc get_hmac_key(uint8_t const **const hmac_key,
+                           apdu_hmac_state_t *const state,
+                           bip32_path_with_curve_t const *const path_with_curve) {
     tz_exc exc = SW_OK;
     cx_err_t error = CX_OK;
 
-    TZ_ASSERT_NOT_NULL(out);
+    TZ_ASSERT_NOT_NULL(hmac_key);
     TZ_ASSERT_NOT_NULL(state);
-    TZ_ASSERT_NOT_NULL(in);
     TZ_ASSERT_NOT_NULL(path_with_curve);
 
-    TZ_ASSERT(*out_size >= CX_SHA256_SIZE, EXC_WRONG_LENGTH);
-
     // Pick a static, arbitrary SHA256 value based on a quote of Jesus.
     static uint8_t const key_sha256[] = {0x6c, 0x4e, 0x7e, 0x70, 0x6c, 0x54, 0xd3, 0x67,
                                          0xc8, 0x7a, 0x8d, 0x89, 0xc1, 0x6a, 0xdf, 0xe0,
@@ -62,31 +111,95 @@ static inline tz_exc hmac(uint8_t *const out,
 
     size_t signed_hmac_key_size = MAX_SIGNATURE_SIZE;
 
-    // Deterministically sign the SHA256 value to get something directly tied to the secret key.
-    CX_CHECK(sign(state->signed_hmac_key,
-                  &signed_hmac_key_size,
-                  path_with_curve,
-                  key_sha256,
-                  sizeof(key_sha256)));
-
-    // Hash the signed value with SHA512 to get a 64-byte key for HMAC.
-    cx_hash_sha512(state->signed_hmac_key,
-                   signed_hmac_key_size,
-                   state->hashed_signed_hmac_key,
-                   sizeof(state->hashed_signed_hmac_key));
-
-    *out_size = cx_hmac_sha256(state->hashed_signed_hmac_key,
-                               sizeof(state->hashed_signed_hmac_key),
-                               in,
-                               in_size,
-                               out,
-                               *out_size);
+    // Never keep a HMAC key while the device is locked
+    bool const use_cache = os_global_pin_is_validated() == BOLOS_UX_OK;
+    if (!use_cache) {
+        clear_hmac_key_cache();
+    }
+
+    hmac_key_cache_entry_t const *const entry = use_cache ? find_hmac_key(path_with_curve) : NULL;
+
+    if (entry != NULL) {
+        *hmac_key = entry->hashed_signed_hmac_key;
+    } else {
+        // Deterministically sign the SHA256 value to get something tied to the secret key.
+        CX_CHECK(sign(state->signed_hmac_key,
+                      &signed_hmac_key_size,
+                      path_with_curve,
+                      key_sha256,
+                      sizeof(key_sha256)));
+
+        // Hash the signed value with SHA512 to get a 64-byte key for HMAC.
+        cx_hash_sha512(state->signed_hmac_key,
+                       signed_hmac_key_size,
+                       state->hashed_signed_hmac_key,
+                       sizeof(state->hashed_signed_hmac_key));
+
+        if (use_cache) {
+            store_hmac_key(path_with_curve, state->hashed_signed_hmac_key);
+        }
+
+        *hmac_key = state->hashed_signed_hmac_key;
+    }
 
 end:
     TZ_CONVERT_CX();
     return exc;
 }
 
+/**
+ * @brief Generate the hmac of a message
+ *
+ * @param out: result output
+ * @param out_size: output size
+ * @param hmac_key: hmac-key, CX_SHA512_SIZE bytes long
+ * @param in: input message
+ * @param in_size: input size
+ * @return tz_exc: exception, SW_OK if none
+ */
+static inline tz_exc hmac(uint8_t *const out,
+                          size_t *const out_size,
+                          uint8_t const *const hmac_key,
+                          uint8_t const *const in,
+                          size_t const in_size) {
+    tz_exc exc = SW_OK;
+
+    TZ_ASSERT_NOT_NULL(out);
+    TZ_ASSERT_NOT_NULL(hmac_key);
+    TZ_ASSERT_NOT_NULL(in);
+
+    TZ_ASSERT(*out_size >= CX_SHA256_SIZE, EXC_WRONG_LENGTH);
+
+    *out_size = cx_hmac_sha256(hmac_key, CX_SHA512_SIZE, in, in_size, out, *out_size);
+
+end:
+    return exc;
+}
+
+/**
+ * @brief Reads the bip32 path of the hmac-key
+ *
+ * @param cdata: data containing the BIP32 path of the key
+ * @param derivation_type: derivation_type of the key
+ * @param hmac_key: output pointer to the hmac-key
+ * @return tz_exc: exception, SW_OK if none
+ */
+static tz_exc read_hmac_key(buffer_t *const cdata,
+                            derivation_type_t const derivation_type,
+                            uint8_t const **const hmac_key) {
+    tz_exc exc = SW_OK;
+
+    bip32_path_with_curve_t path_with_curve = {0};
+    path_with_curve.derivation_type = derivation_type;
+
+    TZ_ASSERT(read_bip32_path(cdata, &path_with_curve.bip32_path), EXC_WRONG_VALUES);
+
+    TZ_CHECK(get_hmac_key(hmac_key, &G, &path_with_curve));
+
+end:
+    return exc;
+}
+
 /**
  * Cdata:
  *   + Bip32 path: signing key path
@@ -94,23 +207,20 @@ end:
  */
 int handle_hmac(buffer_t *cdata, derivation_type_t derivation_type) {
     tz_exc exc = SW_OK;
+    uint8_t const *hmac_key = NULL;
 
     TZ_ASSERT_NOT_NULL(cdata);
 
     memset(&G, 0, sizeof(G));
 
-    bip32_path_with_curve_t path_with_curve = {0};
-    path_with_curve.derivation_type = derivation_type;
-
-    TZ_ASSERT(read_bip32_path(cdata, &path_with_curve.bip32_path), EXC_WRONG_VALUES);
+    TZ_CHECK(read_hmac_key(cdata, derivation_type, &hmac_key));
 
     size_t hmac_size = sizeof(G.hmac);
     TZ_CHECK(hmac(G.hmac,
                   &hmac_size,
-                  &G,
+                  hmac_key,
                   cdata->ptr + cdata->offset,
-                  cdata->size - cdata->offset,
-                  &path_with_curve));
+                  cdata->size - cdata->offset));
 
     uint8_t resp[CX_SHA256_SIZE] = {0};
 
@@ -121,3 +231,52 @@ int handle_hmac(buffer_t *cdata, derivation_type_t derivation_type) {
 end:
     return io_send_apdu_err(exc);
 }
+
+/**
+ * Cdata:
+ *   + Bip32 path: signing key path
+ *   + list:
+ *     + (1 byte) uint8: message length
+ *     + (length bytes) uint8 *: message
+ *
+ * Response:
+ *   + list:
+ *     + (32 bytes) uint8 *: hmac
+ */
+int handle_hmac_batch(buffer_t *cdata, derivation_type_t derivation_type) {
+    tz_exc exc = SW_OK;
+    uint8_t const *hmac_key = NULL;
+    uint8_t resp[MAX_HMAC_BATCH_SIZE * CX_SHA256_SIZE] = {0};
+    size_t offset = 0;
+    uint8_t message_len = 0;
+
+    TZ_ASSERT_NOT_NULL(cdata);
+
+    memset(&G, 0, sizeof(G));
+
+    TZ_CHECK(read_hmac_key(cdata, derivation_type, &hmac_key));
+
+    TZ_ASSERT(cdata->offset < cdata->size, EXC_WRONG_LENGTH);
+
+    while (cdata->offset < cdata->size) {
+        TZ_ASSERT(offset < sizeof(resp), EXC_WRONG_LENGTH);
+
+        TZ_ASSERT(buffer_read_u8(cdata, &message_len) && buffer_can_read(cdata, message_len),
+                  EXC_WRONG_LENGTH);
+
+        size_t hmac_size = sizeof(resp) - offset;
+        TZ_CHECK(hmac(resp + offset,
+                      &hmac_size,
+                      hmac_key,
+                      cdata->ptr + cdata->offset,
+                      message_len));
+        offset += hmac_size;
+
+        TZ_ASSERT(buffer_seek_cur(cdata, message_len), EXC_WRONG_LENGTH);
+    }
+
+    return io_send_response_pointer(resp, offset, SW_OK);
+
+end:
+    return io_send_apdu_err(exc);
+}
@@ -33,3 +33,18 @@
  * @return int: zero or positive integer if success, negative integer otherwise.
  */
 int handle_hmac(buffer_t *cdata, derivation_type_t derivation_type);
+
+/**
+ * @brief Signs with the HMAC protocol several messages with the same key
+ *
+ * @param cdata: data containing the BIP32 path of the key and the length-prefixed messages
+ * @param derivation_type: derivation_type of the key
+ * @return int: zero or positive integer if success, negative integer otherwise.
+ */
+int handle_hmac_batch(buffer_t *cdata, derivation_type_t derivation_type);
+
+/**
+ * @brief Wipes the HMAC keys cached in RAM
+ *
+ */
+void clear_hmac_key_cache(void);
@@ -54,6 +54,43 @@ static bool baking_ok(void) {
 
     TZ_CHECK(authorize_baking(global.path_with_curve.derivation_type,
                               &global.path_with_curve.bip32_path));
+    // The HWM of the other keys have been merged into the main HWM
+    invalidate_idle_screen_values(IDLE_SCREEN_AUTHORIZED_KEY | IDLE_SCREEN_HWM);
+    return pubkey_ok();
+
+end:
+    return io_send_apdu_err(exc);
+}
+
+/**
+ * @brief Adds the public key to the authorized keys
+ *
+ *        Sends apdu response with the public key
+ *
+ * @return true
+ */
+static bool baking_add_ok(void) {
+    tz_exc exc = SW_OK;
+
+    TZ_CHECK(add_baking_key(&global.path_with_curve));
+    invalidate_idle_screen_values(IDLE_SCREEN_AUTHORIZED_KEY);
+    return pubkey_ok();
+
+end:
+    return io_send_apdu_err(exc);
+}
+
+/**
+ * @brief Registers the public key as the companion key
+ *
+ *        Sends apdu response with the public key
+ *
+ * @return true
+ */
+static bool companion_ok(void) {
+    tz_exc exc = SW_OK;
+
+    TZ_CHECK(register_companion_key(&global.path_with_curve));
     return pubkey_ok();
 
 end:
@@ -67,14 +104,16 @@ end:
 int handle_get_public_key(buffer_t *cdata,
                           derivation_type_t derivation_type,
                           bool authorize,
+                          bool add,
+                          bool companion,
                           bool prompt) {
     tz_exc exc = SW_OK;
 
     TZ_ASSERT_NOT_NULL(cdata);
 
     global.path_with_curve.derivation_type = derivation_type;
-    if ((cdata->size == 0u) && authorize) {
-        TZ_ASSERT(copy_bip32_path_with_curve(&global.path_with_curve, &(g_hwm.baking_key)),
+    if ((cdata->size == 0u) && authorize && !companion) {
+        TZ_ASSERT(copy_bip32_path_with_curve(&global.path_with_curve, &(g_baking_key.key)),
                   EXC_MEMORY_ERROR);
     } else {
         TZ_ASSERT(read_bip32_path(cdata, &global.path_with_curve.bip32_path), EXC_WRONG_VALUES);
@@ -82,6 +121,14 @@ int handle_get_public_key(buffer_t *cdata,
 
     TZ_ASSERT(cdata->size == cdata->offset, EXC_WRONG_LENGTH);
 
+    // Refuse before the prompt rather than after the user validation
+    if (add) {
+        TZ_CHECK(guard_baking_key_addable(&global.path_with_curve));
+    }
+    if (companion) {
+        TZ_CHECK(guard_companion_key_registrable(&global.path_with_curve));
+    }
+
     if (!prompt) {
         return provide_pubkey(&global.path_with_curve);
     } else {
@@ -89,7 +136,11 @@ int handle_get_public_key(buffer_t *cdata,
         ui_callback_t cb;
         bool bake;
         if (authorize) {
-            cb = baking_ok;
+            if (companion) {
+                cb = companion_ok;
+            } else {
+                cb = add ? baking_add_ok : baking_ok;
+            }
             bake = true;
         } else {
             // INS_PROMPT_PUBLIC_KEY
@@ -29,10 +29,16 @@
  * @param cdata: data containing the BIP32 path of the key
  * @param derivation_type: derivation_type of the key
  * @param authorize: whether to authorize the address or not
+ * @param add: whether to add the address to the authorized ones instead
+ *        of replacing them
+ * @param companion: whether to register the address as the companion key
+ *        instead of authorizing it
  * @param prompt: whether to display address on screen or not
  * @return int: zero or positive integer if success, negative integer otherwise.
  */
 int handle_get_public_key(buffer_t *cdata,
                           derivation_type_t derivation_type,
                           bool authorize,
+                          bool add,
+                          bool companion,
                           bool prompt);
@@ -28,26 +28,45 @@
 #include "globals.h"
 #include "memory.h"
 #include "os_cx.h"
+#include "perf.h"
 #include "to_string.h"
 #include "ui.h"
 #include "write.h"
 
 #include <string.h>
 
+/**
+ * @brief Selects the HWM reported as the test HWM by `QUERY_ALL_HWM`
+ *
+ *        The HWM of the test chain signed last, or the initial `test`
+ *        HWM if no test chain has been signed since the last setup or
+ *        reset. With a single test chain, it is the HWM of this chain.
+ *
+ * @param hwm: high watermarks of an authorized key
+ * @return high_watermark_t const*: the test HWM
+ */
+static high_watermark_t const *select_reported_test_hwm(high_watermarks_t const *const hwm) {
+    if (hwm->last_chain >= CUSTOM_MIN(hwm->nb_chains, (uint8_t) HWM_CHAINS_SIZE)) {
+        return &hwm->test;
+    }
+    return &hwm->chains[hwm->last_chain].hwm;
+}
+
 int handle_query_all_hwm(void) {
     uint8_t resp[5u * sizeof(uint32_t)] = {0};
     size_t offset = 0;
+    high_watermark_t const *const test_hwm = select_reported_test_hwm(&g_baking_key.hwm);
 
-    write_u32_be(resp, offset, g_hwm.hwm.main.highest_level);
+    write_u32_be(resp, offset, g_baking_key.hwm.main.highest_level);
     offset += sizeof(uint32_t);
 
-    write_u32_be(resp, offset, g_hwm.hwm.main.highest_round);
+    write_u32_be(resp, offset, g_baking_key.hwm.main.highest_round);
     offset += sizeof(uint32_t);
 
-    write_u32_be(resp, offset, g_hwm.hwm.test.highest_level);
+    write_u32_be(resp, offset, test_hwm->highest_level);
     offset += sizeof(uint32_t);
 
-    write_u32_be(resp, offset, g_hwm.hwm.test.highest_round);
+    write_u32_be(resp, offset, test_hwm->highest_round);
     offset += sizeof(uint32_t);
 
     write_u32_be(resp, offset, g_hwm.main_chain_id.v);
@@ -56,14 +75,58 @@ int handle_query_all_hwm(void) {
     return io_send_response_pointer(resp, offset, SW_OK);
 }
 
+int handle_query_chains_hwm(uint8_t key_index) {
+    tz_exc exc = SW_OK;
+    uint8_t resp[(5u * sizeof(uint32_t)) + 1u + (HWM_CHAINS_SIZE * 3u * sizeof(uint32_t))] = {0};
+    size_t offset = 0;
+
+    TZ_ASSERT(key_index < MAX_BAKING_KEYS, EXC_WRONG_PARAM);
+
+    high_watermarks_t const *const hwm = &g_hwm.baking_keys[key_index].hwm;
+    uint8_t const nb_chains = CUSTOM_MIN(hwm->nb_chains, (uint8_t) HWM_CHAINS_SIZE);
+
+    write_u32_be(resp, offset, g_hwm.main_chain_id.v);
+    offset += sizeof(uint32_t);
+
+    write_u32_be(resp, offset, hwm->main.highest_level);
+    offset += sizeof(uint32_t);
+
+    write_u32_be(resp, offset, hwm->main.highest_round);
+    offset += sizeof(uint32_t);
+
+    write_u32_be(resp, offset, hwm->test.highest_level);
+    offset += sizeof(uint32_t);
+
+    write_u32_be(resp, offset, hwm->test.highest_round);
+    offset += sizeof(uint32_t);
+
+    resp[offset] = nb_chains;
+    offset += 1u;
+
+    for (uint8_t i = 0; i < nb_chains; i++) {
+        write_u32_be(resp, offset, hwm->chains[i].chain_id.v);
+        offset += sizeof(uint32_t);
+
+        write_u32_be(resp, offset, hwm->chains[i].hwm.highest_level);
+        offset += sizeof(uint32_t);
+
+        write_u32_be(resp, offset, hwm->chains[i].hwm.highest_round);
+        offset += sizeof(uint32_t);
+    }
+
+    return io_send_response_pointer(resp, offset, SW_OK);
+end:
+    return io_send_apdu_err(exc);
+}
+
 int handle_query_main_hwm(void) {
     uint8_t resp[2u * sizeof(uint32_t)] = {0};
     size_t offset = 0;
 
-    write_u32_be(resp, offset, g_hwm.hwm.main.highest_level);
+    write_u32_be(resp, offset, g_baking_key.hwm.main.highest_level);
     offset += sizeof(uint32_t);
 
-    write_u32_be(resp, offset, g_hwm.hwm.main.highest_round);
+    write_u32_be(resp, offset, g_baking_key.hwm.main.highest_round);
     offset += sizeof(uint32_t);
 
     return io_send_response_pointer(resp, offset, SW_OK);
@@ -74,14 +137,14 @@ int handle_query_auth_key(void) {
     uint8_t resp[1u + (MAX_BIP32_PATH * sizeof(uint32_t))] = {0};
     size_t offset = 0;
 
-    uint8_t const length = g_hwm.baking_key.bip32_path.length;
-    TZ_ASSERT(length <= NUM_ELEMENTS(g_hwm.baking_key.bip32_path.components), EXC_WRONG_LENGTH);
+    uint8_t const length = g_baking_key.key.bip32_path.length;
+    TZ_ASSERT(length <= NUM_ELEMENTS(g_baking_key.key.bip32_path.components), EXC_WRONG_LENGTH);
 
     resp[offset] = length;
     offset++;
 
     for (uint8_t i = 0; i < length; ++i) {
-        write_u32_be(resp, offset, g_hwm.baking_key.bip32_path.components[i]);
+        write_u32_be(resp, offset, g_baking_key.key.bip32_path.components[i]);
         offset += sizeof(uint32_t);
     }
 
@@ -95,24 +158,126 @@ int handle_query_auth_key_with_curve(void) {
     uint8_t resp[2u + (MAX_BIP32_PATH * sizeof(uint32_t))] = {0};
     size_t offset = 0;
 
-    uint8_t const length = g_hwm.baking_key.bip32_path.length;
-    TZ_ASSERT(length <= NUM_ELEMENTS(g_hwm.baking_key.bip32_path.components), EXC_WRONG_LENGTH);
+    uint8_t const length = g_baking_key.key.bip32_path.length;
+    TZ_ASSERT(length <= NUM_ELEMENTS(g_baking_key.key.bip32_path.components), EXC_WRONG_LENGTH);
 
-    TZ_ASSERT(DERIVATION_TYPE_IS_SET(g_hwm.baking_key.derivation_type),
+    TZ_ASSERT(DERIVATION_TYPE_IS_SET(g_baking_key.key.derivation_type),
               EXC_REFERENCED_DATA_NOT_FOUND);
 
-    resp[offset] = (uint8_t) g_hwm.baking_key.derivation_type;
+    resp[offset] = (uint8_t) g_baking_key.key.derivation_type;
     offset++;
 
     resp[offset] = length;
     offset++;
 
     for (uint8_t i = 0; i < length; ++i) {
-        write_u32_be(resp, offset, g_hwm.baking_key.bip32_path.components[i]);
+        write_u32_be(resp, offset, g_baking_key.key.bip32_path.components[i]);
+        offset += sizeof(uint32_t);
+    }
+
+    return io_send_response_pointer(resp, offset, SW_OK);
+end:
+    return io_send_apdu_err(exc);
+}
+
+int handle_query_all_auth_keys(void) {
+    tz_exc exc = SW_OK;
+    uint8_t resp[1u + (MAX_BAKING_KEYS * (2u + (MAX_BIP32_PATH * sizeof(uint32_t))))] = {0};
+    size_t offset = 1u;
+    uint8_t nb_keys = 0;
+
+    for (size_t i = 0; i < MAX_BAKING_KEYS; i++) {
+        bip32_path_with_curve_t const *const key = &g_hwm.baking_keys[i].key;
+        uint8_t const length = key->bip32_path.length;
+        if (length == 0u) {
+            continue;
+        }
+        TZ_ASSERT(length <= NUM_ELEMENTS(key->bip32_path.components), EXC_WRONG_LENGTH);
+
+        resp[offset] = (uint8_t) key->derivation_type;
+        offset++;
+
+        resp[offset] = length;
+        offset++;
+
+        for (uint8_t j = 0; j < length; ++j) {
+            write_u32_be(resp, offset, key->bip32_path.components[j]);
+            offset += sizeof(uint32_t);
+        }
+        nb_keys++;
+    }
+    resp[0] = nb_keys;
+
+    return io_send_response_pointer(resp, offset, SW_OK);
+end:
+    return io_send_apdu_err(exc);
+}
+
+#ifdef HAVE_PERF_COUNTERS
+int handle_query_perf(void) {
+    uint8_t resp[1u + (PERF_PHASE_COUNT * 4u * sizeof(uint32_t))] = {0};
+    size_t offset = 0;
+
+    resp[offset] = (uint8_t) PERF_PHASE_COUNT;
+    offset++;
+
+    for (uint8_t phase = 0; phase < (uint8_t) PERF_PHASE_COUNT; ++phase) {
+        perf_counter_t const *const counter = perf_get((perf_phase_t) phase);
+
+        write_u32_be(resp, offset, counter->min);
+        offset += sizeof(uint32_t);
+
+        write_u32_be(resp, offset, counter->max);
+        offset += sizeof(uint32_t);
+
+        write_u32_be(resp, offset, counter->sum);
+        offset += sizeof(uint32_t);
+
+        write_u32_be(resp, offset, counter->count);
         offset += sizeof(uint32_t);
     }
 
+    return io_send_response_pointer(resp, offset, SW_OK);
+}
+
+int handle_query_perf_histogram(uint8_t ins) {
+    tz_exc exc = SW_OK;
+    uint8_t resp[1u + (PERF_HISTOGRAM_NB_BUCKETS * sizeof(uint16_t))] = {0};
+    size_t offset = 0;
+
+    uint16_t const *const histogram = perf_get_histogram(ins);
+    TZ_ASSERT(histogram != NULL, EXC_WRONG_PARAM);
+
+    resp[offset] = (uint8_t) PERF_HISTOGRAM_NB_BUCKETS;
+    offset++;
+
+    for (uint8_t bucket = 0; bucket < PERF_HISTOGRAM_NB_BUCKETS; ++bucket) {
+        write_u16_be(resp, offset, histogram[bucket]);
+        offset += sizeof(uint16_t);
+    }
+
     return io_send_response_pointer(resp, offset, SW_OK);
 end:
     return io_send_apdu_err(exc);
 }
+
+int handle_query_perf_signed(void) {
+    uint8_t resp[1u + (PERF_SIGNED_COUNT * sizeof(uint32_t))] = {0};
+    size_t offset = 0;
+
+    resp[offset] = (uint8_t) PERF_SIGNED_COUNT;
+    offset++;
+
+    for (uint8_t kind = 0; kind < (uint8_t) PERF_SIGNED_COUNT; ++kind) {
+        write_u32_be(resp, offset, perf_get_signed((perf_signed_t) kind));
+        offset += sizeof(uint32_t);
+    }
+
+    return io_send_response_pointer(resp, offset, SW_OK);
+}
+
+int handle_reset_perf(void) {
+    perf_reset();
+    return io_send_sw(SW_OK);
+}
+#endif
@@ -26,19 +26,26 @@
 #include <stdint.h>
 
 /**
- * @brief Get the authorized key BIP32 path
+ * @brief Get the first authorized key BIP32 path
  *
  * @return int: zero or positive integer if success, negative integer otherwise.
  */
 int handle_query_auth_key(void);
 
 /**
- * @brief Get the authorized key BIP32 path and its curve
+ * @brief Get the first authorized key BIP32 path and its curve
  *
  * @return int: zero or positive integer if success, negative integer otherwise.
  */
 int handle_query_auth_key_with_curve(void);
 
+/**
+ * @brief Get the BIP32 path and the curve of all the authorized keys
+ *
+ * @return int: zero or positive integer if success, negative integer otherwise.
+ */
+int handle_query_all_auth_keys(void);
+
 /**
  * @brief Get the main HWM
  *
@@ -52,3 +59,45 @@ int handle_query_main_hwm(void);
  * @return int: zero or positive integer if success, negative integer otherwise.
  */
 int handle_query_all_hwm(void);
+
+/**
+ * @brief Get the main chain id, the main HWM, the initial test HWM and
+ *        the HWM of each test chain of an authorized key
+ *
+ * @param key_index: index of the authorized key
+ * @return int: zero or positive integer if success, negative integer otherwise.
+ */
+int handle_query_chains_hwm(uint8_t key_index);
+
+#ifdef HAVE_PERF_COUNTERS
+/**
+ * @brief Get the min, max, sum and count of each phase timer
+ *
+ * @return int: zero or positive integer if success, negative integer otherwise.
+ */
+int handle_query_perf(void);
+
+/**
+ * @brief Get the latency histogram of an instruction
+ *
+ * @param ins: instruction code
+ * @return int: zero or positive integer if success, negative integer otherwise.
+ */
+int handle_query_perf_histogram(uint8_t ins);
+
+/**
+ * @brief Get the number of signed blocks, pre-attestations,
+ *        attestations and attestations with DAL
+ *
+ * @return int: zero or positive integer if success, negative integer otherwise.
+ */
+int handle_query_perf_signed(void);
+
+/**
+ * @brief Reset the phase timers, the latency histograms and the counts
+ *        of signed baking messages
+ *
+ * @return int: zero or positive integer if success, negative integer otherwise.
+ */
+int handle_reset_perf(void);
+#endif
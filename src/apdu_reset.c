@@ -29,21 +29,26 @@
 #define G global.apdu.u.baking
 
 /**
- * @brief Resets main and test level
+ * @brief Resets main and test level of all the authorized keys
  *
  *        Rounds are also reset to 0
  *
  * @return true
  */
 static bool ok(void) {
-    g_hwm.hwm.main.highest_level = G.reset_level;
-    g_hwm.hwm.main.highest_round = 0;
-    g_hwm.hwm.main.had_attestation = false;
-    g_hwm.hwm.test.highest_level = G.reset_level;
-    g_hwm.hwm.test.highest_round = 0;
-    g_hwm.hwm.test.had_attestation = false;
+    for (size_t i = 0; i < MAX_BAKING_KEYS; i++) {
+        high_watermarks_t *const hwm = &g_hwm.baking_keys[i].hwm;
+        hwm->main.highest_level = G.reset_level;
+        hwm->main.highest_round = 0;
+        hwm->main.had_attestation = false;
+        hwm->test.highest_level = G.reset_level;
+        hwm->test.highest_round = 0;
+        hwm->test.had_attestation = false;
+        clear_hwm_chains(hwm);
+    }
 
     UPDATE_NVRAM;
+    invalidate_idle_screen_values(IDLE_SCREEN_HWM);
 
     // Send back the response, do not restart the event loop
     io_send_sw(SW_OK);
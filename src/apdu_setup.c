@@ -42,18 +42,27 @@
  * @return true
  */
 static bool ok(void) {
-    copy_bip32_path_with_curve(&(g_hwm.baking_key), &global.path_with_curve);
+    // The setup key becomes the only authorized key
+    memset(&g_hwm.baking_keys, 0, sizeof(g_hwm.baking_keys));
+    copy_bip32_path_with_curve(&(g_baking_key.key), &global.path_with_curve);
     g_hwm.main_chain_id = G.main_chain_id;
-    g_hwm.hwm.main.highest_level = G.hwm.main;
-    g_hwm.hwm.main.highest_round = 0;
-    g_hwm.hwm.main.had_attestation = false;
-    g_hwm.hwm.main.had_preattestation = false;
-    g_hwm.hwm.test.highest_level = G.hwm.test;
-    g_hwm.hwm.test.highest_round = 0;
-    g_hwm.hwm.test.had_attestation = false;
-    g_hwm.hwm.test.had_preattestation = false;
+    g_baking_key.hwm.main.highest_level = G.hwm.main;
+    g_baking_key.hwm.main.highest_round = 0;
+    g_baking_key.hwm.main.had_attestation = false;
+    g_baking_key.hwm.main.had_preattestation = false;
+    g_baking_key.hwm.test.highest_level = G.hwm.test;
+    g_baking_key.hwm.test.highest_round = 0;
+    g_baking_key.hwm.test.had_attestation = false;
+    g_baking_key.hwm.test.had_preattestation = false;
+    clear_hwm_chains(&g_baking_key.hwm);
 
     UPDATE_NVRAM;
+    invalidate_idle_screen_values(IDLE_SCREEN_ALL);
+
+    // Ignore derivation errors: the key will be cached on its first use
+    (void) cache_derived_key(&g_baking_key.key);
+    // Ignore calculation errors: the key will be derived on each use
+    (void) update_authorized_key_cache();
 
     provide_pubkey(&global.path_with_curve);
 
@@ -72,6 +81,8 @@ int handle_setup(buffer_t *cdata, derivation_type_t derivation_type) {
 
     TZ_ASSERT_NOT_NULL(cdata);
 
+    clear_derived_key_cache();
+
     global.path_with_curve.derivation_type = derivation_type;
 
     TZ_ASSERT(buffer_read_u32(cdata, &G.main_chain_id.v, BE) &&  // chain id
@@ -89,11 +100,21 @@ end:
 }
 
 int handle_deauthorize(void) {
-    memset(&(g_hwm.baking_key), 0, sizeof(g_hwm.baking_key));
-    UPDATE_NVRAM_VAR(baking_key);
+    // The HWM of all the keys is kept in the first one for the next authorized keys
+    for (size_t i = 1u; i < MAX_BAKING_KEYS; i++) {
+        merge_hwms(&g_baking_key.hwm, &g_hwm.baking_keys[i].hwm);
+    }
+    memset(&(g_baking_key.key), 0, sizeof(g_baking_key.key));
+    memset(&g_hwm.baking_keys[1], 0, (MAX_BAKING_KEYS - 1u) * sizeof(baking_key_t));
+    UPDATE_NVRAM_BAKING_KEYS;
+    clear_derived_key_cache();
+    // Ignore calculation errors: there is no key to derive
+    (void) update_authorized_key_cache();
+    // The HWM of the other keys have been merged into the main HWM
+    invalidate_idle_screen_values(IDLE_SCREEN_AUTHORIZED_KEY | IDLE_SCREEN_HWM);
 #ifdef HAVE_BAGL
     // Ignore calculation errors
-    calculate_idle_screen_authorized_key();
+    (void) build_idle_screen_values();
     refresh_screens();
 #endif  // HAVE_BAGL
 
@@ -26,9 +26,12 @@
 #include "globals.h"
 #include "keys.h"
 #include "memory.h"
+#include "perf.h"
 #include "to_string.h"
 #include "ui.h"
+#include "ui_consensus_key.h"
 #include "ui_delegation.h"
+#include "ui_staking.h"
 
 #include "cx.h"
 
@@ -38,6 +41,14 @@
 
 #define B2B_BLOCKBYTES 128u  /// blake2b hash size
 
+/// Maximum size of a message sent over several packets
+#define MAX_SIGN_MESSAGE_SIZE 1024u
+
+/// Size of the response of a batch signature
+#define SIGN_BATCH_RESPONSE_SIZE 255u
+/// Maximum number of messages signed in a batch, whatever the curve
+#define MAX_SIGN_BATCH_SIZE (SIGN_BATCH_RESPONSE_SIZE / (1u + MAX_SIGNATURE_SIZE))
+
 static int perform_signature(bool const send_hash);
 
 /**
@@ -45,7 +56,9 @@ static int perform_signature(bool const send_hash);
  *
  */
 static inline void clear_data(void) {
-    memset(&G, 0, sizeof(G));
+    // May hold a derived key
+    explicit_bzero(&G, sizeof(G));
+    global.apdu.sign_in_progress = false;
 }
 
 /**
@@ -101,13 +114,9 @@ static int baking_sign_complete(bool const send_hash) {
             ux_set_low_cost_display_mode(true);
 #endif
             result = perform_signature(send_hash);
-#ifdef HAVE_BAGL
-            // Ignore calculation errors
-            calculate_idle_screen_hwm();
-            // The HWM screen is not updated to avoid slowing down the
-            // application. Updating the HWM screen may slow down the
-            // next signing.
-#endif
+            // The HWM string is rebuilt when the device is idle, after the
+            // signature has been sent.
+            invalidate_idle_screen_values(IDLE_SCREEN_HWM);
             break;
 
         case MAGIC_BYTE_UNSAFE_OP: {
@@ -115,9 +124,9 @@ static int baking_sign_complete(bool const send_hash) {
 
             switch (G.maybe_ops.v.operation.tag) {
                 case OPERATION_TAG_DELEGATION:
-                    // Must be self-delegation signed by the *authorized* baking key
+                    // Must be self-delegation signed by an *authorized* baking key
                     TZ_ASSERT(
-                        bip32_path_with_curve_eq(&global.path_with_curve, &g_hwm.baking_key) &&
+                        (find_baking_key(&global.path_with_curve) != NULL) &&
                             // ops->signing is generated from G.bip32_path and G.curve
                             (COMPARE(G.maybe_ops.v.operation.source, G.maybe_ops.v.signing) == 0) &&
                             (COMPARE(G.maybe_ops.v.operation.destination, G.maybe_ops.v.signing) ==
@@ -126,11 +135,34 @@ static int baking_sign_complete(bool const send_hash) {
                     ui_callback_t const ok_c = send_hash ? sign_with_hash_ok : sign_without_hash_ok;
                     result = prompt_delegation(ok_c, sign_reject);
                     break;
+                case OPERATION_TAG_UPDATE_CONSENSUS_KEY:
+                    // Must update the consensus key of an *authorized* baking key
+                    TZ_ASSERT(
+                        (find_baking_key(&global.path_with_curve) != NULL) &&
+                            // ops->signing is generated from G.bip32_path and G.curve
+                            (COMPARE(G.maybe_ops.v.operation.source, G.maybe_ops.v.signing) == 0),
+                        EXC_SECURITY);
+                    result = prompt_update_consensus_key(
+                        send_hash ? sign_with_hash_ok : sign_without_hash_ok,
+                        sign_reject);
+                    break;
+                case OPERATION_TAG_TRANSACTION:
+                    // Only staking operations, from an *authorized* baking key to itself
+                    TZ_ASSERT(
+                        (find_baking_key(&global.path_with_curve) != NULL) &&
+                            // ops->signing is generated from G.bip32_path and G.curve
+                            (COMPARE(G.maybe_ops.v.operation.source, G.maybe_ops.v.signing) == 0) &&
+                            (COMPARE(G.maybe_ops.v.operation.destination, G.maybe_ops.v.signing) ==
+                             0),
+                        EXC_SECURITY);
+                    result = prompt_staking(send_hash ? sign_with_hash_ok : sign_without_hash_ok,
+                                            sign_reject);
+                    break;
                 case OPERATION_TAG_REVEAL:
                 case OPERATION_TAG_NONE:
                     // Reveal cases
                     TZ_ASSERT(
-                        bip32_path_with_curve_eq(&global.path_with_curve, &g_hwm.baking_key) &&
+                        (find_baking_key(&global.path_with_curve) != NULL) &&
                             // ops->signing is generated from G.bip32_path and G.curve
                             (COMPARE(G.maybe_ops.v.operation.source, G.maybe_ops.v.signing) == 0),
                         EXC_SECURITY);
@@ -147,9 +179,42 @@ static int baking_sign_complete(bool const send_hash) {
     return result;
 
 end:
+    clear_data();
     return io_send_apdu_err(exc);
 }
 
+/**
+ * @brief Parses a baking message: a block or a consensus operation
+ *
+ * @param buf: input buffer containing the message, after its magic byte
+ * @param magic_byte: magic byte of the message
+ * @param out: baking data output
+ * @return bool: returns false if it is invalid or is not a baking message
+ */
+static bool parse_baking_message(buffer_t *buf,
+                                 magic_byte_t const magic_byte,
+                                 parsed_baking_data_t *const out) {
+    bool result = false;
+
+    switch (magic_byte) {
+        case MAGIC_BYTE_PREATTESTATION:
+            PERF_MEASURE(PERF_PHASE_PARSE_CONSENSUS,
+                         result = parse_consensus_operation(buf, out, false));
+            break;
+        case MAGIC_BYTE_ATTESTATION:
+            PERF_MEASURE(PERF_PHASE_PARSE_CONSENSUS,
+                         result = parse_consensus_operation(buf, out, true));
+            break;
+        case MAGIC_BYTE_BLOCK:
+            PERF_MEASURE(PERF_PHASE_PARSE_BLOCK, result = parse_block(buf, out));
+            break;
+        default:
+            break;
+    }
+
+    return result;
+}
+
 /**
  * Cdata:
  *   + Bip32 path: signing key path
@@ -167,6 +232,8 @@ int select_signing_key(buffer_t *cdata, derivation_type_t derivation_type) {
 
     global.path_with_curve.derivation_type = derivation_type;
 
+    global.apdu.sign_in_progress = true;
+
     return io_send_sw(SW_OK);
 
 end:
@@ -185,59 +252,101 @@ int handle_sign(buffer_t *cdata, const bool last, const bool with_hash) {
 
     TZ_ASSERT(global.path_with_curve.bip32_path.length != 0u, EXC_WRONG_LENGTH_FOR_INS);
 
+    // Never resume a message already signed, rejected or refused
+    TZ_ASSERT(global.apdu.sign_in_progress, EXC_PARSE_ERROR);
+
     // Guard against overflow
     TZ_ASSERT(G.packet_index < 0xFFu, EXC_PARSE_ERROR);
     G.packet_index++;
 
-    // Only parse a single packet when baking
-    TZ_ASSERT(G.packet_index == 1u, EXC_PARSE_ERROR);
+    TZ_ASSERT(cdata->size <= (MAX_SIGN_MESSAGE_SIZE - G.total_size), EXC_WRONG_LENGTH);
+    G.total_size += cdata->size;
+
     if (G.packet_index == 1u) {
-        CX_CHECK(cx_hash_init_ex((cx_hash_t *) &G.hash_state.state, CX_BLAKE2B, SIGN_HASH_SIZE));
-    }
+        // The BLS signature does not sign the blake2b hash of the
+        // message: it is only computed if it is requested.
+#ifndef TARGET_NANOS
+        G.hash_message =
+            with_hash || (global.path_with_curve.derivation_type != DERIVATION_TYPE_BLS12_381);
+#else
+        G.hash_message = true;
+#endif
+        if (G.hash_message) {
+            CX_CHECK(
+                cx_hash_init_ex((cx_hash_t *) &G.hash_state.state, CX_BLAKE2B, SIGN_HASH_SIZE));
+        }
 
-    TZ_ASSERT(buffer_read_u8(cdata, &G.magic_byte), EXC_PARSE_ERROR);
-    bool is_attestation = false;
+        TZ_ASSERT(buffer_read_u8(cdata, &G.magic_byte), EXC_PARSE_ERROR);
+
+        if (G.magic_byte == MAGIC_BYTE_UNSAFE_OP) {
+            TZ_CHECK(
+                parse_operations_init(&G.maybe_ops.v, &global.path_with_curve, &G.parse_state));
+        }
+
+#ifndef TARGET_NANOS
+        // The BLS signature uses its own hash function, prefixed by the public key.
+        // The key is derived here at most, not again to sign.
+        if (global.path_with_curve.derivation_type == DERIVATION_TYPE_BLS12_381) {
+            uint8_t compressed_pubkey[BLS_COMPRESSED_PK_LEN] = {0};
+            CX_CHECK(load_bls_signing_key(&G.bls_signing_key,
+                                          &global.path_with_curve,
+                                          compressed_pubkey));
+            CX_CHECK(bls_hash_to_field_init(&G.bls_hash_state, compressed_pubkey));
+        }
+#endif
+    } else {
+        // Only parse a single packet when baking
+        TZ_ASSERT(G.magic_byte == MAGIC_BYTE_UNSAFE_OP, EXC_PARSE_ERROR);
+    }
 
     switch (G.magic_byte) {
         case MAGIC_BYTE_PREATTESTATION:
-            is_attestation = false;
-            TZ_ASSERT(parse_consensus_operation(cdata, &G.parsed_baking_data, is_attestation),
-                      EXC_PARSE_ERROR);
-            break;
         case MAGIC_BYTE_ATTESTATION:
-            is_attestation = true;
-            TZ_ASSERT(parse_consensus_operation(cdata, &G.parsed_baking_data, is_attestation),
-                      EXC_PARSE_ERROR);
-            break;
         case MAGIC_BYTE_BLOCK:
-            TZ_ASSERT(parse_block(cdata, &G.parsed_baking_data), EXC_PARSE_ERROR);
+            TZ_ASSERT(parse_baking_message(cdata, G.magic_byte, &G.parsed_baking_data),
+                      EXC_PARSE_ERROR);
             break;
         case MAGIC_BYTE_UNSAFE_OP:
-            // Parse the operation. It will be verified in `baking_sign_complete`.
-            TZ_CHECK(parse_operations(cdata, &G.maybe_ops.v, &global.path_with_curve));
+            // Parse the operation, resuming from the previous packet.
+            // It will be verified in `baking_sign_complete`.
+            PERF_MEASURE(PERF_PHASE_PARSE_OPERATIONS,
+                         TZ_CHECK(parse_operations(cdata, &G.maybe_ops.v)));
             break;
         default:
             TZ_FAIL(EXC_PARSE_ERROR);
     }
 
-    CX_CHECK(
-        cx_hash_no_throw((cx_hash_t *) &G.hash_state.state, 0, cdata->ptr, cdata->size, NULL, 0));
+    if (G.hash_message) {
+        PERF_MEASURE(PERF_PHASE_HASH_UPDATE,
+                     CX_CHECK(cx_hash_no_throw(
+                         (cx_hash_t *) &G.hash_state.state, 0, cdata->ptr, cdata->size, NULL, 0)));
+    }
 
 #ifndef TARGET_NANOS
-    memmove(G.message, cdata->ptr, cdata->size);
-    G.message_len = cdata->size;
+    if (global.path_with_curve.derivation_type == DERIVATION_TYPE_BLS12_381) {
+        CX_CHECK(bls_hash_to_field_update(&G.bls_hash_state, cdata->ptr, cdata->size));
+    }
 #endif
 
     if (last) {
-        CX_CHECK(cx_hash_no_throw((cx_hash_t *) &G.hash_state.state,
-                                  CX_LAST,
-                                  NULL,
-                                  0,
-                                  G.final_hash,
-                                  sizeof(G.final_hash)));
+        // The hash cannot be sent if it has not been computed from the first packet
+        TZ_ASSERT(G.hash_message || !with_hash, EXC_WRONG_PARAM);
+
+        if (G.hash_message) {
+            PERF_MEASURE(PERF_PHASE_HASH_FINAL,
+                         CX_CHECK(cx_hash_no_throw((cx_hash_t *) &G.hash_state.state,
+                                                   CX_LAST,
+                                                   NULL,
+                                                   0,
+                                                   G.final_hash,
+                                                   sizeof(G.final_hash))));
+        }
 
         G.maybe_ops.is_valid = parse_operations_final(&G.parse_state, &G.maybe_ops.v);
 
+        // The message is kept until the user answers, but no packet may follow
+        global.apdu.sign_in_progress = false;
+
         return baking_sign_complete(with_hash);
     } else {
         return io_send_sw(SW_OK);
@@ -245,9 +354,284 @@ int handle_sign(buffer_t *cdata, const bool last, const bool with_hash) {
 
 end:
     TZ_CONVERT_CX();
+    // May hold a derived key and the state of a refused message
+    clear_data();
+    return io_send_apdu_err(exc);
+}
+
+/**
+ * Cdata:
+ *   + (max-size) uint8 *: consensus operation or block
+ */
+int handle_sign_with_authorized_key(buffer_t *cdata, const bool with_hash) {
+    tz_exc exc = SW_OK;
+    uint8_t magic_byte = 0;
+
+    TZ_ASSERT_NOT_NULL(cdata);
+
+    clear_data();
+
+    TZ_ASSERT(g_baking_key.key.bip32_path.length != 0u, EXC_SECURITY);
+    TZ_ASSERT(copy_bip32_path_with_curve(&global.path_with_curve, &g_baking_key.key),
+              EXC_MEMORY_ERROR);
+
+    // Operations may need a user validation and can span over several packets
+    TZ_ASSERT(buffer_peek(cdata, &magic_byte), EXC_PARSE_ERROR);
+    TZ_ASSERT((magic_byte == (uint8_t) MAGIC_BYTE_BLOCK) ||
+                  (magic_byte == (uint8_t) MAGIC_BYTE_PREATTESTATION) ||
+                  (magic_byte == (uint8_t) MAGIC_BYTE_ATTESTATION),
+              EXC_PARSE_ERROR);
+
+    global.apdu.sign_in_progress = true;
+
+    return handle_sign(cdata, true, with_hash);
+
+end:
+    return io_send_apdu_err(exc);
+}
+
+/**
+ * @brief Moves a chain to the end of the chains signed by a batch
+ *
+ *        Adds it if it is not there yet, so that the chains end up in
+ *        the order of their last signature.
+ *
+ * @param chains: chains signed by the batch
+ * @param nb_chains: number of chains, updated
+ * @param chain_id: chain of the message signed
+ */
+static void add_batch_chain(chain_id_t chains[static MAX_SIGN_BATCH_SIZE],
+                            size_t *const nb_chains,
+                            chain_id_t const chain_id) {
+    size_t i = 0;
+
+    while ((i < *nb_chains) && (chains[i].v != chain_id.v)) {
+        i++;
+    }
+    if (i < *nb_chains) {
+        memmove(&chains[i], &chains[i + 1u], (*nb_chains - i - 1u) * sizeof(chain_id_t));
+        (*nb_chains)--;
+    }
+    chains[*nb_chains] = chain_id;
+    (*nb_chains)++;
+}
+
+/**
+ * Cdata:
+ *   + list:
+ *     + (1 byte) uint8: message length
+ *     + (length bytes) uint8 *: consensus operation or block
+ *
+ * Response:
+ *   + list:
+ *     + (1 byte) uint8: signature length
+ *     + (length bytes) uint8 *: signature
+ */
+int handle_sign_batch(buffer_t *cdata) {
+    tz_exc exc = SW_OK;
+    cx_err_t error = CX_OK;
+
+    // Keep the HWM to restore it if any message is refused
+    high_watermarks_t hwm_backup;
+    memmove(&hwm_backup, &g_baking_key.hwm, sizeof(hwm_backup));
+
+    uint8_t resp[SIGN_BATCH_RESPONSE_SIZE] = {0};
+    size_t offset = 0;
+    size_t nb_messages = 0;
+    chain_id_t chains[MAX_SIGN_BATCH_SIZE] = {0};
+    size_t nb_chains = 0;
+    uint8_t message_len = 0;
+    uint8_t magic_byte = 0;
+    buffer_t message = {0};
+    uint8_t const *to_sign = NULL;
+    size_t to_sign_len = 0;
+    size_t signature_size = 0;
+    bool hash_message = true;
+
+    TZ_ASSERT_NOT_NULL(cdata);
+
+    clear_data();
+
+    TZ_ASSERT(g_baking_key.key.bip32_path.length != 0u, EXC_SECURITY);
+    TZ_ASSERT(copy_bip32_path_with_curve(&global.path_with_curve, &g_baking_key.key),
+              EXC_MEMORY_ERROR);
+
+#ifndef TARGET_NANOS
+    // The BLS signature does not sign the blake2b hash of the messages:
+    // it signs the messages with its own hash function.
+    hash_message = (global.path_with_curve.derivation_type != DERIVATION_TYPE_BLS12_381);
+#endif
+
+    TZ_ASSERT(cdata->offset < cdata->size, EXC_WRONG_LENGTH);
+
+#ifdef TARGET_NANOS
+    // To be efficient, the signing needs a low-cost display
+    ux_set_low_cost_display_mode(true);
+#endif
+
+    while (cdata->offset < cdata->size) {
+        TZ_ASSERT(nb_messages < MAX_SIGN_BATCH_SIZE, EXC_WRONG_LENGTH);
+        nb_messages++;
+
+        TZ_ASSERT(buffer_read_u8(cdata, &message_len) && buffer_can_read(cdata, message_len),
+                  EXC_WRONG_LENGTH);
+        message.ptr = cdata->ptr + cdata->offset;
+        message.size = message_len;
+        message.offset = 0;
+        TZ_ASSERT(buffer_seek_cur(cdata, message_len), EXC_WRONG_LENGTH);
+
+        memset(&G.parsed_baking_data, 0, sizeof(G.parsed_baking_data));
+        TZ_ASSERT(buffer_read_u8(&message, &magic_byte) &&
+                      parse_baking_message(&message,
+                                           (magic_byte_t) magic_byte,
+                                           &G.parsed_baking_data),
+                  EXC_PARSE_ERROR);
+
+        // Checked against the HWM updated by the previous messages of the batch
+        TZ_CHECK(guard_baking_authorized(&G.parsed_baking_data, &global.path_with_curve));
+        TZ_CHECK(update_high_water_mark(&G.parsed_baking_data, &global.path_with_curve));
+        add_batch_chain(chains, &nb_chains, G.parsed_baking_data.chain_id);
+
+        to_sign = message.ptr;
+        to_sign_len = message.size;
+        if (hash_message) {
+            CX_CHECK(
+                cx_hash_init_ex((cx_hash_t *) &G.hash_state.state, CX_BLAKE2B, SIGN_HASH_SIZE));
+            PERF_MEASURE(PERF_PHASE_HASH_FINAL,
+                         CX_CHECK(cx_hash_no_throw((cx_hash_t *) &G.hash_state.state,
+                                                   CX_LAST,
+                                                   message.ptr,
+                                                   message.size,
+                                                   G.final_hash,
+                                                   sizeof(G.final_hash))));
+            to_sign = G.final_hash;
+            to_sign_len = sizeof(G.final_hash);
+        }
+
+        signature_size = MAX_SIGNATURE_SIZE;
+        PERF_MEASURE(PERF_PHASE_SIGN,
+                     CX_CHECK(sign(resp + offset + 1u,
+                                   &signature_size,
+                                   &global.path_with_curve,
+                                   to_sign,
+                                   to_sign_len)));
+        resp[offset] = (uint8_t) signature_size;
+        offset += 1u + signature_size;
+
+        PERF_COUNT_SIGNED(&G.parsed_baking_data);
+    }
+
+    // The HWM of the whole batch is stored at once, a record per chain
+    for (size_t i = 0; i < nb_chains; i++) {
+        UPDATE_NVRAM_HWM(baking_key_index(&g_baking_key), chains[i]);
+    }
+
+    clear_data();
+
+    invalidate_idle_screen_values(IDLE_SCREEN_HWM);
+
+    return io_send_response_pointer(resp, offset, SW_OK);
+
+end:
+    TZ_CONVERT_CX();
+    // None of the signatures is sent: the HWM must not move
+    memmove(&g_baking_key.hwm, &hwm_backup, sizeof(g_baking_key.hwm));
+    explicit_bzero(resp, sizeof(resp));
     return io_send_apdu_err(exc);
 }
 
+#ifndef TARGET_NANOS
+/**
+ * Cdata:
+ *   + Bip32 path: companion key path
+ *   + (max-size) uint8 *: attestation
+ *
+ * Response:
+ *   + (1 byte) uint8: consensus signature length
+ *   + (length bytes) uint8 *: consensus signature
+ *   + (1 byte) uint8: companion signature length
+ *   + (length bytes) uint8 *: companion signature
+ */
+int handle_sign_with_companion(buffer_t *cdata) {
+    tz_exc exc = SW_OK;
+    cx_err_t error = CX_OK;
+
+    uint8_t resp[2u * (1u + MAX_SIGNATURE_SIZE)] = {0};
+    size_t offset = 0;
+    bip32_path_with_curve_t companion_key = {0};
+    uint8_t magic_byte = 0;
+    buffer_t message = {0};
+    size_t signature_size = 0;
+
+    TZ_ASSERT_NOT_NULL(cdata);
+
+    clear_data();
+
+    // The companion key is only used along with a tz4 consensus key
+    TZ_ASSERT(g_baking_key.key.bip32_path.length != 0u, EXC_SECURITY);
+    TZ_ASSERT(g_baking_key.key.derivation_type == DERIVATION_TYPE_BLS12_381, EXC_SECURITY);
+    TZ_ASSERT(copy_bip32_path_with_curve(&global.path_with_curve, &g_baking_key.key),
+              EXC_MEMORY_ERROR);
+
+    companion_key.derivation_type = DERIVATION_TYPE_BLS12_381;
+    TZ_ASSERT(read_bip32_path(cdata, &companion_key.bip32_path), EXC_WRONG_VALUES);
+    // Only the companion key registered by the user, never a baking key
+    TZ_CHECK(guard_companion_key(&companion_key));
+
+    message.ptr = cdata->ptr + cdata->offset;
+    message.size = cdata->size - cdata->offset;
+    message.offset = 0;
+
+    TZ_ASSERT(buffer_read_u8(&message, &magic_byte) &&
+                  (magic_byte == (uint8_t) MAGIC_BYTE_ATTESTATION) &&
+                  parse_baking_message(&message,
+                                       (magic_byte_t) magic_byte,
+                                       &G.parsed_baking_data),
+              EXC_PARSE_ERROR);
+
+    // Both signatures are covered by a single check and a single HWM write
+    TZ_CHECK(guard_baking_authorized(&G.parsed_baking_data, &global.path_with_curve));
+    TZ_CHECK(write_high_water_mark(&G.parsed_baking_data, &global.path_with_curve));
+
+    // The BLS signature uses its own hash function: the attestation is signed as is
+    signature_size = MAX_SIGNATURE_SIZE;
+    PERF_MEASURE(PERF_PHASE_SIGN,
+                 CX_CHECK(sign(resp + offset + 1u,
+                               &signature_size,
+                               &global.path_with_curve,
+                               message.ptr,
+                               message.size)));
+    resp[offset] = (uint8_t) signature_size;
+    offset += 1u + signature_size;
+
+    signature_size = MAX_SIGNATURE_SIZE;
+    PERF_MEASURE(PERF_PHASE_SIGN,
+                 CX_CHECK(sign(resp + offset + 1u,
+                               &signature_size,
+                               &companion_key,
+                               message.ptr,
+                               message.size)));
+    resp[offset] = (uint8_t) signature_size;
+    offset += 1u + signature_size;
+
+    // A single attestation, whatever the number of signatures
+    PERF_COUNT_SIGNED(&G.parsed_baking_data);
+
+    clear_data();
+
+    invalidate_idle_screen_values(IDLE_SCREEN_HWM);
+
+    int result = 0;
+    PERF_MEASURE(PERF_PHASE_APDU_SEND, result = io_send_response_pointer(resp, offset, SW_OK));
+    return result;
+
+end:
+    TZ_CONVERT_CX();
+    explicit_bzero(resp, sizeof(resp));
+    return io_send_apdu_err(exc);
+}
+#endif
+
 /**
  * @brief Perfoms the signature of the read message
  *
@@ -264,23 +648,15 @@ static int perform_signature(bool const send_hash) {
 
     TZ_ASSERT(os_global_pin_is_validated() == BOLOS_UX_OK, EXC_SECURITY);
 
-    TZ_CHECK(write_high_water_mark(&G.parsed_baking_data));
+    // Manager operations carry no chain id nor level: they must not
+    // touch the HWM, nor add a test chain to its table.
+    if (G.magic_byte != MAGIC_BYTE_UNSAFE_OP) {
+        TZ_CHECK(write_high_water_mark(&G.parsed_baking_data, &global.path_with_curve));
+    }
 
     uint8_t resp[SIGN_HASH_SIZE + MAX_SIGNATURE_SIZE] = {0};
     size_t offset = 0;
 
-    uint8_t *message = G.final_hash;
-    size_t message_len = sizeof(G.final_hash);
-
-#ifndef TARGET_NANOS
-    // The BLS signature uses its own hash function.
-    // The entire message must be stored in `G.message`.
-    if (global.path_with_curve.derivation_type == DERIVATION_TYPE_BLS12_381) {
-        message = G.message;
-        message_len = G.message_len;
-    }
-#endif
-
     if (send_hash) {
         memcpy(resp + offset, G.final_hash, sizeof(G.final_hash));
         offset += sizeof(G.final_hash);
@@ -288,15 +664,49 @@ static int perform_signature(bool const send_hash) {
 
     size_t signature_size = MAX_SIGNATURE_SIZE;
 
-    CX_CHECK(sign(resp + offset, &signature_size, &global.path_with_curve, message, message_len));
+#ifndef TARGET_NANOS
+    // The BLS signature uses its own hash function.
+    // The message has been hashed to the field packet by packet.
+    if (global.path_with_curve.derivation_type == DERIVATION_TYPE_BLS12_381) {
+        uint8_t bls_hash[BLS_FIELD_HASH_LEN] = {0};
+        CX_CHECK(bls_hash_to_field_final(&G.bls_hash_state, bls_hash));
+        PERF_MEASURE(PERF_PHASE_SIGN,
+                     CX_CHECK(sign_bls_field_hash(resp + offset,
+                                                  &signature_size,
+                                                  &global.path_with_curve,
+                                                  &G.bls_signing_key,
+                                                  bls_hash)));
+    } else {
+        PERF_MEASURE(PERF_PHASE_SIGN,
+                     CX_CHECK(sign(resp + offset,
+                                   &signature_size,
+                                   &global.path_with_curve,
+                                   G.final_hash,
+                                   sizeof(G.final_hash))));
+    }
+#else
+    PERF_MEASURE(PERF_PHASE_SIGN,
+                 CX_CHECK(sign(resp + offset,
+                               &signature_size,
+                               &global.path_with_curve,
+                               G.final_hash,
+                               sizeof(G.final_hash))));
+#endif
 
     offset += signature_size;
 
+    if (G.magic_byte != MAGIC_BYTE_UNSAFE_OP) {
+        PERF_COUNT_SIGNED(&G.parsed_baking_data);
+    }
+
     clear_data();
 
-    return io_send_response_pointer(resp, offset, SW_OK);
+    int result = 0;
+    PERF_MEASURE(PERF_PHASE_APDU_SEND, result = io_send_response_pointer(resp, offset, SW_OK));
+    return result;
 
 end:
     TZ_CONVERT_CX();
+    clear_data();
     return io_send_apdu_err(exc);
 }
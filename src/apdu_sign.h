@@ -41,3 +41,41 @@ int select_signing_key(buffer_t *cdata, derivation_type_t derivation_type);
  * @return int: zero or positive integer if success, negative integer otherwise.
  */
 int handle_sign(buffer_t *cdata, bool last, bool with_hash);
+
+/**
+ * @brief Parse and signs a consensus operation or a block with the
+ *        authorized key
+ *
+ *        Avoids selecting the signing key in a previous exchange
+ *
+ * @param cdata: data containing the whole message to sign
+ * @param with_hash: whether the hash of the message is requested or not
+ * @return int: zero or positive integer if success, negative integer otherwise.
+ */
+int handle_sign_with_authorized_key(buffer_t *cdata, bool with_hash);
+
+/**
+ * @brief Parse and signs several consensus operations or blocks with
+ *        the authorized key
+ *
+ *        Messages are checked in order against the HWM, which is
+ *        stored in NVRAM once all of them have been accepted
+ *
+ * @param cdata: data containing the length-prefixed messages to sign
+ * @return int: zero or positive integer if success, negative integer otherwise.
+ */
+int handle_sign_batch(buffer_t *cdata);
+
+#ifndef TARGET_NANOS
+/**
+ * @brief Parse and signs an attestation with both the authorized key
+ *        and the BLS companion key registered with it
+ *
+ *        The attestation is checked against the HWM and the HWM is
+ *        stored once for both signatures
+ *
+ * @param cdata: data containing the companion key path and the attestation
+ * @return int: zero or positive integer if success, negative integer otherwise.
+ */
+int handle_sign_with_companion(buffer_t *cdata);
+#endif
@@ -26,6 +26,7 @@
 #include "globals.h"
 #include "keys.h"
 #include "memory.h"
+#include "perf.h"
 #include "to_string.h"
 #include "ui.h"
 
@@ -37,16 +38,20 @@ bool is_valid_level(level_t lvl) {
     return !(lvl & 0xC0000000);
 }
 
-tz_exc write_high_water_mark(parsed_baking_data_t const *const in) {
+tz_exc update_high_water_mark(parsed_baking_data_t const *const in,
+                              bip32_path_with_curve_t const *const key) {
     tz_exc exc = SW_OK;
 
     TZ_ASSERT_NOT_NULL(in);
 
     TZ_ASSERT(is_valid_level(in->level), EXC_WRONG_VALUES);
 
+    baking_key_t *const baking_key = find_baking_key(key);
+    TZ_ASSERT(baking_key != NULL, EXC_SECURITY);
+
     // If the chain matches the main chain *or* the main chain is not set, then use 'main' HWM.
-    high_watermark_t *dest = select_hwm_by_chain(in->chain_id);
-    TZ_ASSERT_NOT_NULL(dest);
+    high_watermark_t *dest = select_or_add_hwm_by_chain(&baking_key->hwm, in->chain_id);
+    TZ_ASSERT(dest != NULL, EXC_WRONG_VALUES);
 
     if ((in->level > dest->highest_level) || (in->round > dest->highest_round)) {
         dest->had_attestation = false;
@@ -57,41 +62,181 @@ tz_exc write_high_water_mark(parsed_baking_data_t const *const in) {
     dest->had_attestation |= in->type == BAKING_TYPE_ATTESTATION;
     dest->had_preattestation |= in->type == BAKING_TYPE_PREATTESTATION;
 
-    UPDATE_NVRAM_VAR(hwm);
+end:
+    return exc;
+}
+
+tz_exc write_high_water_mark(parsed_baking_data_t const *const in,
+                             bip32_path_with_curve_t const *const key) {
+    tz_exc exc = SW_OK;
+
+    TZ_CHECK(update_high_water_mark(in, key));
+
+    size_t const key_index = baking_key_index(find_baking_key(key));
+    PERF_MEASURE(PERF_PHASE_NVM_WRITE, UPDATE_NVRAM_HWM(key_index, in->chain_id));
 
 end:
     return exc;
 }
 
+/**
+ * @brief Writes the authorized keys and all their HWM in NVRAM
+ *
+ *        They supersede the HWM journal, whose records would otherwise
+ *        be replayed over the HWM of the new key of their slot.
+ */
+static void write_baking_keys(void) {
+    UPDATE_NVRAM_BAKING_KEYS;
+    // Ignore derivation errors: the key will be cached on its first use
+    (void) cache_derived_key(&g_baking_key.key);
+    // Ignore calculation errors: the key will be derived on each use
+    (void) update_authorized_key_cache();
+}
+
 tz_exc authorize_baking(derivation_type_t const derivation_type,
                         bip32_path_t const *const bip32_path) {
     tz_exc exc = SW_OK;
+    bip32_path_with_curve_t key;
 
     TZ_ASSERT_NOT_NULL(bip32_path);
 
-    TZ_ASSERT(bip32_path->length <= NUM_ELEMENTS(g_hwm.baking_key.bip32_path.components),
-              EXC_WRONG_LENGTH);
+    TZ_ASSERT(bip32_path->length <= NUM_ELEMENTS(key.bip32_path.components), EXC_WRONG_LENGTH);
 
     if (bip32_path->length != 0u) {
-        g_hwm.baking_key.derivation_type = derivation_type;
-        copy_bip32_path(&g_hwm.baking_key.bip32_path, bip32_path);
-        UPDATE_NVRAM_VAR(baking_key);
+        key.derivation_type = derivation_type;
+        copy_bip32_path(&key.bip32_path, bip32_path);
+
+        baking_key_t *baking_key = find_baking_key(&key);
+        if (baking_key == NULL) {
+            // The new key replaces the first key
+            baking_key = &g_baking_key;
+            memmove(&g_baking_key.key, &key, sizeof(key));
+        }
+        // The removed keys may be authorized again: their HWM is kept in the one of the key
+        for (size_t i = 0; i < MAX_BAKING_KEYS; i++) {
+            if (&g_hwm.baking_keys[i] != baking_key) {
+                merge_hwms(&baking_key->hwm, &g_hwm.baking_keys[i].hwm);
+            }
+        }
+        if (baking_key != &g_baking_key) {
+            memmove(&g_baking_key, baking_key, sizeof(baking_key_t));
+        }
+        memset(&g_hwm.baking_keys[1], 0, (MAX_BAKING_KEYS - 1u) * sizeof(baking_key_t));
+        write_baking_keys();
     }
 
 end:
     return exc;
 }
 
+/**
+ * @brief Gets the slot where a key would be added to the authorized keys
+ *
+ * @param key: bip32 path and curve of the key
+ * @return baking_key_t*: slot of the key if it is already authorized,
+ *         first free slot otherwise, NULL if there is none
+ */
+static baking_key_t *find_baking_key_slot(bip32_path_with_curve_t const *const key) {
+    baking_key_t *baking_key = find_baking_key(key);
+
+    for (size_t i = 0; (baking_key == NULL) && (i < MAX_BAKING_KEYS); i++) {
+        if (g_hwm.baking_keys[i].key.bip32_path.length == 0u) {
+            baking_key = &g_hwm.baking_keys[i];
+        }
+    }
+    return baking_key;
+}
+
+tz_exc guard_baking_key_addable(bip32_path_with_curve_t const *const key) {
+    tz_exc exc = SW_OK;
+
+    TZ_ASSERT_NOT_NULL(key);
+    TZ_ASSERT(key->bip32_path.length != 0u, EXC_WRONG_VALUES);
+    TZ_ASSERT(find_baking_key_slot(key) != NULL, EXC_WRONG_VALUES);
+
+end:
+    return exc;
+}
+
+tz_exc add_baking_key(bip32_path_with_curve_t const *const key) {
+    tz_exc exc = SW_OK;
+
+    TZ_CHECK(guard_baking_key_addable(key));
+
+    if (find_baking_key(key) == NULL) {
+        baking_key_t *const baking_key = find_baking_key_slot(key);
+        TZ_ASSERT(baking_key != NULL, EXC_WRONG_VALUES);
+        // The new key inherits the HWM of the first key
+        if (baking_key != &g_baking_key) {
+            memmove(&baking_key->hwm, &g_baking_key.hwm, sizeof(high_watermarks_t));
+        }
+        TZ_ASSERT(copy_bip32_path_with_curve(&baking_key->key, key), EXC_MEMORY_ERROR);
+        write_baking_keys();
+    }
+
+end:
+    return exc;
+}
+
+tz_exc guard_companion_key_registrable(bip32_path_with_curve_t const *const key) {
+    tz_exc exc = SW_OK;
+
+    TZ_ASSERT_NOT_NULL(key);
+#ifdef TARGET_NANOS
+    // Without BLS support, there is no companion key
+    TZ_FAIL(EXC_WRONG_PARAM);
+#else
+    TZ_ASSERT(key->bip32_path.length != 0u, EXC_WRONG_VALUES);
+    TZ_ASSERT(key->derivation_type == DERIVATION_TYPE_BLS12_381, EXC_WRONG_PARAM);
+    TZ_ASSERT(g_baking_key.key.bip32_path.length != 0u, EXC_SECURITY);
+    TZ_ASSERT(g_baking_key.key.derivation_type == DERIVATION_TYPE_BLS12_381, EXC_SECURITY);
+    TZ_ASSERT(find_baking_key(key) == NULL, EXC_SECURITY);
+#endif
+
+end:
+    return exc;
+}
+
+tz_exc register_companion_key(bip32_path_with_curve_t const *const key) {
+    tz_exc exc = SW_OK;
+
+    TZ_CHECK(guard_companion_key_registrable(key));
+
+    TZ_ASSERT(copy_bip32_path_with_curve(&g_hwm.companion.consensus_key, &g_baking_key.key),
+              EXC_MEMORY_ERROR);
+    TZ_ASSERT(copy_bip32_path_with_curve(&g_hwm.companion.companion_key, key), EXC_MEMORY_ERROR);
+    UPDATE_NVRAM_VAR(companion);
+
+end:
+    return exc;
+}
+
+tz_exc guard_companion_key(bip32_path_with_curve_t const *const key) {
+    tz_exc exc = SW_OK;
+
+    TZ_ASSERT_NOT_NULL(key);
+    TZ_ASSERT(g_hwm.companion.companion_key.bip32_path.length != 0u, EXC_SECURITY);
+    TZ_ASSERT(bip32_path_with_curve_eq(&g_hwm.companion.consensus_key, &g_baking_key.key),
+              EXC_SECURITY);
+    TZ_ASSERT(bip32_path_with_curve_eq(&g_hwm.companion.companion_key, key), EXC_SECURITY);
+    TZ_ASSERT(find_baking_key(key) == NULL, EXC_SECURITY);
+
+end:
+    return exc;
+}
+
 /**
  * @brief Checks if a baking info pass all checks
  *
  *        See `doc/signing.md#checks`
  *
  * @param baking_info: baking info
+ * @param hwms: high watermarks of the key
  * @return bool: return true if it has passed checks
  */
-static bool is_level_authorized(parsed_baking_data_t const *const baking_info) {
-    if (baking_info == NULL) {
+static bool is_level_authorized(parsed_baking_data_t const *const baking_info,
+                                high_watermarks_t const *const hwms) {
+    if ((baking_info == NULL) || (hwms == NULL)) {
         return false;
     }
 
@@ -99,7 +244,8 @@ static bool is_level_authorized(parsed_baking_data_t const *const baking_info) {
         return false;
     }
 
-    high_watermark_t *const hwm = select_hwm_by_chain(baking_info->chain_id);
+    // No HWM if the chain is a new test chain and the test chains table is full
+    high_watermark_t const *const hwm = select_hwm_by_chain(hwms, baking_info->chain_id);
     if (hwm == NULL) {
         return false;
     }
@@ -127,28 +273,16 @@ static bool is_level_authorized(parsed_baking_data_t const *const baking_info) {
             !hwm->had_preattestation);
 }
 
-/**
- * @brief Checks if a key pass the checks
- *
- * @param derivation_type: curve of the key
- * @param bip32_path: bip32 path of the key
- * @return bool: return true if it has passed checks
- */
-static bool is_path_authorized(derivation_type_t const derivation_type,
-                               bip32_path_t const *const bip32_path) {
-    return (bip32_path != NULL) && (derivation_type != DERIVATION_TYPE_UNSET) &&
-           (derivation_type == g_hwm.baking_key.derivation_type) && (bip32_path->length != 0u) &&
-           bip32_paths_eq(bip32_path, (const bip32_path_t *) &g_hwm.baking_key.bip32_path);
-}
-
 tz_exc guard_baking_authorized(parsed_baking_data_t const *const baking_info,
                                bip32_path_with_curve_t const *const key) {
     tz_exc exc = SW_OK;
 
     TZ_ASSERT_NOT_NULL(baking_info);
     TZ_ASSERT_NOT_NULL(key);
-    TZ_ASSERT(is_path_authorized(key->derivation_type, &key->bip32_path), EXC_SECURITY);
-    TZ_ASSERT(is_level_authorized(baking_info), EXC_WRONG_VALUES);
+
+    baking_key_t const *const baking_key = find_baking_key(key);
+    TZ_ASSERT(baking_key != NULL, EXC_SECURITY);
+    TZ_ASSERT(is_level_authorized(baking_info, &baking_key->hwm), EXC_WRONG_VALUES);
 
 end:
     return exc;
@@ -216,6 +350,32 @@ bool parse_block(buffer_t *buf, parsed_baking_data_t *const out) {
     return true;
 }
 
+/**
+ * @brief Reads a natural number encoded as a zarith number on 64 bits
+ *
+ *        Zarith numbers are read by groups of 7 bits, the most
+ *        significant bit of each byte telling if the number goes on.
+ *
+ * @param buf: input buffer
+ * @param out: number read
+ * @return bool: whether the number could be read
+ */
+static bool parse_nat(buffer_t *buf, uint64_t *out) {
+    uint8_t byte;
+    uint8_t shift = 0u;
+
+    *out = 0u;
+    do {
+        if (!buffer_read_u8(buf, &byte) || (shift > 63u) || ((shift == 63u) && (byte != 1u))) {
+            return false;
+        }
+        *out |= ((uint64_t) (byte & 0x7Fu)) << shift;
+        shift += 7u;
+    } while ((byte & 0x80u) != 0u);
+
+    return true;
+}
+
 /**
  * Data:
  *   + (4 bytes)  uint32:  chain id of the block
@@ -225,20 +385,45 @@ bool parse_block(buffer_t *buf, parsed_baking_data_t *const out) {
  *   + (4 bytes)  uint32:  level of the related block
  *   + (4 bytes)  uint32:  round of the related block
  *   + (32 bytes) uint8 *: hash of the related block
+ *   + (0|N byte) None|zarith: DAL bitset, only for the attestation with DAL tag
+ *
+ * The whole buffer must be consumed.
  */
 bool parse_consensus_operation(buffer_t *buf,
                                parsed_baking_data_t *const out,
                                bool is_attestation) {
+    uint8_t tag;
+
     if (!buffer_read_u32(buf, &out->chain_id.v, BE) ||   // chain id
         !buffer_seek_cur(buf, 32u * sizeof(uint8_t)) ||  // ignore branch
-        !buffer_seek_cur(buf, sizeof(uint8_t)) ||        // ignore tag
-        !buffer_seek_cur(buf, sizeof(uint16_t)) ||       // ignore slot
+        !buffer_read_u8(buf, &tag) ||                    // tag
+        !buffer_read_u16(buf, &out->slot, BE) ||         // slot
         !buffer_read_u32(buf, &out->level, BE) ||        // level
         !buffer_read_u32(buf, &out->round, BE) ||        // round
         !buffer_seek_cur(buf, 32u * sizeof(uint8_t))     // ignore hash
     ) {
         return false;
     }
+
+    out->has_dal = false;
+    out->dal_attestation = 0u;
+    if (!is_attestation) {
+        if (tag != CONSENSUS_TAG_PREATTESTATION) {
+            return false;
+        }
+    } else if (tag == CONSENSUS_TAG_ATTESTATION_WITH_DAL) {
+        if (!parse_nat(buf, &out->dal_attestation)) {
+            return false;
+        }
+        out->has_dal = true;
+    } else if (tag != CONSENSUS_TAG_ATTESTATION) {
+        return false;
+    }
+
+    if (buf->offset != buf->size) {
+        return false;
+    }
+
     out->type = is_attestation ? BAKING_TYPE_ATTESTATION : BAKING_TYPE_PREATTESTATION;
 
     out->is_tenderbake = true;
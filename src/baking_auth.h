@@ -32,6 +32,11 @@
 /**
  * @brief Authorizes a key
  *
+ *        The key becomes the only authorized key. Its HWM becomes the
+ *        highest of the HWM of all the authorized keys, so that the
+ *        removed keys, once authorized again, do not sign below what
+ *        they signed.
+ *
  * @param derivation_type: curve of the key
  * @param bip32_path: bip32 path of the key
  * @return tz_exc: exception, SW_OK if none
@@ -39,6 +44,59 @@
 tz_exc authorize_baking(derivation_type_t const derivation_type,
                         bip32_path_t const *const bip32_path);
 
+/**
+ * @brief Checks that a key can be added to the authorized keys
+ *
+ * @param key: bip32 path and curve of the key
+ * @return tz_exc: exception, SW_OK if none
+ */
+tz_exc guard_baking_key_addable(bip32_path_with_curve_t const *const key);
+
+/**
+ * @brief Adds a key to the authorized keys
+ *
+ *        Nothing changes if the key is already authorized. Otherwise
+ *        the key inherits the HWM of the first authorized key, which
+ *        holds the HWM of the removed keys.
+ *
+ * @param key: bip32 path and curve of the key
+ * @return tz_exc: exception, SW_OK if none
+ */
+tz_exc add_baking_key(bip32_path_with_curve_t const *const key);
+
+/**
+ * @brief Checks that a key can be registered as the companion key
+ *
+ *        The first authorized key must be a BLS key and the companion
+ *        key a BLS key which is not authorized for baking.
+ *
+ * @param key: bip32 path and curve of the companion key
+ * @return tz_exc: exception, SW_OK if none
+ */
+tz_exc guard_companion_key_registrable(bip32_path_with_curve_t const *const key);
+
+/**
+ * @brief Registers the companion key of the first authorized key
+ *
+ *        Replaces any companion key registered before.
+ *
+ * @param key: bip32 path and curve of the companion key
+ * @return tz_exc: exception, SW_OK if none
+ */
+tz_exc register_companion_key(bip32_path_with_curve_t const *const key);
+
+/**
+ * @brief Checks that a key is the registered companion key
+ *
+ *        The key must have been registered along with the current
+ *        first authorized key, and must not be authorized for baking:
+ *        its signatures would otherwise bypass its own HWM.
+ *
+ * @param key: bip32 path and curve of the companion key
+ * @return tz_exc: exception, SW_OK if none
+ */
+tz_exc guard_companion_key(bip32_path_with_curve_t const *const key);
+
 /**
  * @brief Guards baking info and key pass required checks
  *
@@ -58,12 +116,26 @@ tz_exc guard_baking_authorized(parsed_baking_data_t const *const baking_info,
 bool is_valid_level(level_t level);
 
 /**
- * @brief Stores baking info into the NVRAM
+ * @brief Stores baking info into the HWM of an authorized key in RAM
+ *
+ *        The NVRAM is not updated
+ *
+ * @param in: baking info
+ * @param key: authorized key
+ * @return tz_exc: exception, SW_OK if none
+ */
+tz_exc update_high_water_mark(parsed_baking_data_t const *const in,
+                              bip32_path_with_curve_t const *const key);
+
+/**
+ * @brief Stores baking info into the HWM of an authorized key in NVRAM
  *
  * @param in: baking info
+ * @param key: authorized key
  * @return tz_exc: exception, SW_OK if none
  */
-tz_exc write_high_water_mark(parsed_baking_data_t const *const in);
+tz_exc write_high_water_mark(parsed_baking_data_t const *const in,
+                             bip32_path_with_curve_t const *const key);
 
 /**
  * @brief Parse a block
@@ -29,25 +29,9 @@
 
 #ifndef TARGET_NANOS
 
-/**
- * @brief   Gets the bls private key from the device seed using the specified bip32 path
- * key.
- *
- * @param[in]  path            Bip32 path to use for derivation.
- *
- * @param[in]  path_len        Bip32 path length.
- *
- * @param[out] privkey         Generated private key.
- *
- * @return                     Error code:
- *                             - CX_OK on success
- *                             - CX_EC_INVALID_CURVE
- *                             - CX_INTERNAL_ERROR
- */
-static WARN_UNUSED_RESULT cx_err_t
-bip32_derive_init_privkey_bls(const uint32_t *path,
-                              size_t path_len,
-                              cx_ecfp_384_private_key_t *privkey) {
+WARN_UNUSED_RESULT cx_err_t bip32_derive_init_privkey_bls(const uint32_t *path,
+                                                          size_t path_len,
+                                                          cx_ecfp_384_private_key_t *privkey) {
     cx_err_t error = CX_OK;
     // Allocate 64 bytes to respect Syscall API but only 48 will be used
     uint8_t raw_privkey[64] = {0};
@@ -76,9 +60,8 @@ end:
     return error;
 }
 
-WARN_UNUSED_RESULT cx_err_t bip32_derive_get_pubkey_bls(const uint32_t *path,
-                                                        size_t path_len,
-                                                        uint8_t raw_pubkey[static BLS_PK_LEN]) {
+WARN_UNUSED_RESULT cx_err_t bls_get_pubkey(cx_ecfp_384_private_key_t *privkey,
+                                           uint8_t raw_pubkey[static BLS_PK_LEN]) {
     cx_err_t error = CX_OK;
     cx_curve_t curve = CX_CURVE_BLS12_381_G1;
 
@@ -86,16 +69,12 @@ WARN_UNUSED_RESULT cx_err_t bip32_derive_get_pubkey_bls(const uint32_t *path,
     uint8_t bls_field[BLS_SK_LEN] = {0};
     int diff = 0;
 
-    cx_ecfp_384_private_key_t privkey = {0};
     cx_ecfp_384_public_key_t pubkey = {0};
 
-    // Derive private key according to BIP32 path
-    CX_CHECK(bip32_derive_init_privkey_bls(path, path_len, &privkey));
-
     // Generate associated pubkey
     CX_CHECK(cx_ecfp_generate_pair_no_throw(curve,
                                             (cx_ecfp_public_key_t *) &pubkey,
-                                            (cx_ecfp_private_key_t *) &privkey,
+                                            (cx_ecfp_private_key_t *) privkey,
                                             true));
 
     tmp[BLS_SK_LEN - 1u] = 2;
@@ -116,6 +95,26 @@ WARN_UNUSED_RESULT cx_err_t bip32_derive_get_pubkey_bls(const uint32_t *path,
     }
     memmove(raw_pubkey, pubkey.W, pubkey.W_len);
 
+end:
+    if (error != CX_OK) {
+        // Make sure the caller doesn't use uninitialized data in case
+        // the return code is not checked.
+        explicit_bzero(raw_pubkey, BLS_PK_LEN);
+    }
+    return error;
+}
+
+WARN_UNUSED_RESULT cx_err_t bip32_derive_get_pubkey_bls(const uint32_t *path,
+                                                        size_t path_len,
+                                                        uint8_t raw_pubkey[static BLS_PK_LEN]) {
+    cx_err_t error = CX_OK;
+    cx_ecfp_384_private_key_t privkey = {0};
+
+    // Derive private key according to BIP32 path
+    CX_CHECK(bip32_derive_init_privkey_bls(path, path_len, &privkey));
+
+    CX_CHECK(bls_get_pubkey(&privkey, raw_pubkey));
+
 end:
     explicit_bzero(&privkey, sizeof(privkey));
 
@@ -131,52 +130,234 @@ end:
 // https://gitlab.com/tezos/tezos/-/blob/master/src/lib_bls12_381_signature/bls12_381_signature.ml?ref_type=heads#L351
 static const uint8_t CIPHERSUITE[] = "BLS_SIG_BLS12381G2_XMD:SHA-256_SSWU_RO_AUG_";
 
-WARN_UNUSED_RESULT cx_err_t bip32_derive_with_seed_bls_sign_hash(const uint32_t *path,
-                                                                 size_t path_len,
-                                                                 uint8_t const *msg,
-                                                                 size_t msg_len,
-                                                                 uint8_t *sig,
-                                                                 size_t *sig_len) {
+// expand_message_xmd parameters, RFC 9380 section 5.3.1:
+// L = ceil((ceil(log2(p)) + k) / 8) = 64 bytes per element of Fp,
+// 2 elements of Fp2 to hash to G2
+#define BLS_EXPANDED_ELEMENT_LEN 64u
+#define BLS_EXPANDED_MESSAGE_LEN (4u * BLS_EXPANDED_ELEMENT_LEN)
+#define BLS_XMD_BLOCK_LEN        64u  // SHA-256 input block size
+
+// Modulus of the base field of BLS12-381
+static const uint8_t BLS12381_FIELD_MODULUS[CX_BLS_BLS12381_PARAM_LEN] = {
+    0x1au, 0x01u, 0x11u, 0xeau, 0x39u, 0x7fu, 0xe6u, 0x9au, 0x4bu, 0x1bu, 0xa7u, 0xb6u,
+    0x43u, 0x4bu, 0xacu, 0xd7u, 0x64u, 0x77u, 0x4bu, 0x84u, 0xf3u, 0x85u, 0x12u, 0xbfu,
+    0x67u, 0x30u, 0xd2u, 0xa0u, 0xf6u, 0xb0u, 0xf6u, 0x24u, 0x1eu, 0xabu, 0xffu, 0xfeu,
+    0xb1u, 0x53u, 0xffu, 0xffu, 0xb9u, 0xfeu, 0xffu, 0xffu, 0xffu, 0xffu, 0xaau, 0xabu};
+
+/**
+ * @brief   Reduces an expanded element modulo the BLS12-381 field modulus
+ *
+ * @param[in]  element: expanded element, big endian
+ * @param[out] out: reduced element, big endian
+ * @return cx_err_t: error, CX_OK if none
+ */
+static WARN_UNUSED_RESULT cx_err_t
+bls_reduce_element(uint8_t const element[static BLS_EXPANDED_ELEMENT_LEN],
+                   uint8_t out[static CX_BLS_BLS12381_PARAM_LEN]) {
     cx_err_t error = CX_OK;
-    cx_ecfp_384_private_key_t privkey = {0};
-    uint8_t hash[CX_BLS_BLS12381_PARAM_LEN * 4] = {0};
-    uint8_t tmp[BLS_COMPRESSED_PK_LEN + BLS_MAX_MESSAGE_LEN] = {0};
-    uint8_t raw_pubkey[BLS_PK_LEN] = {0};
+    cx_bn_t bn_element;
+    cx_bn_t bn_modulus;
+    cx_bn_t bn_result;
+
+    CX_CHECK(cx_bn_lock(CX_BLS_BLS12381_PARAM_LEN, 0));
+    CX_CHECK(cx_bn_alloc_init(&bn_element,
+                              BLS_EXPANDED_ELEMENT_LEN,
+                              element,
+                              BLS_EXPANDED_ELEMENT_LEN));
+    CX_CHECK(cx_bn_alloc_init(&bn_modulus,
+                              CX_BLS_BLS12381_PARAM_LEN,
+                              BLS12381_FIELD_MODULUS,
+                              sizeof(BLS12381_FIELD_MODULUS)));
+    CX_CHECK(cx_bn_alloc(&bn_result, CX_BLS_BLS12381_PARAM_LEN));
+    CX_CHECK(cx_bn_reduce(bn_result, bn_element, bn_modulus));
+    CX_CHECK(cx_bn_export(bn_result, out, CX_BLS_BLS12381_PARAM_LEN));
 
-    if ((sig_len == NULL) || (*sig_len < BLS_SIG_LEN)) {
-        error = CX_INVALID_PARAMETER_VALUE;
+end:
+    if (cx_bn_is_locked()) {
+        // Destroys the allocated big numbers
+        (void) cx_bn_unlock();
+    }
+    return error;
+}
+
+WARN_UNUSED_RESULT cx_err_t
+bls_hash_to_field_init(cx_sha256_t *state,
+                       uint8_t const compressed_pubkey[static BLS_COMPRESSED_PK_LEN]) {
+    cx_err_t error = CX_OK;
+    uint8_t const z_pad[BLS_XMD_BLOCK_LEN] = {0};
+
+    if (state == NULL) {
+        error = CX_INVALID_PARAMETER;
         goto end;
     }
 
-    if (BLS_MAX_MESSAGE_LEN < msg_len) {
-        error = CX_INVALID_PARAMETER_VALUE;
+    // msg' = Z_pad || pk || msg || ...
+    CX_CHECK(cx_sha256_init_no_throw(state));
+    CX_CHECK(cx_hash_no_throw((cx_hash_t *) state, 0, z_pad, sizeof(z_pad), NULL, 0));
+    CX_CHECK(bls_hash_to_field_update(state, compressed_pubkey, BLS_COMPRESSED_PK_LEN));
+
+end:
+    return error;
+}
+
+WARN_UNUSED_RESULT cx_err_t bls_hash_to_field_update(cx_sha256_t *state,
+                                                     uint8_t const *msg,
+                                                     size_t msg_len) {
+    cx_err_t error = CX_OK;
+
+    if ((state == NULL) || ((msg == NULL) && (msg_len != 0u))) {
+        error = CX_INVALID_PARAMETER;
         goto end;
     }
 
-    // Derive private key according to BIP32 path
-    CX_CHECK(bip32_derive_init_privkey_bls(path, path_len, &privkey));
+    CX_CHECK(cx_hash_no_throw((cx_hash_t *) state, 0, msg, msg_len, NULL, 0));
+
+end:
+    return error;
+}
+
+WARN_UNUSED_RESULT cx_err_t bls_hash_to_field_final(cx_sha256_t *state,
+                                                    uint8_t hash[static BLS_FIELD_HASH_LEN]) {
+    cx_err_t error = CX_OK;
+    // I2OSP(len_in_bytes, 2) || I2OSP(0, 1)
+    uint8_t const msg_suffix[3] = {(uint8_t) (BLS_EXPANDED_MESSAGE_LEN >> 8u),
+                                   (uint8_t) (BLS_EXPANDED_MESSAGE_LEN & 0xFFu),
+                                   0u};
+    uint8_t const dst_len = (uint8_t) (sizeof(CIPHERSUITE) - 1u);
+    uint8_t b_0[CX_SHA256_SIZE] = {0};
+    uint8_t b_i[CX_SHA256_SIZE] = {0};
+    uint8_t element[BLS_EXPANDED_ELEMENT_LEN] = {0};
+    uint8_t i;
+    size_t j;
+
+    if (state == NULL) {
+        error = CX_INVALID_PARAMETER;
+        goto end;
+    }
+
+    // b_0 = H(Z_pad || msg || I2OSP(len_in_bytes, 2) || I2OSP(0, 1) || DST_prime)
+    CX_CHECK(cx_hash_no_throw((cx_hash_t *) state, 0, msg_suffix, sizeof(msg_suffix), NULL, 0));
+    CX_CHECK(cx_hash_no_throw((cx_hash_t *) state, 0, CIPHERSUITE, dst_len, NULL, 0));
+    CX_CHECK(cx_hash_no_throw((cx_hash_t *) state, CX_LAST, &dst_len, 1u, b_0, sizeof(b_0)));
+
+    // b_i = H(strxor(b_0, b_(i-1)) || I2OSP(i, 1) || DST_prime), starting from b_1 = H(b_0 || ...)
+    for (i = 1u; i <= (BLS_EXPANDED_MESSAGE_LEN / CX_SHA256_SIZE); i++) {
+        for (j = 0u; j < CX_SHA256_SIZE; j++) {
+            b_i[j] ^= b_0[j];
+        }
+        CX_CHECK(cx_sha256_init_no_throw(state));
+        CX_CHECK(cx_hash_no_throw((cx_hash_t *) state, 0, b_i, sizeof(b_i), NULL, 0));
+        CX_CHECK(cx_hash_no_throw((cx_hash_t *) state, 0, &i, 1u, NULL, 0));
+        CX_CHECK(cx_hash_no_throw((cx_hash_t *) state, 0, CIPHERSUITE, dst_len, NULL, 0));
+        CX_CHECK(
+            cx_hash_no_throw((cx_hash_t *) state, CX_LAST, &dst_len, 1u, b_i, sizeof(b_i)));
+
+        // Each element is made of two consecutive blocks: b_(2k+1) || b_(2k+2)
+        memmove(element + (((i - 1u) % 2u) * CX_SHA256_SIZE), b_i, CX_SHA256_SIZE);
+        if ((i % 2u) == 0u) {
+            CX_CHECK(bls_reduce_element(
+                element,
+                hash + ((((size_t) i / 2u) - 1u) * CX_BLS_BLS12381_PARAM_LEN)));
+        }
+    }
+
+end:
+    explicit_bzero(b_0, sizeof(b_0));
+    explicit_bzero(b_i, sizeof(b_i));
+    explicit_bzero(element, sizeof(element));
+    if (state != NULL) {
+        explicit_bzero(state, sizeof(cx_sha256_t));
+    }
+
+    if (error != CX_OK) {
+        // Make sure the caller doesn't use uninitialized data in case
+        // the return code is not checked.
+        explicit_bzero(hash, BLS_FIELD_HASH_LEN);
+    }
+    return error;
+}
 
-    CX_CHECK(bip32_derive_get_pubkey_bls(path, path_len, raw_pubkey));
-    memmove(tmp, raw_pubkey + 1, BLS_COMPRESSED_PK_LEN);
-    memmove(tmp + BLS_COMPRESSED_PK_LEN, msg, msg_len);
+WARN_UNUSED_RESULT cx_err_t bls_sign_field_hash(cx_ecfp_384_private_key_t const *privkey,
+                                                uint8_t const hash[static BLS_FIELD_HASH_LEN],
+                                                uint8_t *sig,
+                                                size_t *sig_len) {
+    cx_err_t error = CX_OK;
 
-    CX_CHECK(cx_hash_to_field(tmp,
-                              BLS_COMPRESSED_PK_LEN + msg_len,
-                              CIPHERSUITE,
-                              sizeof(CIPHERSUITE) - 1u,
-                              hash,
-                              sizeof(hash)));
+    if ((sig_len == NULL) || (*sig_len < BLS_SIG_LEN)) {
+        error = CX_INVALID_PARAMETER_VALUE;
+        goto end;
+    }
 
-    CX_CHECK(ox_bls12381_sign(&privkey, hash, sizeof(hash), sig, BLS_SIG_LEN));
+    CX_CHECK(ox_bls12381_sign(privkey, hash, BLS_FIELD_HASH_LEN, sig, BLS_SIG_LEN));
     *sig_len = BLS_SIG_LEN;
 
 end:
-    explicit_bzero(&privkey, sizeof(privkey));
+    if ((error != CX_OK) && (sig != NULL)) {
+        // Make sure the caller doesn't use uninitialized data in case
+        // the return code is not checked.
+        explicit_bzero(sig, BLS_SIG_LEN);
+    }
+    return error;
+}
+
+WARN_UNUSED_RESULT cx_err_t
+bls_sign_hash(cx_ecfp_384_private_key_t const *privkey,
+              uint8_t const compressed_pubkey[static BLS_COMPRESSED_PK_LEN],
+              uint8_t const *msg,
+              size_t msg_len,
+              uint8_t *sig,
+              size_t *sig_len) {
+    cx_err_t error = CX_OK;
+    cx_sha256_t state;
+    uint8_t hash[BLS_FIELD_HASH_LEN] = {0};
+
+    CX_CHECK(bls_hash_to_field_init(&state, compressed_pubkey));
+    CX_CHECK(bls_hash_to_field_update(&state, msg, msg_len));
+    CX_CHECK(bls_hash_to_field_final(&state, hash));
+
+    CX_CHECK(bls_sign_field_hash(privkey, hash, sig, sig_len));
+
+end:
+    explicit_bzero(&state, sizeof(state));
     explicit_bzero(hash, sizeof(hash));
-    explicit_bzero(tmp, sizeof(tmp));
+
+    if ((error != CX_OK) && (sig != NULL)) {
+        // Make sure the caller doesn't use uninitialized data in case
+        // the return code is not checked.
+        explicit_bzero(sig, BLS_SIG_LEN);
+    }
+    return error;
+}
+
+WARN_UNUSED_RESULT cx_err_t
+bip32_derive_with_seed_bls_sign_hash(const uint32_t *path,
+                                     size_t path_len,
+                                     uint8_t const *compressed_pubkey,
+                                     uint8_t const *msg,
+                                     size_t msg_len,
+                                     uint8_t *sig,
+                                     size_t *sig_len) {
+    cx_err_t error = CX_OK;
+    cx_ecfp_384_private_key_t privkey = {0};
+    uint8_t raw_pubkey[BLS_PK_LEN] = {0};
+    uint8_t const *pubkey = compressed_pubkey;
+
+    // Derive private key according to BIP32 path, only once
+    CX_CHECK(bip32_derive_init_privkey_bls(path, path_len, &privkey));
+
+    if (pubkey == NULL) {
+        // No stored public key: compute it from the derived private key
+        CX_CHECK(bls_get_pubkey(&privkey, raw_pubkey));
+        pubkey = raw_pubkey + 1;
+    }
+
+    CX_CHECK(bls_sign_hash(&privkey, pubkey, msg, msg_len, sig, sig_len));
+
+end:
+    explicit_bzero(&privkey, sizeof(privkey));
     explicit_bzero(raw_pubkey, sizeof(raw_pubkey));
 
-    if (error != CX_OK) {
+    if ((error != CX_OK) && (sig != NULL)) {
         // Make sure the caller doesn't use uninitialized data in case
         // the return code is not checked.
         explicit_bzero(sig, BLS_SIG_LEN);
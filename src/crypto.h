@@ -29,8 +29,42 @@
 #define BLS_COMPRESSED_PK_LEN 48u
 #define BLS_SIG_LEN           96u
 
-// `BLS_MAX_MESSAGE_LEN` can be as large as needed
-#define BLS_MAX_MESSAGE_LEN 235u
+/// Size of a message hashed to the field: two elements of Fp2
+#define BLS_FIELD_HASH_LEN (CX_BLS_BLS12381_PARAM_LEN * 4u)
+
+/**
+ * @brief   Gets the bls private key from the device seed using the specified bip32 path
+ * key.
+ *
+ * @param[in]  path            Bip32 path to use for derivation.
+ *
+ * @param[in]  path_len        Bip32 path length.
+ *
+ * @param[out] privkey         Generated private key.
+ *
+ * @return                     Error code:
+ *                             - CX_OK on success
+ *                             - CX_EC_INVALID_CURVE
+ *                             - CX_INTERNAL_ERROR
+ */
+WARN_UNUSED_RESULT cx_err_t bip32_derive_init_privkey_bls(const uint32_t *path,
+                                                          size_t path_len,
+                                                          cx_ecfp_384_private_key_t *privkey);
+
+/**
+ * @brief   Gets the bls public key associated to a bls private key.
+ *
+ * @param[in]  privkey         Private key.
+ *
+ * @param[out] raw_pubkey      Buffer where to store the public key.
+ *
+ * @return                     Error code:
+ *                             - CX_OK on success
+ *                             - CX_EC_INVALID_CURVE
+ *                             - CX_INTERNAL_ERROR
+ */
+WARN_UNUSED_RESULT cx_err_t bls_get_pubkey(cx_ecfp_384_private_key_t *privkey,
+                                           uint8_t raw_pubkey[static 97]);
 
 /**
  * @brief   Gets the bls public key from the device seed using the specified bip32 path
@@ -51,6 +85,108 @@ WARN_UNUSED_RESULT cx_err_t bip32_derive_get_pubkey_bls(const uint32_t *path,
                                                         size_t path_len,
                                                         uint8_t raw_pubkey[static 97]);
 
+/**
+ * @brief   Sign a hash with bls using an already derived private key.
+ *
+ * @param[in]  privkey           Private key to sign with.
+ *
+ * @param[in]  compressed_pubkey Compressed public key associated to *privkey*.
+ *                               Used as augmentation prefix of the message.
+ *
+ * @param[in]  msg               Message to be signed.
+ *
+ * @param[in]  msg_len           Length of the message in octets.
+ *
+ * @param[out] sig               Buffer where to store the signature.
+ *
+ * @param[in]  sig_len           Length of the signature buffer, updated with signature length.
+ *
+ * @return                       Error code:
+ *                               - CX_OK on success
+ *                               - CX_EC_INVALID_CURVE
+ *                               - CX_INTERNAL_ERROR
+ */
+WARN_UNUSED_RESULT cx_err_t bls_sign_hash(cx_ecfp_384_private_key_t const *privkey,
+                                          uint8_t const compressed_pubkey[static 48],
+                                          uint8_t const *msg,
+                                          size_t msg_len,
+                                          uint8_t *sig,
+                                          size_t *sig_len);
+
+/**
+ * @brief   Starts hashing a message to the BLS12-381 field.
+ *
+ *          Hashes `compressed_pubkey || msg` as `cx_hash_to_field` does
+ *          with the tezos cipher suite, but the message can be given in
+ *          several parts using `bls_hash_to_field_update`.
+ *
+ * @param[out] state           SHA-256 state of expand_message_xmd.
+ *
+ * @param[in]  compressed_pubkey Compressed public key of the signing key.
+ *
+ * @return                     Error code:
+ *                             - CX_OK on success
+ *                             - CX_INVALID_PARAMETER
+ */
+WARN_UNUSED_RESULT cx_err_t
+bls_hash_to_field_init(cx_sha256_t *state,
+                       uint8_t const compressed_pubkey[static BLS_COMPRESSED_PK_LEN]);
+
+/**
+ * @brief   Hashes a part of the message to the BLS12-381 field.
+ *
+ * @param[in]  state           SHA-256 state of expand_message_xmd.
+ *
+ * @param[in]  msg             Part of the message.
+ *
+ * @param[in]  msg_len         Length of the part of the message.
+ *
+ * @return                     Error code:
+ *                             - CX_OK on success
+ *                             - CX_INVALID_PARAMETER
+ */
+WARN_UNUSED_RESULT cx_err_t bls_hash_to_field_update(cx_sha256_t *state,
+                                                     uint8_t const *msg,
+                                                     size_t msg_len);
+
+/**
+ * @brief   Finishes hashing the message to the BLS12-381 field.
+ *
+ *          Runs expand_message_xmd and reduces each element modulo the
+ *          field modulus, following RFC 9380.
+ *
+ * @param[in]  state           SHA-256 state of expand_message_xmd.
+ *
+ * @param[out] hash            Buffer where to store the field elements.
+ *
+ * @return                     Error code:
+ *                             - CX_OK on success
+ *                             - CX_INVALID_PARAMETER
+ */
+WARN_UNUSED_RESULT cx_err_t bls_hash_to_field_final(cx_sha256_t *state,
+                                                    uint8_t hash[static BLS_FIELD_HASH_LEN]);
+
+/**
+ * @brief   Sign a message hashed to the BLS12-381 field with a bls private key.
+ *
+ * @param[in]  privkey         Private key.
+ *
+ * @param[in]  hash            Message hashed to the field.
+ *
+ * @param[out] sig             Buffer where to store the signature.
+ *
+ * @param[in]  sig_len         Length of the signature buffer, updated with signature length.
+ *
+ * @return                     Error code:
+ *                             - CX_OK on success
+ *                             - CX_INVALID_PARAMETER_VALUE
+ *                             - CX_INTERNAL_ERROR
+ */
+WARN_UNUSED_RESULT cx_err_t bls_sign_field_hash(cx_ecfp_384_private_key_t const *privkey,
+                                                uint8_t const hash[static BLS_FIELD_HASH_LEN],
+                                                uint8_t *sig,
+                                                size_t *sig_len);
+
 /**
  * @brief   Sign a hash with bls using the device seed derived from the specified bip32 path.
  *
@@ -58,6 +194,9 @@ WARN_UNUSED_RESULT cx_err_t bip32_derive_get_pubkey_bls(const uint32_t *path,
  *
  * @param[in]  path_len        Bip32 path length.
  *
+ * @param[in]  compressed_pubkey Stored compressed public key of the derived key.
+ *                             Pass NULL to compute it from the derived private key.
+ *
  * @param[in]  msg             Digest of the message to be signed.
  *                             The length of *message* must be shorter than the group order size.
  *                             Otherwise it is truncated.
@@ -73,10 +212,12 @@ WARN_UNUSED_RESULT cx_err_t bip32_derive_get_pubkey_bls(const uint32_t *path,
  *                             - CX_EC_INVALID_CURVE
  *                             - CX_INTERNAL_ERROR
  */
-WARN_UNUSED_RESULT cx_err_t bip32_derive_with_seed_bls_sign_hash(const uint32_t *path,
-                                                                 size_t path_len,
-                                                                 uint8_t const *msg,
-                                                                 size_t msg_len,
-                                                                 uint8_t *sig,
-                                                                 size_t *sig_len);
+WARN_UNUSED_RESULT cx_err_t
+bip32_derive_with_seed_bls_sign_hash(const uint32_t *path,
+                                     size_t path_len,
+                                     uint8_t const *compressed_pubkey,
+                                     uint8_t const *msg,
+                                     size_t msg_len,
+                                     uint8_t *sig,
+                                     size_t *sig_len);
 #endif
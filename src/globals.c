@@ -27,6 +27,7 @@
 
 #include "ux.h"
 
+#include <stddef.h>
 #include <string.h>
 
 // WARNING: ***************************************************
@@ -42,9 +43,128 @@ void clear_apdu_globals(void) {
     memset(&global.apdu, 0, sizeof(global.apdu));
 }
 
+static void merge_hwm(high_watermark_t *const dest, high_watermark_t const *const src);
+
+/**
+ * @brief Computes the checksum of a HWM journal record
+ *
+ * @param record: HWM journal record
+ * @return uint16_t: checksum of the record
+ */
+static uint16_t hwm_journal_record_checksum(hwm_journal_record_t const *const record) {
+    return cx_crc16(record, offsetof(hwm_journal_record_t, checksum));
+}
+
+void write_hwm_journal(size_t key_index, chain_id_t chain_id) {
+    hwm_journal_record_t record;
+
+    if (key_index >= MAX_BAKING_KEYS) {
+        return;
+    }
+
+    high_watermark_t const *const hwm =
+        select_hwm_by_chain(&g_hwm.baking_keys[key_index].hwm, chain_id);
+    if (hwm == NULL) {
+        return;
+    }
+
+    // 2^32 records cannot be written within the flash endurance
+    global.hwm_journal_sequence++;
+
+    if ((global.hwm_journal_sequence - g_hwm.hwm_journal_base) > HWM_JOURNAL_SIZE) {
+        // The ring is full: its oldest record must be included in `N_data`
+        // before being overwritten. All the HWM in RAM supersede the ring.
+        UPDATE_NVRAM;
+        return;
+    }
+
+    memset(&record, 0, sizeof(record));
+    record.sequence = global.hwm_journal_sequence;
+    record.chain_id = chain_id;
+    record.level = hwm->highest_level;
+    record.round = hwm->highest_round;
+    record.key_index = (uint8_t) key_index;
+    record.flags = (hwm->had_attestation ? HWM_JOURNAL_HAD_ATTESTATION : 0u) |
+                   (hwm->had_preattestation ? HWM_JOURNAL_HAD_PREATTESTATION : 0u);
+    record.checksum = hwm_journal_record_checksum(&record);
+
+    // Overwrite a record already included in `N_data`
+    nvm_write((void *) &N_hwm_journal.records[record.sequence % HWM_JOURNAL_SIZE],
+              &record,
+              sizeof(record));
+}
+
+/**
+ * @brief Replays a HWM journal record over the HWM in RAM
+ *
+ *        The HWM of the record is merged, so that a record replayed
+ *        over a more recent HWM never lowers it.
+ *
+ * @param record: valid HWM journal record
+ */
+static void replay_hwm_journal_record(hwm_journal_record_t const *const record) {
+    high_watermark_t hwm;
+
+    if (record->key_index >= MAX_BAKING_KEYS) {
+        return;
+    }
+
+    high_watermarks_t *const hwms = &g_hwm.baking_keys[record->key_index].hwm;
+    high_watermark_t *dest = select_or_add_hwm_by_chain(hwms, record->chain_id);
+    if (dest == NULL) {
+        // The table is full: keep the HWM of the chain in the initial test HWM
+        dest = &hwms->test;
+    }
+
+    memset(&hwm, 0, sizeof(hwm));
+    hwm.highest_level = record->level;
+    hwm.highest_round = record->round;
+    hwm.had_attestation = (record->flags & HWM_JOURNAL_HAD_ATTESTATION) != 0u;
+    hwm.had_preattestation = (record->flags & HWM_JOURNAL_HAD_PREATTESTATION) != 0u;
+    merge_hwm(dest, &hwm);
+}
+
+/**
+ * @brief Restores the HWM in RAM by replaying the HWM journal over
+ *        the HWM of `N_data`
+ *
+ *        The records following `hwm_journal_base` are replayed in
+ *        sequence, up to the first one that is missing or invalid:
+ *        only the last record can have been interrupted.
+ */
+static void replay_hwm_journal(void) {
+    hwm_journal_record_t record;
+    uint32_t sequence = g_hwm.hwm_journal_base;
+
+    for (size_t i = 0; i < HWM_JOURNAL_SIZE; i++) {
+        memmove(&record,
+                (void const *) &N_hwm_journal.records[(sequence + 1u) % HWM_JOURNAL_SIZE],
+                sizeof(record));
+        if ((record.sequence != (sequence + 1u)) ||
+            (record.checksum != hwm_journal_record_checksum(&record))) {
+            break;
+        }
+        replay_hwm_journal_record(&record);
+        sequence++;
+    }
+
+    global.hwm_journal_sequence = sequence;
+}
+
 void init_globals(void) {
     memset(&global, 0, sizeof(global));
     memcpy(&g_hwm, (const void *) (&N_data), sizeof(g_hwm));
+    replay_hwm_journal();
+
+    if (g_baking_key.key.bip32_path.length != 0u) {
+        // Ignore derivation errors: the key will be cached on its first use
+        (void) cache_derived_key(&g_baking_key.key);
+    }
+
+    if (!is_authorized_key_cached(&g_baking_key.key)) {
+        // Ignore calculation errors: the key will be derived on each use
+        (void) update_authorized_key_cache();
+    }
 }
 
 void toggle_hwm(void) {
@@ -56,7 +176,155 @@ void toggle_hwm(void) {
 // The "N_" is *significant*. It tells the linker to put this in NVRAM.
 baking_data const N_data_real;
 
-high_watermark_t *select_hwm_by_chain(chain_id_t const chain_id) {
-    return ((chain_id.v == g_hwm.main_chain_id.v) || !g_hwm.main_chain_id.v) ? &g_hwm.hwm.main
-                                                                             : &g_hwm.hwm.test;
+// DO NOT TRY TO INIT THIS. This can only be written via an system call.
+hwm_journal_t const N_hwm_journal_real;
+
+// DO NOT TRY TO INIT THIS. This can only be written via an system call.
+authorized_key_cache_t const N_authorized_key_cache_real;
+
+baking_key_t *find_baking_key(bip32_path_with_curve_t const *const key) {
+    if ((key == NULL) || (key->bip32_path.length == 0u)) {
+        return NULL;
+    }
+    for (size_t i = 0; i < MAX_BAKING_KEYS; i++) {
+        if (bip32_path_with_curve_eq(key, &g_hwm.baking_keys[i].key)) {
+            return &g_hwm.baking_keys[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Checks if a chain uses the main HWM
+ *
+ * @param chain_id: chain id
+ * @return bool: whether the chain uses the main HWM
+ */
+static bool is_main_chain(chain_id_t const chain_id) {
+    return (chain_id.v == g_hwm.main_chain_id.v) || !g_hwm.main_chain_id.v;
+}
+
+/**
+ * @brief Searches a test chain in the test chains table
+ *
+ *        The table is sorted by chain id: the search is a binary
+ *        search.
+ *
+ * @param hwm: high watermarks of an authorized key
+ * @param chain_id: chain id
+ * @param index: output index of the chain in the table if found, index
+ *        where it must be inserted otherwise
+ * @return bool: whether the chain is in the table
+ */
+static bool find_hwm_chain(high_watermarks_t const *const hwm,
+                           chain_id_t const chain_id,
+                           size_t *const index) {
+    // Do not trust the number of chains restored from NVRAM to stay in the table
+    size_t const nb_chains = CUSTOM_MIN((size_t) hwm->nb_chains, (size_t) HWM_CHAINS_SIZE);
+    size_t low = 0u;
+    size_t high = nb_chains;
+
+    while (low < high) {
+        size_t const middle = low + ((high - low) / 2u);
+        if (hwm->chains[middle].chain_id.v < chain_id.v) {
+            low = middle + 1u;
+        } else {
+            high = middle;
+        }
+    }
+
+    *index = low;
+    return (low < nb_chains) && (hwm->chains[low].chain_id.v == chain_id.v);
+}
+
+high_watermark_t const *select_hwm_by_chain(high_watermarks_t const *const hwm,
+                                            chain_id_t const chain_id) {
+    size_t index = 0u;
+
+    if (is_main_chain(chain_id)) {
+        return &hwm->main;
+    }
+    if (find_hwm_chain(hwm, chain_id, &index)) {
+        return &hwm->chains[index].hwm;
+    }
+    if (hwm->nb_chains < HWM_CHAINS_SIZE) {
+        return &hwm->test;
+    }
+    return NULL;
+}
+
+high_watermark_t *select_or_add_hwm_by_chain(high_watermarks_t *const hwm,
+                                             chain_id_t const chain_id) {
+    size_t index = 0u;
+
+    if (is_main_chain(chain_id)) {
+        return &hwm->main;
+    }
+    if (!find_hwm_chain(hwm, chain_id, &index)) {
+        if (hwm->nb_chains >= HWM_CHAINS_SIZE) {
+            // Evicting a chain would allow to sign again below its HWM
+            return NULL;
+        }
+        memmove(&hwm->chains[index + 1u],
+                &hwm->chains[index],
+                (hwm->nb_chains - index) * sizeof(chain_hwm_t));
+        hwm->chains[index].chain_id = chain_id;
+        memmove(&hwm->chains[index].hwm, &hwm->test, sizeof(high_watermark_t));
+        hwm->nb_chains++;
+    }
+    hwm->last_chain = (uint8_t) index;
+    return &hwm->chains[index].hwm;
+}
+
+/**
+ * @brief Merges a HWM into another one
+ *
+ *        The highest (level, round) is kept. At the same (level,
+ *        round), the consensus operations seen by either HWM are kept.
+ *
+ * @param dest: HWM updated
+ * @param src: HWM merged into `dest`
+ */
+static void merge_hwm(high_watermark_t *const dest, high_watermark_t const *const src) {
+    if ((src->highest_level > dest->highest_level) ||
+        ((src->highest_level == dest->highest_level) &&
+         (src->highest_round > dest->highest_round))) {
+        memmove(dest, src, sizeof(high_watermark_t));
+    } else if ((src->highest_level == dest->highest_level) &&
+               (src->highest_round == dest->highest_round)) {
+        dest->had_attestation = dest->had_attestation || src->had_attestation;
+        dest->had_preattestation = dest->had_preattestation || src->had_preattestation;
+    }
+}
+
+void merge_hwms(high_watermarks_t *const dest, high_watermarks_t const *const src) {
+    size_t const nb_chains = CUSTOM_MIN((size_t) src->nb_chains, (size_t) HWM_CHAINS_SIZE);
+    bool const has_last_chain = dest->nb_chains != 0u;
+    chain_id_t const last_chain_id = dest->chains[dest->last_chain % HWM_CHAINS_SIZE].chain_id;
+    size_t index = 0u;
+
+    merge_hwm(&dest->main, &src->main);
+    merge_hwm(&dest->test, &src->test);
+
+    for (size_t i = 0; i < nb_chains; i++) {
+        high_watermark_t *hwm = select_or_add_hwm_by_chain(dest, src->chains[i].chain_id);
+        if (hwm == NULL) {
+            // The table is full: keep the HWM of the chain in the initial test HWM
+            hwm = &dest->test;
+        }
+        merge_hwm(hwm, &src->chains[i].hwm);
+    }
+
+    // Adding chains moves the test chain signed last
+    if (has_last_chain && find_hwm_chain(dest, last_chain_id, &index)) {
+        dest->last_chain = (uint8_t) index;
+    } else {
+        dest->last_chain = 0u;
+    }
+}
+
+void clear_hwm_chains(high_watermarks_t *const hwm) {
+    hwm->nb_chains = 0u;
+    hwm->last_chain = 0u;
+    memset(&hwm->chains, 0, sizeof(hwm->chains));
 }
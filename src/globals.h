@@ -27,6 +27,7 @@
 #include "bolos_target.h"
 
 #include "operations.h"
+#include "perf.h"
 #include "ui.h"
 #include "ui_screensaver.h"
 
@@ -41,6 +42,9 @@ void clear_apdu_globals(void);
 /**
  * @brief Zeros out all application-specific globals and SDK-specific UI/exchange buffers
  *
+ *        Loads the baking data from NVRAM, restores the HWM from the HWM
+ *        journal and caches the authorized key and its public data
+ *
  */
 void init_globals(void);
 
@@ -67,6 +71,35 @@ typedef struct {
     uint8_t hmac[CX_SHA256_SIZE];                    ///< buffer to hold the hmac result
 } apdu_hmac_state_t;
 
+#ifdef TARGET_NANOS
+#define HMAC_KEY_CACHE_SIZE 2u
+#else
+#define HMAC_KEY_CACHE_SIZE 4u
+#endif
+
+/**
+ * @brief This structure represents a HMAC key held in RAM
+ *
+ *        Avoids signing and hashing the fixed HMAC message on every HMAC.
+ *
+ */
+typedef struct {
+    bool is_set;                                     ///< whether the entry holds a HMAC key
+    uint32_t last_use;                               ///< use counter value at the last lookup
+    bip32_path_with_curve_t path_with_curve;         ///< bip32 path and curve of the key
+    uint8_t hashed_signed_hmac_key[CX_SHA512_SIZE];  ///< cached HMAC key
+} hmac_key_cache_entry_t;
+
+/**
+ * @brief This structure represents the least recently used cache of HMAC keys
+ *
+ *        Must be wiped on PIN lock and exit.
+ */
+typedef struct {
+    hmac_key_cache_entry_t entries[HMAC_KEY_CACHE_SIZE];  ///< cached keys
+    uint32_t use_counter;                                 ///< incremented on every lookup
+} hmac_key_cache_t;
+
 /**
  * @brief This structure represents the state needed to hash messages
  *
@@ -82,6 +115,7 @@ typedef struct {
 typedef struct {
     /// 0-index is the initial setup packet, 1 is first packet to hash, etc.
     uint8_t packet_index;
+    size_t total_size;  ///< size of the message read over all packets
 
     /// state to hold the current parsed bakind data
     parsed_baking_data_t parsed_baking_data;
@@ -92,11 +126,12 @@ typedef struct {
         struct parsed_operation_group v;  ///< current parsed operation group
     } maybe_ops;
 
+    bool hash_message;                   ///< if the message is hashed with blake2b
     blake2b_hash_state_t hash_state;     ///< current blake2b hash state
     uint8_t final_hash[SIGN_HASH_SIZE];  ///< buffer to hold hash of all the message
 #ifndef TARGET_NANOS
-    uint8_t message[MAX_APDU_SIZE];  ///< buffer to hold last packet message
-    size_t message_len;              ///< size of the message last packet
+    cx_sha256_t bls_hash_state;           ///< BLS hash to field state of all the message
+    derived_key_cache_t bls_signing_key;  ///< BLS key derived for this signature only
 #endif
 
     magic_byte_t magic_byte;         ///< current magic byte read
@@ -114,6 +149,8 @@ typedef struct {
         ui_callback_t ok_callback;
         /// Callback function if user rejected prompt.
         ui_callback_t cxl_callback;
+        /// `IDLE_SCREEN_*` values built since their last change
+        uint8_t built_idle_screen_values;
 #ifdef HAVE_BAGL
         /// If the low-cost display mode is enabled
         bool low_cost_display_mode;
@@ -126,6 +163,9 @@ typedef struct {
 
     /// apdu handling state
     struct {
+        /// whether a message to sign is being received: set by its
+        /// first packet, cleared by its last one or by an error
+        bool sign_in_progress;
         union {
             apdu_sign_state_t sign;  ///< state used to handle signing
 
@@ -149,26 +189,190 @@ typedef struct {
     } apdu;
 
     baking_data hwm_data;  ///< baking HWM data in RAM
+
+    derived_key_cache_t derived_key_cache;  ///< first authorized key derived from the seed
+
+    hmac_key_cache_t hmac_key_cache;  ///< HMAC keys derived from the seed
+
+    uint32_t hwm_journal_sequence;  ///< sequence number of the last HWM journal record
+
+#ifdef HAVE_PERF_COUNTERS
+    perf_counter_t perf_counters[PERF_PHASE_COUNT];  ///< phase timers
+    /// latency histogram of each instruction
+    uint16_t perf_histograms[PERF_HISTOGRAM_NB_INS][PERF_HISTOGRAM_NB_BUCKETS];
+    uint32_t perf_signed[PERF_SIGNED_COUNT];  ///< signed baking messages of each kind
+#endif
 } globals_t;
 
 extern globals_t global;
 
 #define g_hwm global.hwm_data
 
+/// First authorized key, the one set by `SETUP` and `AUTHORIZE_BAKING`
+#define g_baking_key g_hwm.baking_keys[0]
+
 extern baking_data const N_data_real;
 #define N_data (*(volatile baking_data *) PIC(&N_data_real))
 
+/**
+ * @brief This structure represents the public data of the authorized key
+ *
+ *        Kept in NVRAM to avoid deriving the authorized key to get its
+ *        public key, its public key hash or its address.
+ *
+ *        Only valid while its key matches the authorized key.
+ */
+typedef struct {
+    bip32_path_with_curve_t key;                     ///< bip32 path and curve of the cached key
+    tz_ecfp_public_key_t public_key;                 ///< public key
+    tz_ecfp_compressed_public_key_t compressed_key;  ///< compressed public key
+    uint8_t hash[KEY_HASH_SIZE];                     ///< public key hash
+    char pkh_string[PKH_STRING_SIZE];                ///< public key hash as string
+} authorized_key_cache_t;
+
+extern authorized_key_cache_t const N_authorized_key_cache_real;
+#define N_authorized_key_cache \
+    (*(volatile authorized_key_cache_t *) PIC(&N_authorized_key_cache_real))
+
+#ifdef TARGET_NANOS
+#define HWM_JOURNAL_SIZE 32u  /// Number of records of the HWM journal
+#else
+#define HWM_JOURNAL_SIZE 64u  /// Number of records of the HWM journal
+#endif
+
+#define HWM_JOURNAL_HAD_ATTESTATION    0x01u  /// An attestation has been seen
+#define HWM_JOURNAL_HAD_PREATTESTATION 0x02u  /// A pre-attestation has been seen
+
+/**
+ * @brief This structure represents a record of the HWM journal
+ *
+ *        Holds the HWM of a chain of an authorized key after an update.
+ */
+typedef struct {
+    uint32_t sequence;    ///< sequence number, 0 if never written
+    chain_id_t chain_id;  ///< chain of the HWM
+    level_t level;        ///< highest level seen
+    round_t round;        ///< highest round seen
+    uint8_t key_index;    ///< index of the authorized key in `baking_keys`
+    uint8_t flags;        ///< `HWM_JOURNAL_HAD_*` flags
+    uint16_t checksum;    ///< checksum of the previous fields
+} hwm_journal_record_t;
+
+/**
+ * @brief This structure represents the HWM journal stored in NVRAM
+ *
+ *        Each HWM update is appended to the ring instead of rewriting
+ *        `N_data`. On start, the records following the sequence
+ *        number `hwm_journal_base` of `N_data` are replayed over its
+ *        HWM, up to the first invalid one: an interrupted write only
+ *        loses the record being written.
+ *
+ *        `N_data` is only rewritten, with all the HWM in RAM, once the
+ *        ring is full, so that no record is overwritten before it has
+ *        been included in `N_data`.
+ */
+typedef struct {
+    hwm_journal_record_t records[HWM_JOURNAL_SIZE];  ///< ring of records
+} hwm_journal_t;
+
+extern hwm_journal_t const N_hwm_journal_real;
+#define N_hwm_journal (*(volatile hwm_journal_t *) PIC(&N_hwm_journal_real))
+
+/**
+ * @brief Appends the HWM of a chain of an authorized key in RAM to the
+ *        HWM journal in NVRAM
+ *
+ *        Rewrites `N_data` instead if the ring is full.
+ *
+ * @param key_index: index of the authorized key
+ * @param chain_id: chain of the HWM
+ */
+void write_hwm_journal(size_t key_index, chain_id_t chain_id);
+
+/**
+ * @brief Finds an authorized key
+ *
+ * @param key: bip32 path and curve of the key
+ * @return baking_key_t*: the authorized key and its HWM, NULL if the
+ *         key is not authorized
+ */
+baking_key_t *find_baking_key(bip32_path_with_curve_t const *const key);
+
+/**
+ * @brief Gets the index of an authorized key in `g_hwm.baking_keys`
+ *
+ * @param baking_key: authorized key
+ * @return size_t: index of the key
+ */
+static inline size_t baking_key_index(baking_key_t const *const baking_key) {
+    return (size_t) (baking_key - g_hwm.baking_keys);
+}
+
 /**
  * @brief Selects a HWM for a given chain id depending on the ram
  *
- *        Selects the main HWM of the ram if the main chain of the ram
- *        is not defined, or if the given chain matches the main chain
- *        of the ram. Selects the test HWM of the ram otherwise.
+ *        Selects the main HWM if the main chain of the ram is not
+ *        defined, or if the given chain matches the main chain of the
+ *        ram. Selects the HWM of the chain in the test chains table
+ *        otherwise, or the initial `test` HWM if the chain is not in
+ *        the table yet.
+ *
+ * @param hwm: high watermarks of an authorized key
+ * @param chain_id: chain id
+ * @return high_watermark_t const*: selected HWM, NULL if the chain is
+ *         not in the test chains table and the table is full
+ */
+high_watermark_t const *select_hwm_by_chain(high_watermarks_t const *const hwm,
+                                            chain_id_t const chain_id);
+
+/**
+ * @brief Selects the HWM to update for a given chain id
+ *
+ *        Same as `select_hwm_by_chain`, except that a test chain not in
+ *        the table yet is added to it with the initial `test` HWM.
  *
+ * @param hwm: high watermarks of an authorized key
  * @param chain_id: chain id
- * @return high_watermark_t*: selected HWM
+ * @return high_watermark_t*: selected HWM, NULL if the chain is not in
+ *         the test chains table and the table is full
+ */
+high_watermark_t *select_or_add_hwm_by_chain(high_watermarks_t *const hwm,
+                                             chain_id_t const chain_id);
+
+/**
+ * @brief Merges the HWM of an authorized key into the HWM of another one
+ *
+ *        Each HWM of `dest` becomes the highest of its HWM and the
+ *        matching HWM of `src`, so that `dest` refuses whatever `src`
+ *        refused. The test chains of `src` are added to the table of
+ *        `dest`, or merged into its initial `test` HWM once it is full.
+ *
+ * @param dest: high watermarks updated
+ * @param src: high watermarks merged into `dest`
+ */
+void merge_hwms(high_watermarks_t *const dest, high_watermarks_t const *const src);
+
+/**
+ * @brief Removes all the test chains from the test chains table
+ *
+ *        They are added again with the initial `test` HWM on their
+ *        next signature.
+ *
+ * @param hwm: high watermarks of an authorized key
+ */
+void clear_hwm_chains(high_watermarks_t *const hwm);
+
+/**
+ * @brief Updates the HWM of a chain of an authorized key in NVRAM
+ *        through the HWM journal
+ *
+ * @param key_index: index of the authorized key
+ * @param chain_id: chain of the HWM
  */
-high_watermark_t *select_hwm_by_chain(chain_id_t const chain_id);
+#define UPDATE_NVRAM_HWM(key_index, chain_id)   \
+    if (!N_data_real.hwm_disabled) {            \
+        write_hwm_journal(key_index, chain_id); \
+    }
 
 /**
  * @brief Updates a single variable in NVRAM baking_data.
@@ -185,5 +389,23 @@ high_watermark_t *select_hwm_by_chain(chain_id_t const chain_id);
 /**
  * @brief Properly updates an entire NVRAM struct to prevent any clobbering of data
  *
+ *        The HWM written supersede the records of the HWM journal.
+ *
+ */
+#define UPDATE_NVRAM                                                              \
+    do {                                                                          \
+        global.hwm_data.hwm_journal_base = global.hwm_journal_sequence;           \
+        nvm_write((void *) &(N_data), &global.hwm_data, sizeof(global.hwm_data)); \
+    } while (0)
+
+/**
+ * @brief Updates the authorized keys and all their HWM in NVRAM
+ *
+ *        The HWM journal records are keyed by slot: they must not be
+ *        replayed over the HWM of another key.
+ *
  */
-#define UPDATE_NVRAM nvm_write((void *) &(N_data), &global.hwm_data, sizeof(global.hwm_data));
+#define UPDATE_NVRAM_BAKING_KEYS     \
+    if (!N_data_real.hwm_disabled) { \
+        UPDATE_NVRAM;                \
+    }
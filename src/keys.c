@@ -20,11 +20,15 @@
 */
 
 #include "crypto_helpers.h"
+#include "os_pin.h"
 
 #ifndef TARGET_NANOS
 #include "crypto.h"
 #endif
+#include "globals.h"
 #include "keys.h"
+#include "perf.h"
+#include "to_string.h"
 
 /***** Bip32 path *****/
 
@@ -43,6 +47,13 @@ cx_err_t generate_public_key(cx_ecfp_public_key_t *public_key,
 
     cx_err_t error = CX_OK;
 
+    if (is_authorized_key_cached(path_with_curve)) {
+        memmove(public_key,
+                (void const *) &N_authorized_key_cache.public_key,
+                sizeof(tz_ecfp_public_key_t));
+        return CX_OK;
+    }
+
     bip32_path_t const *const bip32_path = &path_with_curve->bip32_path;
     derivation_type_t derivation_type = path_with_curve->derivation_type;
     unsigned int derivation_mode;
@@ -100,6 +111,34 @@ end:
     return error;
 }
 
+cx_err_t compressed_public_key_hash(uint8_t *const hash_out,
+                                    size_t const hash_out_size,
+                                    uint8_t const *const compressed,
+                                    size_t const compressed_len) {
+    if ((hash_out == NULL) || (compressed == NULL)) {
+        return CX_INVALID_PARAMETER;
+    }
+
+    if (hash_out_size < KEY_HASH_SIZE) {
+        return CX_INVALID_PARAMETER_SIZE;
+    }
+
+    cx_err_t error = CX_OK;
+    cx_blake2b_t hash_state;
+    // cx_blake2b_init takes size in bits.
+    CX_CHECK(cx_blake2b_init_no_throw(&hash_state, KEY_HASH_SIZE * 8u));
+
+    CX_CHECK(cx_hash_no_throw((cx_hash_t *) &hash_state,
+                              CX_LAST,
+                              compressed,
+                              compressed_len,
+                              hash_out,
+                              KEY_HASH_SIZE));
+
+end:
+    return error;
+}
+
 /**
  * @brief Extract the public key hash from a public key and a curve
  *
@@ -158,16 +197,8 @@ static cx_err_t public_key_hash(uint8_t *const hash_out,
     }
 
     cx_err_t error = CX_OK;
-    cx_blake2b_t hash_state;
-    // cx_blake2b_init takes size in bits.
-    CX_CHECK(cx_blake2b_init_no_throw(&hash_state, KEY_HASH_SIZE * 8u));
 
-    CX_CHECK(cx_hash_no_throw((cx_hash_t *) &hash_state,
-                              CX_LAST,
-                              compressed->W,
-                              compressed->W_len,
-                              hash_out,
-                              KEY_HASH_SIZE));
+    CX_CHECK(compressed_public_key_hash(hash_out, hash_out_size, compressed->W, compressed->W_len));
 
     if (compressed_out != NULL) {
         memmove(compressed_out, compressed, sizeof(tz_ecfp_compressed_public_key_t));
@@ -185,6 +216,20 @@ cx_err_t generate_public_key_hash(uint8_t *const hash_out,
         return CX_INVALID_PARAMETER;
     }
 
+    if (hash_out_size < KEY_HASH_SIZE) {
+        return CX_INVALID_PARAMETER_SIZE;
+    }
+
+    if (is_authorized_key_cached(path_with_curve)) {
+        memmove(hash_out, (void const *) N_authorized_key_cache.hash, KEY_HASH_SIZE);
+        if (compressed_out != NULL) {
+            memmove(compressed_out,
+                    (void const *) &N_authorized_key_cache.compressed_key,
+                    sizeof(tz_ecfp_compressed_public_key_t));
+        }
+        return CX_OK;
+    }
+
     cx_ecfp_public_key_t *pubkey = (cx_ecfp_public_key_t *) &(tz_ecfp_public_key_t){0};
     cx_err_t error = CX_OK;
 
@@ -200,6 +245,248 @@ end:
     return error;
 }
 
+/***** Authorized key cache *****/
+
+bool is_authorized_key_cached(bip32_path_with_curve_t const *const path_with_curve) {
+    return (path_with_curve != NULL) && (g_baking_key.key.bip32_path.length != 0u) &&
+           bip32_path_with_curve_eq(path_with_curve, &g_baking_key.key) &&
+           bip32_path_with_curve_eq(path_with_curve, &N_authorized_key_cache.key);
+}
+
+/**
+ * @brief Invalidates the authorized key cache in NVRAM
+ */
+static void invalidate_authorized_key_cache(void) {
+    nvm_write((void *) &N_authorized_key_cache.key,
+              &(bip32_path_with_curve_t){0},
+              sizeof(bip32_path_with_curve_t));
+}
+
+cx_err_t update_authorized_key_cache(void) {
+    cx_err_t error = CX_OK;
+
+    bip32_path_with_curve_t const *const key = &g_baking_key.key;
+    cx_ecfp_public_key_t *pubkey = (cx_ecfp_public_key_t *) &(tz_ecfp_public_key_t){0};
+    cx_ecfp_compressed_public_key_t *compressed =
+        (cx_ecfp_compressed_public_key_t *) &(tz_ecfp_compressed_public_key_t){0};
+    uint8_t hash[KEY_HASH_SIZE] = {0};
+    char pkh_string[PKH_STRING_SIZE] = {0};
+
+    // Only write the NVRAM if the cache changes
+    if (key->bip32_path.length == 0u) {
+        if (N_authorized_key_cache.key.bip32_path.length != 0u) {
+            invalidate_authorized_key_cache();
+        }
+        goto end;
+    }
+    if (is_authorized_key_cached(key)) {
+        goto end;
+    }
+
+    CX_CHECK(generate_public_key(pubkey, key));
+    CX_CHECK(public_key_hash(hash, sizeof(hash), compressed, key->derivation_type, pubkey));
+
+    if (pkh_to_string(pkh_string,
+                      sizeof(pkh_string),
+                      derivation_type_to_signature_type(key->derivation_type),
+                      hash) < 0) {
+        error = CX_INVALID_PARAMETER_SIZE;
+        goto end;
+    }
+
+    // Invalidate the cache first so that it is never used half-updated
+    invalidate_authorized_key_cache();
+
+    nvm_write((void *) &N_authorized_key_cache.public_key, pubkey, sizeof(tz_ecfp_public_key_t));
+    nvm_write((void *) &N_authorized_key_cache.compressed_key,
+              compressed,
+              sizeof(tz_ecfp_compressed_public_key_t));
+    nvm_write((void *) N_authorized_key_cache.hash, hash, sizeof(hash));
+    nvm_write((void *) N_authorized_key_cache.pkh_string, pkh_string, sizeof(pkh_string));
+
+    // The cache is valid only once all its data is written
+    nvm_write((void *) &N_authorized_key_cache.key, (void *) key, sizeof(bip32_path_with_curve_t));
+
+end:
+    return error;
+}
+
+/***** Derived key cache *****/
+
+#define G_key_cache global.derived_key_cache
+
+void clear_derived_key_cache(void) {
+    explicit_bzero(&G_key_cache, sizeof(G_key_cache));
+}
+
+cx_err_t cache_derived_key(bip32_path_with_curve_t const *const path_with_curve) {
+    if ((path_with_curve == NULL) || (path_with_curve->bip32_path.length == 0u)) {
+        return CX_INVALID_PARAMETER;
+    }
+
+    cx_err_t error = CX_OK;
+
+    bip32_path_t const *const bip32_path = &path_with_curve->bip32_path;
+    derivation_type_t derivation_type = path_with_curve->derivation_type;
+    unsigned int derivation_mode;
+    cx_curve_t cx_curve;
+
+    clear_derived_key_cache();
+
+    switch (derivation_type) {
+        case DERIVATION_TYPE_ED25519:
+        case DERIVATION_TYPE_BIP32_ED25519: {
+            derivation_mode =
+                (derivation_type == DERIVATION_TYPE_ED25519) ? HDW_ED25519_SLIP10 : HDW_NORMAL;
+            CX_CHECK(bip32_derive_with_seed_init_privkey_256(derivation_mode,
+                                                             CX_CURVE_Ed25519,
+                                                             bip32_path->components,
+                                                             bip32_path->length,
+                                                             &G_key_cache.private_key.sk_256,
+                                                             NULL,
+                                                             NULL,
+                                                             0));
+        } break;
+        case DERIVATION_TYPE_SECP256K1:
+        case DERIVATION_TYPE_SECP256R1: {
+            cx_curve = (derivation_type == DERIVATION_TYPE_SECP256K1) ? CX_CURVE_SECP256K1
+                                                                      : CX_CURVE_SECP256R1;
+            CX_CHECK(bip32_derive_with_seed_init_privkey_256(HDW_NORMAL,
+                                                             cx_curve,
+                                                             bip32_path->components,
+                                                             bip32_path->length,
+                                                             &G_key_cache.private_key.sk_256,
+                                                             NULL,
+                                                             NULL,
+                                                             0));
+        } break;
+#ifndef TARGET_NANOS
+        case DERIVATION_TYPE_BLS12_381: {
+            uint8_t raw_pubkey[BLS_PK_LEN];
+            CX_CHECK(bip32_derive_init_privkey_bls(bip32_path->components,
+                                                   bip32_path->length,
+                                                   &G_key_cache.private_key.sk_384));
+            CX_CHECK(bls_get_pubkey(&G_key_cache.private_key.sk_384, raw_pubkey));
+            memmove(G_key_cache.bls_compressed_pubkey, raw_pubkey + 1, BLS_COMPRESSED_PK_LEN);
+        } break;
+#endif
+        default:
+            error = CX_INVALID_PARAMETER;
+            goto end;
+    }
+
+    if (!copy_bip32_path_with_curve(&G_key_cache.path_with_curve, path_with_curve)) {
+        error = CX_INVALID_PARAMETER;
+        goto end;
+    }
+
+    G_key_cache.is_set = true;
+
+end:
+    if (error != CX_OK) {
+        clear_derived_key_cache();
+    }
+    return error;
+}
+
+/**
+ * @brief Checks whether the derived key cache holds a key
+ *
+ * @param path_with_curve: bip32 path and curve of the key
+ * @return bool: whether the key is cached
+ */
+static bool is_key_cached(bip32_path_with_curve_t const *const path_with_curve) {
+    return G_key_cache.is_set &&
+           bip32_path_with_curve_eq(&G_key_cache.path_with_curve, path_with_curve);
+}
+
+/**
+ * @brief Signs a message with the key held by the derived key cache
+ *
+ *        output_size will be updated to the signature size
+ *
+ * @param out: signature output
+ * @param out_size: output size
+ * @param in: message input
+ * @param in_size: message size
+ * @return cx_err_t: error, CX_OK if none
+ */
+static cx_err_t sign_with_cached_key(uint8_t *const out,
+                                     size_t *out_size,
+                                     uint8_t const *const in,
+                                     size_t const in_size) {
+    cx_err_t error = CX_OK;
+
+    derivation_type_t derivation_type = G_key_cache.path_with_curve.derivation_type;
+    size_t domain_length;
+    uint32_t info;
+
+    switch (derivation_type) {
+        case DERIVATION_TYPE_ED25519:
+        case DERIVATION_TYPE_BIP32_ED25519: {
+            CX_CHECK(cx_eddsa_sign_no_throw((cx_ecfp_private_key_t *) &G_key_cache.private_key,
+                                            CX_SHA512,
+                                            in,
+                                            in_size,
+                                            out,
+                                            *out_size));
+            CX_CHECK(cx_ecdomain_parameters_length(CX_CURVE_Ed25519, &domain_length));
+            *out_size = domain_length * 2u;
+        } break;
+        case DERIVATION_TYPE_SECP256K1:
+        case DERIVATION_TYPE_SECP256R1: {
+            CX_CHECK(cx_ecdsa_sign_no_throw((cx_ecfp_private_key_t *) &G_key_cache.private_key,
+                                            CX_LAST | CX_RND_RFC6979,
+                                            CX_SHA256,
+                                            in,
+                                            in_size,
+                                            out,
+                                            out_size,
+                                            &info));
+            if ((info & CX_ECCINFO_PARITY_ODD) != 0) {
+                out[0] |= 0x01;
+            }
+        } break;
+#ifndef TARGET_NANOS
+        case DERIVATION_TYPE_BLS12_381: {
+            CX_CHECK(bls_sign_hash(&G_key_cache.private_key.sk_384,
+                                   G_key_cache.bls_compressed_pubkey,
+                                   in,
+                                   in_size,
+                                   out,
+                                   out_size));
+        } break;
+#endif
+        default:
+            error = CX_INVALID_PARAMETER;
+    }
+
+end:
+    return error;
+}
+
+/**
+ * @brief Checks whether a signature can use the derived key cache
+ *
+ *        Caches the baking key if it has not been cached yet
+ *
+ * @param path_with_curve: bip32 path and curve of the key
+ * @return bool: whether the key is cached
+ */
+static bool use_derived_key_cache(bip32_path_with_curve_t const *const path_with_curve) {
+    if (os_global_pin_is_validated() != BOLOS_UX_OK) {
+        // Never keep a derived key while the device is locked
+        clear_derived_key_cache();
+        return false;
+    }
+    if (!is_key_cached(path_with_curve) &&
+        bip32_path_with_curve_eq(path_with_curve, &g_baking_key.key)) {
+        // Ignore derivation errors: the key will be derived for this signature only
+        PERF_MEASURE(PERF_PHASE_KEY_DERIVATION, (void) cache_derived_key(path_with_curve));
+    }
+    return is_key_cached(path_with_curve);
+}
+
 cx_err_t sign(uint8_t *const out,
               size_t *out_size,
               bip32_path_with_curve_t const *const path_with_curve,
@@ -211,6 +498,10 @@ cx_err_t sign(uint8_t *const out,
 
     cx_err_t error = CX_OK;
 
+    if (use_derived_key_cache(path_with_curve)) {
+        return sign_with_cached_key(out, out_size, (uint8_t const *) PIC(in), in_size);
+    }
+
     bip32_path_t const *const bip32_path = &path_with_curve->bip32_path;
     derivation_type_t derivation_type = path_with_curve->derivation_type;
     unsigned int derivation_mode;
@@ -255,8 +546,14 @@ cx_err_t sign(uint8_t *const out,
         } break;
 #ifndef TARGET_NANOS
         case DERIVATION_TYPE_BLS12_381: {
+            // Reuse the stored compressed public key of the authorized key if any
+            uint8_t const *compressed_pubkey =
+                is_authorized_key_cached(path_with_curve)
+                    ? (uint8_t const *) N_authorized_key_cache.compressed_key.pk_bls.W
+                    : NULL;
             CX_CHECK(bip32_derive_with_seed_bls_sign_hash(bip32_path->components,
                                                           bip32_path->length,
+                                                          compressed_pubkey,
                                                           (uint8_t const *) PIC(in),
                                                           in_size,
                                                           out,
@@ -270,3 +567,80 @@ cx_err_t sign(uint8_t *const out,
 end:
     return error;
 }
+
+#ifndef TARGET_NANOS
+cx_err_t load_bls_signing_key(derived_key_cache_t *const signing_key,
+                              bip32_path_with_curve_t const *const path_with_curve,
+                              uint8_t compressed_pubkey[static BLS_COMPRESSED_PK_LEN]) {
+    if ((signing_key == NULL) || (path_with_curve == NULL) ||
+        (path_with_curve->derivation_type != DERIVATION_TYPE_BLS12_381)) {
+        return CX_INVALID_PARAMETER;
+    }
+
+    explicit_bzero(signing_key, sizeof(derived_key_cache_t));
+
+    if (use_derived_key_cache(path_with_curve)) {
+        memmove(compressed_pubkey, G_key_cache.bls_compressed_pubkey, BLS_COMPRESSED_PK_LEN);
+        return CX_OK;
+    }
+
+    cx_err_t error = CX_OK;
+    uint8_t raw_pubkey[BLS_PK_LEN] = {0};
+
+    PERF_MEASURE(PERF_PHASE_KEY_DERIVATION,
+                 CX_CHECK(bip32_derive_init_privkey_bls(path_with_curve->bip32_path.components,
+                                                        path_with_curve->bip32_path.length,
+                                                        &signing_key->private_key.sk_384)));
+    CX_CHECK(bls_get_pubkey(&signing_key->private_key.sk_384, raw_pubkey));
+    memmove(signing_key->bls_compressed_pubkey, raw_pubkey + 1, BLS_COMPRESSED_PK_LEN);
+    memmove(compressed_pubkey, raw_pubkey + 1, BLS_COMPRESSED_PK_LEN);
+
+    if (!copy_bip32_path_with_curve(&signing_key->path_with_curve, path_with_curve)) {
+        error = CX_INVALID_PARAMETER;
+        goto end;
+    }
+
+    signing_key->is_set = true;
+
+end:
+    if (error != CX_OK) {
+        explicit_bzero(signing_key, sizeof(derived_key_cache_t));
+    }
+    return error;
+}
+
+cx_err_t sign_bls_field_hash(uint8_t *const out,
+                             size_t *out_size,
+                             bip32_path_with_curve_t const *const path_with_curve,
+                             derived_key_cache_t *const signing_key,
+                             uint8_t const hash[static BLS_FIELD_HASH_LEN]) {
+    if ((out == NULL) || (out_size == NULL) || (path_with_curve == NULL) ||
+        (path_with_curve->derivation_type != DERIVATION_TYPE_BLS12_381)) {
+        return CX_INVALID_PARAMETER;
+    }
+
+    cx_err_t error = CX_OK;
+    cx_ecfp_384_private_key_t privkey = {0};
+
+    if ((signing_key != NULL) && signing_key->is_set &&
+        bip32_path_with_curve_eq(&signing_key->path_with_curve, path_with_curve)) {
+        // Derived when the message started to be hashed
+        CX_CHECK(bls_sign_field_hash(&signing_key->private_key.sk_384, hash, out, out_size));
+    } else if (use_derived_key_cache(path_with_curve)) {
+        CX_CHECK(bls_sign_field_hash(&G_key_cache.private_key.sk_384, hash, out, out_size));
+    } else {
+        PERF_MEASURE(PERF_PHASE_KEY_DERIVATION,
+                     CX_CHECK(bip32_derive_init_privkey_bls(path_with_curve->bip32_path.components,
+                                                            path_with_curve->bip32_path.length,
+                                                            &privkey)));
+        CX_CHECK(bls_sign_field_hash(&privkey, hash, out, out_size));
+    }
+
+end:
+    explicit_bzero(&privkey, sizeof(privkey));
+    if (signing_key != NULL) {
+        explicit_bzero(signing_key, sizeof(derived_key_cache_t));
+    }
+    return error;
+}
+#endif
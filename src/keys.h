@@ -203,6 +203,35 @@ static inline bool bip32_path_with_curve_eq(bip32_path_with_curve_t volatile con
 #define COMPRESSED_PK_LEN 33u
 #define TZ_EDPK_LEN       (COMPRESSED_PK_LEN - 1u)
 
+/// Length of the longest compressed public key
+#ifdef TARGET_NANOS
+#define MAX_COMPRESSED_PK_LEN COMPRESSED_PK_LEN
+#else
+#define MAX_COMPRESSED_PK_LEN BLS_COMPRESSED_PK_LEN
+#endif
+
+/**
+ * @brief Gets the length of the compressed public keys of a signature_type
+ *
+ * @param signature_type: signature_type
+ * @return size_t: length of the keys, 0 if the signature_type is not handled
+ */
+static inline size_t signature_type_to_public_key_len(signature_type_t const signature_type) {
+    switch (signature_type) {
+        case SIGNATURE_TYPE_ED25519:
+            return TZ_EDPK_LEN;
+        case SIGNATURE_TYPE_SECP256K1:
+        case SIGNATURE_TYPE_SECP256R1:
+            return COMPRESSED_PK_LEN;
+#ifndef TARGET_NANOS
+        case SIGNATURE_TYPE_BLS12_381:
+            return BLS_COMPRESSED_PK_LEN;
+#endif
+        default:
+            return 0u;
+    }
+}
+
 /**
  * @brief This structure represents elliptic curve public key handled
  *        Can be explicitly cast into `cx_ecfp_public_key_t`
@@ -255,6 +284,35 @@ typedef union {
 #endif
 } tz_ecfp_compressed_public_key_t;
 
+/**
+ * @brief This structure represents elliptic curve private key handled
+ *        Can be explicitly cast into `cx_ecfp_private_key_t`
+ */
+typedef union {
+    cx_ecfp_256_private_key_t sk_256;  ///< edsk, spsk and p2sk keys
+#ifndef TARGET_NANOS
+    cx_ecfp_384_private_key_t sk_384;  ///< BLsk keys
+#endif
+} tz_ecfp_private_key_t;
+
+/**
+ * @brief This structure represents a derived key held in RAM
+ *
+ *        Avoids deriving the key from the seed on every signature.
+ *
+ *        Must be wiped as soon as the key is not needed anymore
+ *        (deauthorization, setup, PIN lock, exit).
+ */
+typedef struct {
+    bool is_set;                              ///< whether the cache holds a derived key
+    bip32_path_with_curve_t path_with_curve;  ///< bip32 path and curve of the cached key
+    tz_ecfp_private_key_t private_key;        ///< derived private key
+#ifndef TARGET_NANOS
+    /// BLS compressed public key, used as augmentation prefix when signing
+    uint8_t bls_compressed_pubkey[BLS_COMPRESSED_PK_LEN];
+#endif
+} derived_key_cache_t;
+
 /**
  * @brief Generates a public key from a bip32 path and a curve
  *
@@ -265,6 +323,20 @@ typedef union {
 cx_err_t generate_public_key(cx_ecfp_public_key_t *public_key,
                              bip32_path_with_curve_t const *const path_with_curve);
 
+/**
+ * @brief Hashes a compressed public key into a public key hash
+ *
+ * @param hash_out: public key hash output
+ * @param hash_out_size: output size
+ * @param compressed: compressed public key
+ * @param compressed_len: length of the compressed public key
+ * @return cx_err_t: error, CX_OK if none
+ */
+cx_err_t compressed_public_key_hash(uint8_t *const hash_out,
+                                    size_t const hash_out_size,
+                                    uint8_t const *const compressed,
+                                    size_t const compressed_len);
+
 /**
  * @brief Generates a public key hash from a bip32 path and a curve
  *
@@ -280,9 +352,52 @@ cx_err_t generate_public_key_hash(uint8_t *const hash_out,
                                   cx_ecfp_compressed_public_key_t *const compressed_out,
                                   bip32_path_with_curve_t const *const path_with_curve);
 
+/**
+ * @brief Checks whether the public data of a key is held by the
+ *        authorized key cache
+ *
+ *        The cache is only used for the first authorized key
+ *
+ * @param path_with_curve: bip32 path and curve of the key
+ * @return bool: whether the public data of the key is cached
+ */
+bool is_authorized_key_cached(bip32_path_with_curve_t const *const path_with_curve);
+
+/**
+ * @brief Updates the authorized key cache in NVRAM with the public
+ *        data of the first authorized key
+ *
+ *        The cache is invalidated if there is no authorized key. The
+ *        NVRAM is not written if the cache is already up to date.
+ *
+ * @return cx_err_t: error, CX_OK if none
+ */
+cx_err_t update_authorized_key_cache(void);
+
+/**
+ * @brief Derives a key from the seed and stores it in the derived key cache
+ *
+ *        Any key previously cached is wiped
+ *
+ *        Expects validated pin
+ *
+ * @param path_with_curve: bip32 path and curve of the key
+ * @return cx_err_t: error, CX_OK if none
+ */
+cx_err_t cache_derived_key(bip32_path_with_curve_t const *const path_with_curve);
+
+/**
+ * @brief Wipes the derived key cache
+ *
+ */
+void clear_derived_key_cache(void);
+
 /**
  * @brief Signs a message with a key
  *
+ *        Uses the derived key cache if it holds the key. The
+ *        authorized key is cached on its first use.
+ *
  *        output_size will be updated to the signature size
  *
  * @param out: signature output
@@ -297,3 +412,43 @@ cx_err_t sign(uint8_t *const out,
               bip32_path_with_curve_t const *const path_with_curve,
               uint8_t const *const in,
               size_t const in_size);
+
+#ifndef TARGET_NANOS
+/**
+ * @brief Gets the compressed public key of a BLS key, to start hashing a message to sign
+ *
+ *        Uses the derived key cache like `sign`. Otherwise the key is
+ *        derived and kept in `signing_key` until `sign_bls_field_hash`,
+ *        so that it is derived once per signature.
+ *
+ * @param signing_key: key derived for this signature only
+ * @param path_with_curve: bip32 path and curve of the key
+ * @param compressed_pubkey: compressed public key output
+ * @return cx_err_t: error, CX_OK if none
+ */
+cx_err_t load_bls_signing_key(derived_key_cache_t *const signing_key,
+                              bip32_path_with_curve_t const *const path_with_curve,
+                              uint8_t compressed_pubkey[static BLS_COMPRESSED_PK_LEN]);
+
+/**
+ * @brief Signs a message already hashed to the BLS12-381 field with a BLS key
+ *
+ *        Uses the key loaded by `load_bls_signing_key` if any, the
+ *        derived key cache like `sign` otherwise. The loaded key is
+ *        wiped.
+ *
+ *        output_size will be updated to the signature size
+ *
+ * @param out: signature output
+ * @param out_size: output size
+ * @param path_with_curve: bip32 path and curve of the key
+ * @param signing_key: key loaded by `load_bls_signing_key`, can be NULL
+ * @param hash: message hashed with `bls_hash_to_field_final`
+ * @return cx_err_t: error, CX_OK if none
+ */
+cx_err_t sign_bls_field_hash(uint8_t *const out,
+                             size_t *out_size,
+                             bip32_path_with_curve_t const *const path_with_curve,
+                             derived_key_cache_t *const signing_key,
+                             uint8_t const hash[static BLS_FIELD_HASH_LEN]);
+#endif
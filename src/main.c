@@ -20,8 +20,11 @@
 */
 
 #include "apdu.h"
+#include "apdu_hmac.h"
 #include "globals.h"
 #include "memory.h"
+#include "os_pin.h"
+#include "perf.h"
 #include "ui.h"
 
 void app_main(void);
@@ -38,11 +41,19 @@ void app_main(void) {
     for (;;) {
         // Receive command bytes in G_io_apdu_buffer
         input_len = io_recv_command();
+        // Timed from the arrival of the apdu, not while waiting for it
+        PERF_TIMESTAMP(perf_received);
         if (input_len < 0) {
             PRINTF("=> io_recv_command failure\n");
             return;
         }
 
+        if (os_global_pin_is_validated() != BOLOS_UX_OK) {
+            // The device has been locked: wipe the derived keys
+            clear_derived_key_cache();
+            clear_hmac_key_cache();
+        }
+
         // Parse APDU command from G_io_apdu_buffer
         if (!apdu_parser(&cmd, G_io_apdu_buffer, input_len)) {
             PRINTF("=> /!\\ BAD LENGTH: %.*H\n", input_len, G_io_apdu_buffer);
@@ -59,8 +70,12 @@ void app_main(void) {
                cmd.lc,
                cmd.data);
 
+        PERF_RECORD(PERF_PHASE_APDU_RECEIVE, perf_received);
+
         // Dispatch structured APDU command to handler
-        if (apdu_dispatcher(&cmd) < 0) {
+        int result = 0;
+        PERF_MEASURE_INS(cmd.ins, perf_received, result = apdu_dispatcher(&cmd));
+        if (result < 0) {
             PRINTF("=> apdu_dispatcher failure\n");
             return;
         }
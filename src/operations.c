@@ -25,6 +25,7 @@
 #include "apdu.h"
 #include "globals.h"
 #include "memory.h"
+#include "read.h"
 #include "to_string.h"
 #include "ui.h"
 
@@ -156,20 +157,29 @@ end:
 #define CALL_SUBPARSER_LN(func, line, ...) PARSER_CHECK(func(__VA_ARGS__, line))
 #define CALL_SUBPARSER(func, ...)          CALL_SUBPARSER_LN(func, __LINE__, __VA_ARGS__)
 
-#define NEXT_BYTE (byte)
+// Reads the next byte, the step being called with some bytes left
+#define NEXT_BYTE                                   \
+    ({                                              \
+        uint8_t byte_ = 0;                          \
+        PARSER_ASSERT(buffer_read_u8(buf, &byte_)); \
+        byte_;                                      \
+    })
 
 /**
  * @brief Parses a Z number
  *
- * @param current_byte: the current read byte
+ *        Reads as many bytes of the number as the buffer holds
+ *
+ * @param buf: input buffer
  * @param state: parsing state
  * @param lineno: line number of the caller
  * @return tz_parser_result: result of the parsing
  */
-static inline tz_parser_result parse_z(uint8_t current_byte,
+static inline tz_parser_result parse_z(buffer_t *buf,
                                        struct int_subparser_state *state,
                                        uint32_t lineno) {
     tz_parser_result res = PARSER_CONTINUE;
+    uint8_t current_byte;
 
     if (state->lineno != lineno) {
         // New call; initialize.
@@ -177,36 +187,96 @@ static inline tz_parser_result parse_z(uint8_t current_byte,
         state->value = 0;
         state->shift = 0;
     }
-    // Fails when the resulting shifted value overflows 64 bits
-    if ((state->shift > 63u) || ((state->shift == 63u) && (current_byte != 1u))) {
-        PARSER_FAIL();
+    while (buffer_read_u8(buf, &current_byte)) {
+        // Fails when the resulting shifted value overflows 64 bits
+        if ((state->shift > 63u) || ((state->shift == 63u) && (current_byte != 1u))) {
+            PARSER_FAIL();
+        }
+        state->value |= ((uint64_t) current_byte & 0x7Fu) << state->shift;
+        state->shift += 7u;
+
+        if ((current_byte & 0x80u) == 0u) {
+            res = PARSER_DONE;
+            break;
+        }
     }
-    state->value |= ((uint64_t) current_byte & 0x7Fu) << state->shift;
-    state->shift += 7u;
 
-    if ((current_byte & 0x80u) == 0u) {
-        res = PARSER_DONE;
+end:
+    return res;
+}
+#define PARSE_Z                                                           \
+    ({                                                                    \
+        CALL_SUBPARSER(parse_z, buf, &(state)->subparser_state.integer); \
+        (state)->subparser_state.integer.value;                           \
+    })
+
+/**
+ * @brief Parses a non-negative Micheline integer
+ *
+ *        Micheline integers are signed: the first byte holds the sign
+ *        bit and 6 bits of the number. Only numbers holding on 62 bits
+ *        are accepted
+ *
+ *        Reads as many bytes of the number as the buffer holds
+ *
+ * @param buf: input buffer
+ * @param state: parsing state
+ * @param lineno: line number of the caller
+ * @return tz_parser_result: result of the parsing
+ */
+static inline tz_parser_result parse_micheline_nat(buffer_t *buf,
+                                                   struct int_subparser_state *state,
+                                                   uint32_t lineno) {
+    tz_parser_result res = PARSER_CONTINUE;
+    uint8_t current_byte;
+
+    if (state->lineno != lineno) {
+        // New call; initialize.
+        state->lineno = lineno;
+        state->value = 0;
+        state->shift = 0;
+    }
+    while (buffer_read_u8(buf, &current_byte)) {
+        if (state->shift == 0u) {
+            // Negative numbers are refused
+            PARSER_ASSERT((current_byte & 0x40u) == 0u);
+            state->value = (uint64_t) current_byte & 0x3Fu;
+            state->shift = 6u;
+        } else {
+            PARSER_ASSERT(state->shift <= 55u);
+            state->value |= ((uint64_t) current_byte & 0x7Fu) << state->shift;
+            state->shift += 7u;
+        }
+
+        if ((current_byte & 0x80u) == 0u) {
+            res = PARSER_DONE;
+            break;
+        }
     }
 
 end:
     return res;
 }
-#define PARSE_Z                                                             \
-    ({                                                                      \
-        CALL_SUBPARSER(parse_z, (byte), &(state)->subparser_state.integer); \
-        (state)->subparser_state.integer.value;                             \
+#define PARSE_MICHELINE_NAT                                                           \
+    ({                                                                                \
+        CALL_SUBPARSER(parse_micheline_nat, buf, &(state)->subparser_state.integer); \
+        (state)->subparser_state.integer.value;                                       \
     })
 
 /**
  * @brief Parses a wire type
  *
- * @param current_byte: the current read byte
+ *        Copies in one go as many bytes of the type as the buffer
+ *        holds, so that only a type split across two parts of the
+ *        group is filled in several calls
+ *
+ * @param buf: input buffer
  * @param state: parsing state
  * @param sizeof_type: size of the type
  * @param lineno: line number of the caller
  * @return tz_parser_result: result of the parsing
  */
-static tz_parser_result parse_next_type(uint8_t current_byte,
+static tz_parser_result parse_next_type(buffer_t *buf,
                                         struct nexttype_subparser_state *state,
                                         uint32_t sizeof_type,
                                         uint32_t lineno) {
@@ -224,40 +294,31 @@ static tz_parser_result parse_next_type(uint8_t current_byte,
         state->fill_idx = 0;
     }
 
-    state->body.raw[state->fill_idx] = current_byte;
-    state->fill_idx++;
+    PARSER_ASSERT(state->fill_idx < sizeof_type);
+
+    size_t const len = CUSTOM_MIN(sizeof_type - state->fill_idx, buf->size - buf->offset);
+    PARSER_ASSERT(buffer_move(buf, state->body.raw + state->fill_idx, len));
+    state->fill_idx += len;
 
     if (state->fill_idx == sizeof_type) {
         res = PARSER_DONE;
     }
 
-    if (state->fill_idx > sizeof_type) {
-        PARSER_FAIL();
-    }
-
 end:
     return res;
 }
 // do _NOT_ keep pointers to this data around.
-#define NEXT_TYPE(type)                                                                          \
-    ({                                                                                           \
-        CALL_SUBPARSER(parse_next_type, byte, &(state->subparser_state.nexttype), sizeof(type)); \
-        (const type *) &(state->subparser_state.nexttype.body);                                  \
+#define NEXT_TYPE(type)                                                                         \
+    ({                                                                                          \
+        CALL_SUBPARSER(parse_next_type, buf, &(state->subparser_state.nexttype), sizeof(type)); \
+        (const type *) &(state->subparser_state.nexttype.body);                                 \
     })
 
 // End of subparsers.
 
-/**
- * @brief Initialize the operation parser
- *
- * @param out: parsing output
- * @param path_with_curve: bip32 path and curve of the key
- * @param state: parsing state
- * @return tz_exc: exception, SW_OK if none
- */
-static tz_exc parse_operations_init(struct parsed_operation_group *const out,
-                                    bip32_path_with_curve_t const *const path_with_curve,
-                                    struct parse_state *const state) {
+tz_exc parse_operations_init(struct parsed_operation_group *const out,
+                             bip32_path_with_curve_t const *const path_with_curve,
+                             struct parse_state *const state) {
     tz_exc exc = SW_OK;
 
     TZ_ASSERT_NOT_NULL(out);
@@ -277,6 +338,7 @@ static tz_exc parse_operations_init(struct parsed_operation_group *const out,
     state->op_step = 0;
     state->subparser_state.integer.lineno = -1;
     state->tag = OPERATION_TAG_NONE;  // This and the rest shouldn't be required.
+    state->parameters_size = 0;
 
 end:
     return exc;
@@ -287,6 +349,32 @@ end:
 #define STEP_OP_TYPE_DISPATCH     10001
 #define STEP_AFTER_MANAGER_FIELDS 10002
 #define STEP_HAS_DELEGATE         10003
+#define STEP_PARAMETERS_UNIT      10004
+
+/// Micheline encoding of the parameters of the staking entrypoints
+#define MICHELINE_TAG_INT          0x00u  ///< integer
+#define MICHELINE_TAG_PRIM_NO_ARGS 0x03u  ///< primitive without argument nor annotation
+#define MICHELINE_TAG_PRIM_2_ARGS  0x07u  ///< primitive with 2 arguments and no annotation
+#define MICHELINE_PRIM_PAIR        0x07u  ///< `Pair`
+#define MICHELINE_PRIM_UNIT        0x0Bu  ///< `Unit`
+
+/// Tag of the parameters of a transaction when they are present
+#define TRANSACTION_PARAMETERS_PRESENT 0xFFu
+
+/**
+ * @brief Accounts for bytes read in the parameters of a transaction
+ *
+ * @param state: parsing state
+ * @param size: number of bytes read
+ * @return bool: whether the parameters hold these bytes
+ */
+static inline bool consume_parameters(struct parse_state *const state, uint32_t size) {
+    if (state->parameters_size < size) {
+        return false;
+    }
+    state->parameters_size -= size;
+    return true;
+}
 
 bool parse_operations_final(struct parse_state *const state,
                             struct parsed_operation_group *const out) {
@@ -300,14 +388,18 @@ bool parse_operations_final(struct parse_state *const state,
 }
 
 /**
- * @brief Parse one bytes regarding the current parsing state
+ * @brief Parse one step regarding the current parsing state
+ *
+ *        A step reads a field: a single byte, a Z number or a wire
+ *        type. It consumes at least one byte and stops at the end of
+ *        the field or of the buffer, whichever comes first
  *
- * @param byte: byte to read
+ * @param buf: input buffer, holding at least one byte
  * @param state: parsing state
  * @param out: parsing output
  * @return tz_parser_result: result of the parsing
  */
-static inline tz_parser_result parse_byte(uint8_t byte,
+static inline tz_parser_result parse_step(buffer_t *buf,
                                           struct parse_state *const state,
                                           struct parsed_operation_group *const out) {
     tz_parser_result res = PARSER_CONTINUE;
@@ -363,7 +455,9 @@ static inline tz_parser_result parse_byte(uint8_t byte,
             switch (state->tag) {
                 // Tags that don't have "originated" byte only support tz accounts, not KT or tz.
                 case OPERATION_TAG_DELEGATION:
-                case OPERATION_TAG_REVEAL: {
+                case OPERATION_TAG_REVEAL:
+                case OPERATION_TAG_TRANSACTION:
+                case OPERATION_TAG_UPDATE_CONSENSUS_KEY: {
                     struct implicit_contract const *const implicit_source =
                         NEXT_TYPE(struct implicit_contract);
 
@@ -427,7 +521,7 @@ static inline tz_parser_result parse_byte(uint8_t byte,
 
                 // klen must match one of the field sizes in the public_key union
 
-                CALL_SUBPARSER(parse_next_type, byte, &(state->subparser_state.nexttype), klen);
+                CALL_SUBPARSER(parse_next_type, buf, &(state->subparser_state.nexttype), klen);
 
                 PARSER_ASSERT(memcmp(((cx_ecfp_compressed_public_key_t *) &out->public_key)->W,
                                      &(state->subparser_state.nexttype.body.raw),
@@ -472,6 +566,150 @@ static inline tz_parser_result parse_byte(uint8_t byte,
                                                     &dlg->signature_type,
                                                     dlg->hash));
                     }
+                        JMP_TO_TOP;  // These go back to the top to catch any reveals.
+                    default:         // Any other tag; probably not possible here.
+                        PARSER_FAIL();
+                }
+            } else if (state->tag == OPERATION_TAG_UPDATE_CONSENSUS_KEY) {
+                switch (state->op_step) {
+                    case STEP_OP_TYPE_DISPATCH: {
+                        raw_tezos_header_signature_type_t const *const sig_type =
+                            NEXT_TYPE(raw_tezos_header_signature_type_t);
+                        PARSER_CHECK(parse_raw_tezos_header_signature_type(
+                            sig_type,
+                            &out->operation.consensus_key.signature_type));
+                    }
+
+                        OP_STEP
+
+                        {
+                            size_t const klen = signature_type_to_public_key_len(
+                                out->operation.consensus_key.signature_type);
+                            PARSER_ASSERT(klen != 0u);
+
+                            CALL_SUBPARSER(parse_next_type,
+                                           buf,
+                                           &(state->subparser_state.nexttype),
+                                           klen);
+
+                            memcpy(out->operation.consensus_key.W,
+                                   state->subparser_state.nexttype.body.raw,
+                                   klen);
+                        }
+
+                        JMP_TO_TOP;  // These go back to the top to catch any reveals.
+                    default:         // Any other tag; probably not possible here.
+                        PARSER_FAIL();
+                }
+            } else if (state->tag == OPERATION_TAG_TRANSACTION) {
+                // Only the staking operations are accepted: a transaction
+                // from the key to itself calling a staking entrypoint
+                switch (state->op_step) {
+                    case STEP_OP_TYPE_DISPATCH:
+
+                        out->operation.amount = PARSE_Z;  // amount
+
+                        OP_STEP
+
+                        {
+                            struct contract_id const *const destination =
+                                NEXT_TYPE(struct contract_id);
+                            PARSER_ASSERT(destination->originated == 0u);
+                            PARSER_CHECK(parse_implicit(&out->operation.destination,
+                                                        &destination->implicit.signature_type,
+                                                        destination->implicit.pkh));
+                            PARSER_ASSERT(COMPARE(out->operation.destination, out->signing) == 0);
+                        }
+
+                        OP_STEP
+
+                        PARSER_ASSERT(NEXT_BYTE == TRANSACTION_PARAMETERS_PRESENT);
+
+                        OP_STEP
+
+                        out->operation.entrypoint = (staking_entrypoint_t) NEXT_BYTE;
+                        switch (out->operation.entrypoint) {
+                            case STAKING_ENTRYPOINT_STAKE:
+                            case STAKING_ENTRYPOINT_UNSTAKE:
+                                break;
+                            case STAKING_ENTRYPOINT_FINALIZE_UNSTAKE:
+                            case STAKING_ENTRYPOINT_SET_DELEGATE_PARAMETERS:
+                                PARSER_ASSERT(out->operation.amount == 0u);
+                                break;
+                            default:
+                                PARSER_FAIL();
+                        }
+
+                        OP_STEP
+
+                        {
+                            struct micheline_size const *const size =
+                                NEXT_TYPE(struct micheline_size);
+                            state->parameters_size = read_u32_be(size->size, 0);
+                        }
+
+                        OP_JMPIF(STEP_PARAMETERS_UNIT,
+                                 out->operation.entrypoint !=
+                                     STAKING_ENTRYPOINT_SET_DELEGATE_PARAMETERS)
+
+                        OP_STEP
+
+                        // Pair <limit_of_staking_over_baking>
+                        //      (Pair <edge_of_baking_over_staking> Unit)
+                        PARSER_ASSERT(consume_parameters(state, 1u) &&
+                                      (NEXT_BYTE == MICHELINE_TAG_PRIM_2_ARGS));
+
+                        OP_STEP
+
+                        PARSER_ASSERT(consume_parameters(state, 1u) &&
+                                      (NEXT_BYTE == MICHELINE_PRIM_PAIR));
+
+                        OP_STEP
+
+                        PARSER_ASSERT(consume_parameters(state, 1u) &&
+                                      (NEXT_BYTE == MICHELINE_TAG_INT));
+
+                        OP_STEP
+
+                        out->operation.staking_limit = PARSE_MICHELINE_NAT;
+                        PARSER_ASSERT(consume_parameters(
+                            state,
+                            1u + ((state->subparser_state.integer.shift - 6u) / 7u)));
+
+                        OP_STEP
+
+                        PARSER_ASSERT(consume_parameters(state, 1u) &&
+                                      (NEXT_BYTE == MICHELINE_TAG_PRIM_2_ARGS));
+
+                        OP_STEP
+
+                        PARSER_ASSERT(consume_parameters(state, 1u) &&
+                                      (NEXT_BYTE == MICHELINE_PRIM_PAIR));
+
+                        OP_STEP
+
+                        PARSER_ASSERT(consume_parameters(state, 1u) &&
+                                      (NEXT_BYTE == MICHELINE_TAG_INT));
+
+                        OP_STEP
+
+                        out->operation.staking_edge = PARSE_MICHELINE_NAT;
+                        PARSER_ASSERT(consume_parameters(
+                            state,
+                            1u + ((state->subparser_state.integer.shift - 6u) / 7u)));
+
+                        OP_NAMED_STEP(STEP_PARAMETERS_UNIT)
+
+                        PARSER_ASSERT(consume_parameters(state, 1u) &&
+                                      (NEXT_BYTE == MICHELINE_TAG_PRIM_NO_ARGS));
+
+                        OP_STEP
+
+                        PARSER_ASSERT(consume_parameters(state, 1u) &&
+                                      (NEXT_BYTE == MICHELINE_PRIM_UNIT));
+                        // The parameters must hold nothing else
+                        PARSER_ASSERT(state->parameters_size == 0u);
+
                         JMP_TO_TOP;  // These go back to the top to catch any reveals.
                     default:         // Any other tag; probably not possible here.
                         PARSER_FAIL();
@@ -488,17 +726,15 @@ end:
 
 #define G global.apdu.u.sign
 
-tz_exc parse_operations(buffer_t *buf,
-                        struct parsed_operation_group *const out,
-                        bip32_path_with_curve_t const *const path_with_curve) {
+tz_exc parse_operations(buffer_t *buf, struct parsed_operation_group *const out) {
     tz_exc exc = SW_OK;
-    uint8_t byte;
 
-    TZ_CHECK(parse_operations_init(out, path_with_curve, &G.parse_state));
+    TZ_ASSERT_NOT_NULL(buf);
+    TZ_ASSERT_NOT_NULL(out);
 
-    while (buffer_read_u8(buf, &byte) == true) {
-        TZ_ASSERT(parse_byte(byte, &G.parse_state, out) != PARSER_ERROR, EXC_PARSE_ERROR);
-        PRINTF("Byte: %x - Next op_step state: %d\n", byte, G.parse_state.op_step);
+    while (buffer_can_read(buf, 1u)) {
+        TZ_ASSERT(parse_step(buf, &G.parse_state, out) != PARSER_ERROR, EXC_PARSE_ERROR);
+        PRINTF("Next op_step state: %d\n", G.parse_state.op_step);
     }
 
 end:
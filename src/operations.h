@@ -78,6 +78,25 @@ struct delegation_contents {
     uint8_t hash[KEY_HASH_SIZE];                       ///< raw delegate
 } __attribute__((packed));
 
+/**
+ * @brief Wire representation of contract id
+ *
+ *        An originated contract is a 20 bytes hash followed by a
+ *        padding byte, so that both kinds have the same size
+ */
+struct contract_id {
+    uint8_t originated;                 ///< 0 for an implicit contract
+    struct implicit_contract implicit;  ///< implicit contract
+} __attribute__((packed));
+
+/**
+ * @brief Wire representation of the size of a Micheline expression
+ *
+ */
+struct micheline_size {
+    uint8_t size[4];  ///< big-endian size, in bytes
+} __attribute__((packed));
+
 /**
  * @brief This structure represents the state of a Z parser
  *
@@ -111,10 +130,15 @@ struct nexttype_subparser_state {
 
         struct delegation_contents dc;  ///< wire delegation content
 
+        struct contract_id cid;  ///< wire contract id
+
+        struct micheline_size ms;  ///< wire Micheline expression size
+
         // Required to read Reveal public key
         union public_key pk;  ///< wire public key
 
-        uint8_t raw[1];  ///< raw array to fill the body
+        uint8_t raw[sizeof(union public_key)];  ///< raw array to fill the body, as large as the
+                                                ///< largest wire type
     } body;
     uint32_t fill_idx;  ///< current fill index
 };
@@ -136,26 +160,44 @@ struct parse_state {
     int16_t op_step;                        ///< current parsing step
     union subparser_state subparser_state;  ///< state of subparser
     enum operation_tag tag;                 ///< current operation tag
+    uint32_t parameters_size;               ///< bytes left in the transaction parameters
 };
 
 /**
- * @brief Parses a group of operation
+ * @brief Initialize the operation parser
+ *
+ *        Must be called once before parsing the first part of a group
+ *        of operation
+ *
+ * @param out: parsing output
+ * @param path_with_curve: bip32 path and curve of the key
+ * @param state: parsing state
+ * @return tz_exc: exception, SW_OK if none
+ */
+tz_exc parse_operations_init(struct parsed_operation_group *const out,
+                             bip32_path_with_curve_t const *const path_with_curve,
+                             struct parse_state *const state);
+
+/**
+ * @brief Parses a part of a group of operation
  *
  *        Allows arbitrarily many "REVEAL" operations but only one
  *        operation of any other type, which is the one it puts into
- *        the group.
+ *        the group: a delegation, a consensus key update or a staking
+ *        operation, i.e. a transaction from the key to itself calling
+ *        a staking entrypoint.
  *
- *        Some checks are carried out during the parsing using a key using a key
+ *        Some checks are carried out during the parsing using the key
+ *        given to `parse_operations_init`
  *
- * @param buf: input operation
+ *        The parsing resumes where the previous part stopped, so the
+ *        group can be split at any byte
+ *
+ * @param buf: input operation part
  * @param out: parsing output
- * @param curve: curve of the key
- * @param path_with_curve: bip32 path and curve of the key
  * @return tz_exc: exception, SW_OK if none
  */
-tz_exc parse_operations(buffer_t *buf,
-                        struct parsed_operation_group *const out,
-                        bip32_path_with_curve_t const *const path_with_curve);
+tz_exc parse_operations(buffer_t *buf, struct parsed_operation_group *const out);
 
 /**
  * @brief Checks parsing has been completed successfully
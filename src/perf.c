@@ -0,0 +1,116 @@
+/* Tezos Ledger application - Phase timers
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#include "perf.h"
+
+#ifdef HAVE_PERF_COUNTERS
+
+#include "globals.h"
+
+#include <string.h>
+
+void perf_reset(void) {
+    memset(global.perf_counters, 0, sizeof(global.perf_counters));
+    memset(global.perf_histograms, 0, sizeof(global.perf_histograms));
+    memset(global.perf_signed, 0, sizeof(global.perf_signed));
+}
+
+void perf_record(perf_phase_t phase, uint32_t start) {
+    if (phase >= PERF_PHASE_COUNT) {
+        return;
+    }
+
+    // Unsigned arithmetic handles the wrap of the tick counter
+    uint32_t const duration = PERF_GET_TICKS() - start;
+    perf_counter_t *const counter = &global.perf_counters[phase];
+
+    if ((counter->count == 0u) || (duration < counter->min)) {
+        counter->min = duration;
+    }
+    if (duration > counter->max) {
+        counter->max = duration;
+    }
+    counter->sum += duration;
+    counter->count++;
+}
+
+perf_counter_t const *perf_get(perf_phase_t phase) {
+    if (phase >= PERF_PHASE_COUNT) {
+        return NULL;
+    }
+    return &global.perf_counters[phase];
+}
+
+void perf_record_ins(uint8_t ins, uint32_t start) {
+    if (ins >= PERF_HISTOGRAM_NB_INS) {
+        return;
+    }
+
+    uint32_t duration = (PERF_GET_TICKS() - start) >> PERF_HISTOGRAM_SHIFT;
+    uint8_t bucket = 0;
+
+    // Log-scale: the bucket is the bit length of the duration
+    while ((duration != 0u) && (bucket < (PERF_HISTOGRAM_NB_BUCKETS - 1u))) {
+        duration >>= 1u;
+        bucket++;
+    }
+
+    uint16_t *const count = &global.perf_histograms[ins][bucket];
+    if (*count < UINT16_MAX) {
+        (*count)++;
+    }
+}
+
+uint16_t const *perf_get_histogram(uint8_t ins) {
+    if (ins >= PERF_HISTOGRAM_NB_INS) {
+        return NULL;
+    }
+    return global.perf_histograms[ins];
+}
+
+void perf_count_signed(parsed_baking_data_t const *const data) {
+    perf_signed_t kind;
+
+    switch (data->type) {
+        case BAKING_TYPE_BLOCK:
+            kind = PERF_SIGNED_BLOCK;
+            break;
+        case BAKING_TYPE_PREATTESTATION:
+            kind = PERF_SIGNED_PREATTESTATION;
+            break;
+        case BAKING_TYPE_ATTESTATION:
+            kind = data->has_dal ? PERF_SIGNED_ATTESTATION_WITH_DAL : PERF_SIGNED_ATTESTATION;
+            break;
+        default:
+            return;
+    }
+
+    uint32_t *const count = &global.perf_signed[kind];
+    if (*count < UINT32_MAX) {
+        (*count)++;
+    }
+}
+
+uint32_t perf_get_signed(perf_signed_t kind) {
+    if (kind >= PERF_SIGNED_COUNT) {
+        return 0u;
+    }
+    return global.perf_signed[kind];
+}
+
+#endif
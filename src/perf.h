@@ -0,0 +1,230 @@
+/* Tezos Ledger application - Phase timers
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "types.h"
+
+/**
+ * @brief Phases of the signing path that can be timed
+ *
+ *        The values are the indexes of the counters in the QUERY_PERF response
+ */
+typedef enum {
+    PERF_PHASE_APDU_RECEIVE = 0,      ///< reading a received apdu, up to its dispatch
+    PERF_PHASE_PARSE_CONSENSUS = 1,   ///< parse_consensus_operation
+    PERF_PHASE_PARSE_BLOCK = 2,       ///< parse_block
+    PERF_PHASE_PARSE_OPERATIONS = 3,  ///< parse_operations of one packet
+    PERF_PHASE_HASH_UPDATE = 4,       ///< blake2b update of one packet
+    PERF_PHASE_HASH_FINAL = 5,        ///< blake2b final
+    PERF_PHASE_KEY_DERIVATION = 6,    ///< key derivation
+    PERF_PHASE_SIGN = 7,              ///< signature, including the derivation if not cached
+    PERF_PHASE_NVM_WRITE = 8,         ///< HWM write in NVRAM
+    PERF_PHASE_APDU_SEND = 9,         ///< io_send_response_pointer of a signature
+    PERF_PHASE_COUNT = 10             ///< number of phases
+} perf_phase_t;
+
+/**
+ * @brief Kinds of signed baking messages that are counted
+ *
+ *        The values are the indexes of the counts in the QUERY_PERF response
+ */
+typedef enum {
+    PERF_SIGNED_BLOCK = 0,                 ///< block
+    PERF_SIGNED_PREATTESTATION = 1,        ///< pre-attestation
+    PERF_SIGNED_ATTESTATION = 2,           ///< attestation without DAL
+    PERF_SIGNED_ATTESTATION_WITH_DAL = 3,  ///< attestation with DAL
+    PERF_SIGNED_COUNT = 4                  ///< number of kinds
+} perf_signed_t;
+
+#ifdef HAVE_PERF_COUNTERS
+
+/**
+ * @brief Tick source of the phase timers
+ *
+ *        `PERF_GET_TICKS()` must read a cycle counter or a hardware
+ *        timer. It is defined by the header given at build time with
+ *        `PERF_TICKS_HEADER`. The millisecond counter of the IO layer
+ *        cannot be used: it only moves on ticker events, never while
+ *        the app computes.
+ */
+#ifdef PERF_TICKS_HEADER
+#include PERF_TICKS_HEADER
+#endif
+#ifndef PERF_GET_TICKS
+#error "HAVE_PERF_COUNTERS needs a cycle or timer tick source: define PERF_GET_TICKS()"
+#endif
+
+/**
+ * @brief Scale of the latency histograms, in powers of 2 of ticks
+ *
+ *        Can be set by the ticks header so that the buckets cover the
+ *        latencies of the instructions at its tick rate.
+ */
+#ifndef PERF_HISTOGRAM_SHIFT
+#define PERF_HISTOGRAM_SHIFT 0u
+#endif
+
+/**
+ * @brief Counters of a phase
+ *
+ */
+typedef struct {
+    uint32_t min;    ///< shortest duration, in ticks
+    uint32_t max;    ///< longest duration, in ticks
+    uint32_t sum;    ///< sum of the durations, in ticks
+    uint32_t count;  ///< number of measures
+} perf_counter_t;
+
+/// Instruction codes below this one have a latency histogram
+#define PERF_HISTOGRAM_NB_INS 0x18u
+
+/**
+ * @brief Number of buckets of a latency histogram
+ *
+ *        With s = PERF_HISTOGRAM_SHIFT, bucket 0 counts the durations
+ *        below 2^s ticks, bucket i the durations in [2^(s+i-1), 2^(s+i))
+ *        ticks and the last bucket all the longer ones.
+ */
+#define PERF_HISTOGRAM_NB_BUCKETS 12u
+
+/**
+ * @brief Resets the counters of all phases, the latency histograms and
+ *        the counts of signed baking messages
+ *
+ */
+void perf_reset(void);
+
+/**
+ * @brief Records a measure of a phase
+ *
+ * @param phase: measured phase
+ * @param start: ticks at the beginning of the phase
+ */
+void perf_record(perf_phase_t phase, uint32_t start);
+
+/**
+ * @brief Gets the counters of a phase
+ *
+ * @param phase: phase
+ * @return perf_counter_t const*: counters, NULL if the phase is invalid
+ */
+perf_counter_t const *perf_get(perf_phase_t phase);
+
+/**
+ * @brief Records the latency of an instruction in its histogram
+ *
+ *        Bucket counts saturate instead of wrapping. The latency stops
+ *        when the handler returns, before any user prompt is answered.
+ *
+ * @param ins: instruction code
+ * @param start: ticks at the reception of the instruction
+ */
+void perf_record_ins(uint8_t ins, uint32_t start);
+
+/**
+ * @brief Gets the latency histogram of an instruction
+ *
+ * @param ins: instruction code
+ * @return uint16_t const*: PERF_HISTOGRAM_NB_BUCKETS bucket counts,
+ *         NULL if the instruction has no histogram
+ */
+uint16_t const *perf_get_histogram(uint8_t ins);
+
+/**
+ * @brief Counts a signed baking message
+ *
+ *        Counts saturate instead of wrapping
+ *
+ * @param data: parsed baking message that has been signed
+ */
+void perf_count_signed(parsed_baking_data_t const *const data);
+
+/**
+ * @brief Gets the count of signed baking messages of a kind
+ *
+ * @param kind: kind of baking message
+ * @return uint32_t: number of messages signed, 0 if the kind is invalid
+ */
+uint32_t perf_get_signed(perf_signed_t kind);
+
+/**
+ * @brief Measures the duration of a statement
+ *
+ *        The measure is not recorded if the statement jumps out,
+ *        e.g. on error
+ */
+#define PERF_MEASURE(phase, statement)                 \
+    do {                                               \
+        uint32_t const perf_start_ = PERF_GET_TICKS(); \
+        statement;                                     \
+        perf_record(phase, perf_start_);               \
+    } while (0)
+
+/**
+ * @brief Declares a timestamp to measure a phase from
+ *
+ */
+#define PERF_TIMESTAMP(name) uint32_t const name = PERF_GET_TICKS()
+
+/**
+ * @brief Records a phase measured from a timestamp
+ *
+ */
+#define PERF_RECORD(phase, start) perf_record(phase, start)
+
+/**
+ * @brief Measures the latency of an instruction, from a timestamp
+ *
+ */
+#define PERF_MEASURE_INS(ins, start, statement) \
+    do {                                        \
+        statement;                              \
+        perf_record_ins(ins, start);            \
+    } while (0)
+
+/**
+ * @brief Counts a signed baking message
+ *
+ */
+#define PERF_COUNT_SIGNED(data) perf_count_signed(data)
+
+#else
+
+#define PERF_MEASURE(phase, statement) \
+    do {                               \
+        statement;                     \
+    } while (0)
+
+#define PERF_TIMESTAMP(name)
+
+#define PERF_RECORD(phase, start)
+
+#define PERF_MEASURE_INS(ins, start, statement) \
+    do {                                        \
+        statement;                              \
+    } while (0)
+
+#define PERF_COUNT_SIGNED(data) \
+    do {                        \
+        (void) (data);          \
+    } while (0)
+
+#endif
@@ -31,11 +31,6 @@
 
 #define TEZOS_HASH_CHECKSUM_SIZE 4u
 
-static int pkh_to_string(char *const dest,
-                         size_t const dest_size,
-                         signature_type_t const signature_type,
-                         uint8_t const hash[KEY_HASH_SIZE]);
-
 tz_exc bip32_path_with_curve_to_pkh_string(char *const out,
                                            size_t const out_size,
                                            bip32_path_with_curve_t const *const key) {
@@ -46,6 +41,14 @@ tz_exc bip32_path_with_curve_to_pkh_string(char *const out,
     TZ_ASSERT_NOT_NULL(out);
     TZ_ASSERT_NOT_NULL(key);
 
+    if (is_authorized_key_cached(key)) {
+        TZ_ASSERT(out_size >= sizeof(N_authorized_key_cache.pkh_string), EXC_WRONG_LENGTH);
+        memmove(out,
+                (void const *) N_authorized_key_cache.pkh_string,
+                sizeof(N_authorized_key_cache.pkh_string));
+        goto end;
+    }
+
     CX_CHECK(generate_public_key_hash(hash, sizeof(hash), NULL, key));
 
     TZ_ASSERT(pkh_to_string(out,
@@ -59,6 +62,28 @@ end:
     return exc;
 }
 
+tz_exc public_key_to_pkh_string(char *const out,
+                                size_t const out_size,
+                                parsed_public_key_t const *const key) {
+    tz_exc exc = SW_OK;
+    cx_err_t error = CX_OK;
+    uint8_t hash[KEY_HASH_SIZE];
+
+    TZ_ASSERT_NOT_NULL(out);
+    TZ_ASSERT_NOT_NULL(key);
+
+    size_t const key_len = signature_type_to_public_key_len(key->signature_type);
+    TZ_ASSERT(key_len != 0u, EXC_WRONG_VALUES);
+
+    CX_CHECK(compressed_public_key_hash(hash, sizeof(hash), key->W, key_len));
+
+    TZ_ASSERT(pkh_to_string(out, out_size, key->signature_type, hash) >= 0, EXC_WRONG_LENGTH);
+
+end:
+    TZ_CONVERT_CX();
+    return exc;
+}
+
 /**
  * @brief Computes the ckecsum of a hash
  *
@@ -75,19 +100,10 @@ static void compute_hash_checksum(uint8_t out[TEZOS_HASH_CHECKSUM_SIZE],
     memcpy(out, checksum, TEZOS_HASH_CHECKSUM_SIZE);
 }
 
-/**
- * @brief Converts a public key hash to string
- *
- * @param dest: result output
- * @param dest_size: output size
- * @param signature_type: curve of the key
- * @param hash: public key hash
- * @return int: size of the result, negative integer on failure
- */
-static int pkh_to_string(char *const dest,
-                         size_t const dest_size,
-                         signature_type_t const signature_type,
-                         uint8_t const hash[KEY_HASH_SIZE]) {
+int pkh_to_string(char *const dest,
+                  size_t const dest_size,
+                  signature_type_t const signature_type,
+                  uint8_t const hash[KEY_HASH_SIZE]) {
     if ((dest == NULL) || (hash == NULL)) {
         return -1;
     }
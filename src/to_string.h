@@ -44,6 +44,32 @@ tz_exc bip32_path_with_curve_to_pkh_string(char *const out,
                                            size_t const out_size,
                                            bip32_path_with_curve_t const *const key);
 
+/**
+ * @brief Converts a public key to its public key hash string
+ *
+ * @param out: result output
+ * @param out_size: output size
+ * @param key: public key
+ * @return tz_exc: exception, SW_OK if none
+ */
+tz_exc public_key_to_pkh_string(char *const out,
+                                size_t const out_size,
+                                parsed_public_key_t const *const key);
+
+/**
+ * @brief Converts a public key hash to string
+ *
+ * @param dest: result output
+ * @param dest_size: output size
+ * @param signature_type: curve of the key
+ * @param hash: public key hash
+ * @return int: size of the result, negative integer on failure
+ */
+int pkh_to_string(char *const dest,
+                  size_t const dest_size,
+                  signature_type_t const signature_type,
+                  uint8_t const hash[KEY_HASH_SIZE]);
+
 /**
  * @brief Converts a chain id to string
  *
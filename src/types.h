@@ -52,6 +52,16 @@ typedef enum {
     MAGIC_BYTE_ATTESTATION = 0x13u,     /// magic byte of an attestation
 } magic_byte_t;
 
+/**
+ * @brief tag of consensus operations
+ * See: https://tezos.gitlab.io/shell/p2p_api.html
+ */
+typedef enum {
+    CONSENSUS_TAG_PREATTESTATION = 20u,        /// tag of a pre-attestation
+    CONSENSUS_TAG_ATTESTATION = 21u,           /// tag of an attestation
+    CONSENSUS_TAG_ATTESTATION_WITH_DAL = 23u,  /// tag of an attestation with DAL
+} consensus_tag_t;
+
 typedef uint32_t level_t;
 typedef uint32_t round_t;
 
@@ -88,6 +98,63 @@ typedef struct {
     bool had_preattestation;  ///< if a pre-attestation has been seen at current level/round
 } high_watermark_t;
 
+#ifdef TARGET_NANOS
+#define HWM_CHAINS_SIZE 2u  /// Number of test chains having their own HWM
+#else
+#define HWM_CHAINS_SIZE 4u  /// Number of test chains having their own HWM
+#endif
+
+/**
+ * @brief This structure represents the High Watermark of a test chain
+ *
+ */
+typedef struct {
+    chain_id_t chain_id;   ///< chain id
+    high_watermark_t hwm;  ///< HWM of the chain
+} chain_hwm_t;
+
+/**
+ * @brief This structure represents the high watermarks of the chains
+ *
+ *        Each test chain has its own HWM, in a table sorted by chain
+ *        id. A test chain enters the table on its first signature,
+ *        with the `test` HWM. Once the table is full, the signatures
+ *        on the other test chains are refused.
+ */
+typedef struct {
+    high_watermark_t main;                ///< HWM of main
+    high_watermark_t test;                ///< initial HWM of the test chains
+    uint8_t nb_chains;                    ///< number of test chains in the table
+    uint8_t last_chain;                   ///< index of the test chain signed last
+    chain_hwm_t chains[HWM_CHAINS_SIZE];  ///< HWM of the test chains, sorted by chain id
+} high_watermarks_t;
+
+#ifdef TARGET_NANOS
+#define MAX_BAKING_KEYS 2u  /// Number of keys that can be authorized at once
+#else
+#define MAX_BAKING_KEYS 4u  /// Number of keys that can be authorized at once
+#endif
+
+/**
+ * @brief This structure represents an authorized key and its high watermarks
+ *
+ */
+typedef struct {
+    bip32_path_with_curve_t key;  ///< authorized key, empty path if none
+    high_watermarks_t hwm;        ///< high watermarks of the key
+} baking_key_t;
+
+/**
+ * @brief This structure represents the companion key registered by the user
+ *
+ *        The registration only holds while its consensus key is the
+ *        first authorized key.
+ */
+typedef struct {
+    bip32_path_with_curve_t consensus_key;  ///< first authorized key at the registration
+    bip32_path_with_curve_t companion_key;  ///< companion key, empty path if none
+} companion_key_t;
+
 /**
  * @brief This structure represents data store in NVRAM
  *
@@ -95,16 +162,17 @@ typedef struct {
 typedef struct {
     chain_id_t main_chain_id;  ///< main chain id
 
-    /// high watermarks information
-    struct {
-        high_watermark_t main;  ///< HWM of main
-        high_watermark_t test;  ///< HWM of test
-    } hwm;
+    /// authorized keys, the first one is the one set by `SETUP` and `AUTHORIZE_BAKING`
+    baking_key_t baking_keys[MAX_BAKING_KEYS];
+
+    companion_key_t companion;  ///< companion key of the first authorized key
 
-    bip32_path_with_curve_t baking_key;  ///< authorized key
-    bool hwm_disabled;                   /**< Set HWM setting on/off,
-                                              e.g. if you are using signer assisted HWM,
-                                              no need to track HWM using Ledger.*/
+    /// sequence number of the last HWM journal record included in this copy
+    uint32_t hwm_journal_base;
+
+    bool hwm_disabled; /**< Set HWM setting on/off,
+                            e.g. if you are using signer assisted HWM,
+                            no need to track HWM using Ledger.*/
 } baking_data;
 
 #define SIGN_HASH_SIZE 32u
@@ -119,11 +187,14 @@ typedef struct {
  *
  */
 typedef struct {
-    chain_id_t chain_id;  ///< chain id
-    baking_type_t type;   ///< kind of the baking message
-    level_t level;        ///< level of the  baking message
-    round_t round;        ///< round of the  baking message
-    bool is_tenderbake;   ///< if belongs to the tenderbake consensus protocol
+    chain_id_t chain_id;       ///< chain id
+    baking_type_t type;        ///< kind of the baking message
+    level_t level;             ///< level of the  baking message
+    round_t round;             ///< round of the  baking message
+    bool is_tenderbake;        ///< if belongs to the tenderbake consensus protocol
+    uint16_t slot;             ///< first slot of the baker, for consensus operations
+    bool has_dal;              ///< if the attestation carries a DAL bitset
+    uint64_t dal_attestation;  ///< DAL bitset of the attestation
 } parsed_baking_data_t;
 
 /**
@@ -145,9 +216,34 @@ typedef struct parsed_contract {
 enum operation_tag {
     OPERATION_TAG_NONE = -1,  // Sentinal value, as 0 is possibly used for something
     OPERATION_TAG_REVEAL = 107,
+    OPERATION_TAG_TRANSACTION = 108,
     OPERATION_TAG_DELEGATION = 110,
+    OPERATION_TAG_UPDATE_CONSENSUS_KEY = 114,
 };
 
+/**
+ * @brief Entrypoints of the staking operations
+ *
+ *        Staking operations are transactions from a key to itself
+ *        calling one of these entrypoints.
+ *        See: https://tezos.gitlab.io/active/staking.html
+ */
+typedef enum {
+    STAKING_ENTRYPOINT_STAKE = 6u,                    /// stake some tez
+    STAKING_ENTRYPOINT_UNSTAKE = 7u,                  /// request to unstake some tez
+    STAKING_ENTRYPOINT_FINALIZE_UNSTAKE = 8u,         /// finalize the unstake requests
+    STAKING_ENTRYPOINT_SET_DELEGATE_PARAMETERS = 9u,  /// set the staking parameters
+} staking_entrypoint_t;
+
+/**
+ * @brief This structure represents a parsed public key
+ *
+ */
+typedef struct {
+    signature_type_t signature_type;   ///< type of the key
+    uint8_t W[MAX_COMPRESSED_PK_LEN];  ///< compressed public key
+} parsed_public_key_t;
+
 /**
  * @brief This structure represents information about parsed operation
  *
@@ -156,6 +252,11 @@ struct parsed_operation {
     enum operation_tag tag;              ///< operation tag
     struct parsed_contract source;       ///< source of the operation
     struct parsed_contract destination;  ///< destination of the operation
+    uint64_t amount;                     ///< amount of a staking operation, in mutez
+    staking_entrypoint_t entrypoint;     ///< entrypoint of a staking operation
+    uint64_t staking_limit;              ///< limit of staking over baking, in millionth
+    uint64_t staking_edge;               ///< edge of baking over staking, in billionth
+    parsed_public_key_t consensus_key;   ///< new consensus key
 };
 
 /**
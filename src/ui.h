@@ -40,46 +40,53 @@ void ui_initial_screen(void);
  */
 void __attribute__((noreturn)) app_exit(void);
 
-#ifdef HAVE_BAGL
-
-#ifdef TARGET_NANOS
 /**
- * @brief Sets low-cost display mode
- *
- *       Low-cost display stop handling `TICKER_EVENT`
+ * @brief Values displayed on the idle screens
  *
- * @param enable: if enable the mode or not
+ *        They are rebuilt lazily: a change only marks them as stale.
  */
-void ux_set_low_cost_display_mode(bool enable);
-#endif  // HAVE_BAGL
+#define IDLE_SCREEN_CHAIN_ID       0x01u  /// Main chain id
+#define IDLE_SCREEN_AUTHORIZED_KEY 0x02u  /// Public key hash of the authorized key
+#define IDLE_SCREEN_HWM            0x04u  /// Main HWM
+#define IDLE_SCREEN_ALL            0x07u  /// All values
 
 /**
- * @brief Calculates the chain id for the idle screens
+ * @brief Marks values of the idle screens as stale
  *
- * @return tz_exc: exception, SW_OK if none
+ *        Cheap enough to be called on the signing path: the values are
+ *        only rebuilt when displayed or when the device is idle.
+ *
+ * @param values: bitmask of `IDLE_SCREEN_*` values
  */
-tz_exc calculate_idle_screen_chain_id(void);
+void invalidate_idle_screen_values(uint8_t values);
 
 /**
- * @brief Calculates the authorized key for the idle screens
+ * @brief Rebuilds the stale values of the idle screens
  *
  * @return tz_exc: exception, SW_OK if none
  */
-tz_exc calculate_idle_screen_authorized_key(void);
+tz_exc build_idle_screen_values(void);
 
 /**
- * @brief Calculates the HWM for the idle screens
+ * @brief Wipes the cached keys if the device has been locked
  *
- * @return tz_exc: exception, SW_OK if none
+ *        Called on every ticker event, so that they do not stay in RAM
+ *        until the next apdu.
  */
-tz_exc calculate_idle_screen_hwm(void);
+void clear_key_caches_if_locked(void);
+
+#ifdef HAVE_BAGL
 
+#ifdef TARGET_NANOS
 /**
- * @brief Calculates baking values for the idle screens
+ * @brief Sets low-cost display mode
  *
- * @return tz_exc: exception, SW_OK if none
+ *       Low-cost display stop handling `TICKER_EVENT`
+ *
+ * @param enable: if enable the mode or not
  */
-tz_exc calculate_baking_idle_screens_data(void);
+void ux_set_low_cost_display_mode(bool enable);
+#endif  // HAVE_BAGL
 
 /**
  * @brief Prepare confirmation screens callbacks
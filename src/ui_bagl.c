@@ -100,6 +100,7 @@ uint8_t io_event(uint8_t channel) {
                 app_ticker_event_callback();
                 UX_TICKER_EVENT(G_io_seproxyhal_spi_buffer, {});
             } else {
+                clear_key_caches_if_locked();
                 ux_screensaver_apply_tick();
             }
             break;
@@ -196,7 +197,12 @@ void ui_toggle_hwm(void) {
     ui_settings();
 }
 
-tz_exc calculate_idle_screen_chain_id(void) {
+/**
+ * @brief Calculates the chain id for the idle screens
+ *
+ * @return tz_exc: exception, SW_OK if none
+ */
+static tz_exc calculate_idle_screen_chain_id(void) {
     tz_exc exc = SW_OK;
 
     memset(&home_context.chain_id, 0, sizeof(home_context.chain_id));
@@ -210,12 +216,17 @@ end:
     return exc;
 }
 
-tz_exc calculate_idle_screen_authorized_key(void) {
+/**
+ * @brief Calculates the authorized key for the idle screens
+ *
+ * @return tz_exc: exception, SW_OK if none
+ */
+static tz_exc calculate_idle_screen_authorized_key(void) {
     tz_exc exc = SW_OK;
 
     memset(&home_context.authorized_key, 0, sizeof(home_context.authorized_key));
 
-    if (g_hwm.baking_key.bip32_path.length == 0u) {
+    if (g_baking_key.key.bip32_path.length == 0u) {
         TZ_ASSERT(copy_string(home_context.authorized_key,
                               sizeof(home_context.authorized_key),
                               "No Key Authorized"),
@@ -223,33 +234,48 @@ tz_exc calculate_idle_screen_authorized_key(void) {
     } else {
         TZ_CHECK(bip32_path_with_curve_to_pkh_string(home_context.authorized_key,
                                                      sizeof(home_context.authorized_key),
-                                                     &g_hwm.baking_key));
+                                                     &g_baking_key.key));
     }
 
 end:
     return exc;
 }
 
-tz_exc calculate_idle_screen_hwm(void) {
+/**
+ * @brief Calculates the HWM for the idle screens
+ *
+ * @return tz_exc: exception, SW_OK if none
+ */
+static tz_exc calculate_idle_screen_hwm(void) {
     tz_exc exc = SW_OK;
 
     memset(&home_context.hwm, 0, sizeof(home_context.hwm));
 
-    TZ_ASSERT(hwm_to_string(home_context.hwm, sizeof(home_context.hwm), &g_hwm.hwm.main) >= 0,
-              EXC_WRONG_LENGTH);
+    TZ_ASSERT(
+        hwm_to_string(home_context.hwm, sizeof(home_context.hwm), &g_baking_key.hwm.main) >= 0,
+        EXC_WRONG_LENGTH);
 
 end:
     return exc;
 }
 
-tz_exc calculate_baking_idle_screens_data(void) {
+tz_exc build_idle_screen_values(void) {
     tz_exc exc = SW_OK;
 
-    TZ_CHECK(calculate_idle_screen_chain_id());
+    if ((G_display.built_idle_screen_values & IDLE_SCREEN_CHAIN_ID) == 0u) {
+        TZ_CHECK(calculate_idle_screen_chain_id());
+        G_display.built_idle_screen_values |= IDLE_SCREEN_CHAIN_ID;
+    }
 
-    TZ_CHECK(calculate_idle_screen_authorized_key());
+    if ((G_display.built_idle_screen_values & IDLE_SCREEN_AUTHORIZED_KEY) == 0u) {
+        TZ_CHECK(calculate_idle_screen_authorized_key());
+        G_display.built_idle_screen_values |= IDLE_SCREEN_AUTHORIZED_KEY;
+    }
 
-    TZ_CHECK(calculate_idle_screen_hwm());
+    if ((G_display.built_idle_screen_values & IDLE_SCREEN_HWM) == 0u) {
+        TZ_CHECK(calculate_idle_screen_hwm());
+        G_display.built_idle_screen_values |= IDLE_SCREEN_HWM;
+    }
 
 end:
     return exc;
@@ -263,7 +289,7 @@ void ui_initial_screen(void) {
         ux_stack_push();
     }
 
-    TZ_CHECK(calculate_baking_idle_screens_data());
+    TZ_CHECK(build_idle_screen_values());
 
     ui_menu_init();
     return;
@@ -278,6 +304,8 @@ end:
  *
  */
 static void ui_refresh_idle_hwm_screen(void) {
+    // Ignore calculation errors
+    (void) build_idle_screen_values();
     ux_flow_init(0, ux_idle_flow, &ux_hwm_step);
 }
 
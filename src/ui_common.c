@@ -20,6 +20,8 @@
 */
 
 #include "ui.h"
+#include "apdu_hmac.h"
+#include "io.h"
 #include "os_pin.h"
 
 #include <globals.h>
@@ -32,8 +34,37 @@ static void require_pin(void) {
     os_global_pin_invalidate();
 }
 
+void invalidate_idle_screen_values(uint8_t values) {
+    global.dynamic_display.built_idle_screen_values &= ~values;
+}
+
+void clear_key_caches_if_locked(void) {
+    if (os_global_pin_is_validated() != BOLOS_UX_OK) {
+        // The device has been locked: wipe the derived keys
+        clear_derived_key_cache();
+        clear_hmac_key_cache();
+    }
+}
+
+/**
+ * @brief Called on every ticker event, while the device is idle
+ *
+ *        Wipes the cached keys as soon as the device is locked, and
+ *        rebuilds the idle screen values left stale by the last requests.
+ *
+ */
+void app_ticker_event_callback(void) {
+    clear_key_caches_if_locked();
+    if (global.dynamic_display.built_idle_screen_values != IDLE_SCREEN_ALL) {
+        // Ignore calculation errors: the values are rebuilt on their next display
+        (void) build_idle_screen_values();
+    }
+}
+
 void __attribute__((noreturn)) app_exit(void) {
-    UPDATE_NVRAM
+    UPDATE_NVRAM;
+    clear_derived_key_cache();
+    clear_hmac_key_cache();
     require_pin();
     os_sched_exit(-1);
 }
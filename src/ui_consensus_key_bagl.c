@@ -0,0 +1,90 @@
+/* Tezos Ledger application - Consensus key update BAGL UI handling
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#ifdef HAVE_BAGL
+#include "apdu_sign.h"
+#include "ui_consensus_key.h"
+
+#include "apdu.h"
+#include "globals.h"
+#include "keys.h"
+#include "memory.h"
+#include "to_string.h"
+#include "ui.h"
+
+#include <string.h>
+
+#define G global.apdu.u.sign
+
+/**
+ * @brief This structure represents a context needed for consensus key update screens navigation
+ *
+ */
+typedef struct {
+    char address[PKH_STRING_SIZE];
+    char consensus_key[PKH_STRING_SIZE];
+    char fee[MAX_INT_DIGITS + sizeof(TICKER_WITH_SPACE) + 1u];
+} ConsensusKeyContext_t;
+
+/// Current consensus key update context
+static ConsensusKeyContext_t consensus_key_context;
+
+UX_STEP_NOCB(ux_update_consensus_key_step, bnnn_paging, {"Update", "consensus key?"});
+UX_STEP_NOCB(ux_consensus_key_address_step,
+             bnnn_paging,
+             {"Address", consensus_key_context.address});
+UX_STEP_NOCB(ux_consensus_key_step,
+             bnnn_paging,
+             {"Consensus key", consensus_key_context.consensus_key});
+UX_STEP_NOCB(ux_consensus_key_fee_step, bnnn_paging, {"Fee", consensus_key_context.fee});
+
+UX_CONFIRM_FLOW(ux_consensus_key_flow,
+                &ux_update_consensus_key_step,
+                &ux_consensus_key_address_step,
+                &ux_consensus_key_step,
+                &ux_consensus_key_fee_step);
+
+int prompt_update_consensus_key(ui_callback_t const ok_cb, ui_callback_t const cxl_cb) {
+    tz_exc exc = SW_OK;
+
+    TZ_ASSERT(G.maybe_ops.is_valid, EXC_MEMORY_ERROR);
+
+    memset(&consensus_key_context, 0, sizeof(consensus_key_context));
+
+    TZ_CHECK(bip32_path_with_curve_to_pkh_string(consensus_key_context.address,
+                                                 sizeof(consensus_key_context.address),
+                                                 &global.path_with_curve));
+
+    TZ_CHECK(public_key_to_pkh_string(consensus_key_context.consensus_key,
+                                      sizeof(consensus_key_context.consensus_key),
+                                      &G.maybe_ops.v.operation.consensus_key));
+
+    TZ_ASSERT(microtez_to_string(consensus_key_context.fee,
+                                 sizeof(consensus_key_context.fee),
+                                 G.maybe_ops.v.total_fee) >= 0,
+              EXC_WRONG_LENGTH);
+
+    ux_prepare_confirm_callbacks(ok_cb, cxl_cb);
+    ux_flow_init(0, ux_consensus_key_flow, NULL);
+    return 0;
+
+end:
+    return io_send_apdu_err(exc);
+}
+
+#endif  // HAVE_BAGL
@@ -0,0 +1,126 @@
+/* Tezos Ledger application - Consensus key update NBGL UI handling
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#ifdef HAVE_NBGL
+#include "nbgl_use_case.h"
+#include "apdu_sign.h"
+#include "ui_consensus_key.h"
+
+#include "apdu.h"
+#include "globals.h"
+#include "keys.h"
+#include "memory.h"
+#include "to_string.h"
+#include "ui.h"
+
+#include <string.h>
+
+#define G global.apdu.u.sign
+
+#define MAX_LENGTH 100
+
+/**
+ * @brief Index of values for the consensus key update flow
+ */
+typedef enum {
+    ADDRESS_IDX = 0,
+    CONSENSUS_KEY_IDX,
+    FEE_IDX,
+    CONSENSUS_KEY_TAG_VALUE_NB
+} ConsensusKeyTagValueIndex_t;
+
+/**
+ * @brief This structure represents a context needed for consensus key update screens navigation
+ *
+ */
+typedef struct {
+    ui_callback_t ok_cb;   /// accept callback
+    ui_callback_t cxl_cb;  /// cancel callback
+    nbgl_layoutTagValue_t tagValuePair[CONSENSUS_KEY_TAG_VALUE_NB];
+    nbgl_layoutTagValueList_t tagValueList;
+    char tagValueRef[CONSENSUS_KEY_TAG_VALUE_NB][MAX_LENGTH];
+} ConsensusKeyContext_t;
+
+/// Current consensus key update context
+static ConsensusKeyContext_t consensus_key_context;
+
+/**
+ * @brief Callback called when the consensus key update is accepted or cancelled
+ *
+ * @param confirm: true if accepted, false if cancelled
+ */
+static void confirmation_callback(bool confirm) {
+    if (confirm) {
+        nbgl_useCaseStatus("Consensus key update\nconfirmed", true, ui_initial_screen);
+        consensus_key_context.ok_cb();
+    } else {
+        nbgl_useCaseStatus("Consensus key update\ncancelled", false, ui_initial_screen);
+        consensus_key_context.cxl_cb();
+    }
+}
+
+int prompt_update_consensus_key(ui_callback_t const ok_cb, ui_callback_t const cxl_cb) {
+    tz_exc exc = SW_OK;
+
+    TZ_ASSERT(G.maybe_ops.is_valid, EXC_MEMORY_ERROR);
+
+    consensus_key_context.ok_cb = ok_cb;
+    consensus_key_context.cxl_cb = cxl_cb;
+
+    TZ_CHECK(bip32_path_with_curve_to_pkh_string(consensus_key_context.tagValueRef[ADDRESS_IDX],
+                                                 MAX_LENGTH,
+                                                 &global.path_with_curve));
+
+    TZ_CHECK(public_key_to_pkh_string(consensus_key_context.tagValueRef[CONSENSUS_KEY_IDX],
+                                      MAX_LENGTH,
+                                      &G.maybe_ops.v.operation.consensus_key));
+
+    TZ_ASSERT(microtez_to_string(consensus_key_context.tagValueRef[FEE_IDX],
+                                 MAX_LENGTH,
+                                 G.maybe_ops.v.total_fee) >= 0,
+              EXC_WRONG_LENGTH);
+
+    consensus_key_context.tagValuePair[ADDRESS_IDX].item = "Address";
+    consensus_key_context.tagValuePair[ADDRESS_IDX].value =
+        consensus_key_context.tagValueRef[ADDRESS_IDX];
+
+    consensus_key_context.tagValuePair[CONSENSUS_KEY_IDX].item = "Consensus key";
+    consensus_key_context.tagValuePair[CONSENSUS_KEY_IDX].value =
+        consensus_key_context.tagValueRef[CONSENSUS_KEY_IDX];
+
+    consensus_key_context.tagValuePair[FEE_IDX].item = "Fee";
+    consensus_key_context.tagValuePair[FEE_IDX].value =
+        consensus_key_context.tagValueRef[FEE_IDX];
+
+    consensus_key_context.tagValueList.nbPairs = CONSENSUS_KEY_TAG_VALUE_NB;
+    consensus_key_context.tagValueList.pairs = consensus_key_context.tagValuePair;
+
+    nbgl_useCaseReviewLight(TYPE_OPERATION,
+                            &consensus_key_context.tagValueList,
+                            &C_tezos,
+                            "Update consensus key",
+                            NULL,
+                            "Confirm consensus key update",
+                            confirmation_callback);
+    return 0;
+
+end:
+    return io_send_apdu_err(exc);
+}
+
+#endif  // HAVE_NBGL
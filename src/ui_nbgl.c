@@ -63,8 +63,46 @@ static const nbgl_contentInfoList_t infoList = {.nbInfos = INFO_NB,
                                                 .infoTypes = infoTypes,
                                                 .infoContents = infoContents};
 
+tz_exc build_idle_screen_values(void) {
+    tz_exc exc = SW_OK;
+
+    uint8_t* const built_values = &global.dynamic_display.built_idle_screen_values;
+
+    if ((*built_values & IDLE_SCREEN_CHAIN_ID) == 0u) {
+        TZ_ASSERT(chain_id_to_string_with_aliases(infoContentsBridge[CHAIN_IDX],
+                                                  MAX_LENGTH,
+                                                  &g_hwm.main_chain_id) >= 0,
+                  EXC_WRONG_LENGTH);
+        *built_values |= IDLE_SCREEN_CHAIN_ID;
+    }
+
+    if ((*built_values & IDLE_SCREEN_AUTHORIZED_KEY) == 0u) {
+        if (g_baking_key.key.bip32_path.length == 0u) {
+            TZ_ASSERT(copy_string(infoContentsBridge[PKH_IDX], MAX_LENGTH, "No Key Authorized"),
+                      EXC_WRONG_LENGTH);
+        } else {
+            TZ_CHECK(bip32_path_with_curve_to_pkh_string(infoContentsBridge[PKH_IDX],
+                                                         MAX_LENGTH,
+                                                         &g_baking_key.key));
+        }
+        *built_values |= IDLE_SCREEN_AUTHORIZED_KEY;
+    }
+
+    if ((*built_values & IDLE_SCREEN_HWM) == 0u) {
+        TZ_ASSERT(
+            hwm_to_string(infoContentsBridge[HWM_IDX], MAX_LENGTH, &g_baking_key.hwm.main) >= 0,
+            EXC_WRONG_LENGTH);
+        *built_values |= IDLE_SCREEN_HWM;
+    }
+
+end:
+    return exc;
+}
+
 /**
  * @brief Initializes info values
+ *
+ *        Only the stale chain id, authorized key and HWM are rebuilt
  */
 static void initInfo(void) {
     tz_exc exc = SW_OK;
@@ -73,22 +111,7 @@ static void initInfo(void) {
         infoContents[idx] = infoContentsBridge[idx];
     }
 
-    TZ_ASSERT(chain_id_to_string_with_aliases(infoContentsBridge[CHAIN_IDX],
-                                              MAX_LENGTH,
-                                              &g_hwm.main_chain_id) >= 0,
-              EXC_WRONG_LENGTH);
-
-    if (g_hwm.baking_key.bip32_path.length == 0u) {
-        TZ_ASSERT(copy_string(infoContentsBridge[PKH_IDX], MAX_LENGTH, "No Key Authorized"),
-                  EXC_WRONG_LENGTH);
-    } else {
-        TZ_CHECK(bip32_path_with_curve_to_pkh_string(infoContentsBridge[PKH_IDX],
-                                                     MAX_LENGTH,
-                                                     &g_hwm.baking_key));
-    }
-
-    TZ_ASSERT(hwm_to_string(infoContentsBridge[HWM_IDX], MAX_LENGTH, &g_hwm.hwm.main) >= 0,
-              EXC_WRONG_LENGTH);
+    TZ_CHECK(build_idle_screen_values());
 
     TZ_ASSERT(copy_string(infoContentsBridge[VERSION_IDX], MAX_LENGTH, APPVERSION) >= 0,
               EXC_WRONG_LENGTH);
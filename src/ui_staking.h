@@ -0,0 +1,59 @@
+/* Tezos Ledger application - Staking UI handling
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+#pragma once
+
+#include "types.h"
+
+/**
+ * @brief Get the name of a staking operation
+ *
+ * @param entrypoint: entrypoint of the staking operation
+ * @return char const*: name of the operation, NULL if the entrypoint is unknown
+ */
+static inline char const *staking_entrypoint_to_string(staking_entrypoint_t const entrypoint) {
+    switch (entrypoint) {
+        case STAKING_ENTRYPOINT_STAKE:
+            return "Stake";
+        case STAKING_ENTRYPOINT_UNSTAKE:
+            return "Unstake";
+        case STAKING_ENTRYPOINT_FINALIZE_UNSTAKE:
+            return "Finalize unstake";
+        case STAKING_ENTRYPOINT_SET_DELEGATE_PARAMETERS:
+            return "Set delegate parameters";
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * @brief Draws staking confirmation pages flow
+ *
+ *        - Initial screen
+ *        - Values:
+ *          - Operation
+ *          - Address
+ *          - Amount, for stake and unstake
+ *          - Limit and edge, for set_delegate_parameters
+ *          - Fee
+ *        - Confirmation screens
+ *
+ * @param ok_cb: accept callback
+ * @param cxl_cb: reject callback
+ * @return int: zero or positive integer if success, negative integer otherwise.
+ */
+int prompt_staking(ui_callback_t const ok_cb, ui_callback_t const cxl_cb);
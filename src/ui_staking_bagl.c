@@ -0,0 +1,130 @@
+/* Tezos Ledger application - Staking BAGL UI handling
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#ifdef HAVE_BAGL
+#include "apdu_sign.h"
+#include "ui_staking.h"
+
+#include "apdu.h"
+#include "globals.h"
+#include "keys.h"
+#include "memory.h"
+#include "to_string.h"
+#include "ui.h"
+
+#include <string.h>
+
+#define G global.apdu.u.sign
+
+/**
+ * @brief This structure represents a context needed for staking screens navigation
+ *
+ */
+typedef struct {
+    char operation[sizeof("Set delegate parameters")];
+    char address[PKH_STRING_SIZE];
+    char amount[MAX_INT_DIGITS + sizeof(TICKER_WITH_SPACE) + 1u];
+    char limit[MAX_INT_DIGITS + 1u];
+    char edge[MAX_INT_DIGITS + 1u];
+    char fee[MAX_INT_DIGITS + sizeof(TICKER_WITH_SPACE) + 1u];
+} StakingContext_t;
+
+/// Current staking context
+static StakingContext_t staking_context;
+
+UX_STEP_NOCB(ux_staking_operation_step, bnnn_paging, {"Operation", staking_context.operation});
+UX_STEP_NOCB(ux_staking_address_step, bnnn_paging, {"Address", staking_context.address});
+UX_STEP_NOCB(ux_staking_amount_step, bnnn_paging, {"Amount", staking_context.amount});
+UX_STEP_NOCB(ux_staking_limit_step, bnnn_paging, {"Limit (millionth)", staking_context.limit});
+UX_STEP_NOCB(ux_staking_edge_step, bnnn_paging, {"Edge (billionth)", staking_context.edge});
+UX_STEP_NOCB(ux_staking_fee_step, bnnn_paging, {"Fee", staking_context.fee});
+
+UX_CONFIRM_FLOW(ux_staking_flow,
+                &ux_staking_operation_step,
+                &ux_staking_address_step,
+                &ux_staking_fee_step);
+
+UX_CONFIRM_FLOW(ux_staking_amount_flow,
+                &ux_staking_operation_step,
+                &ux_staking_address_step,
+                &ux_staking_amount_step,
+                &ux_staking_fee_step);
+
+UX_CONFIRM_FLOW(ux_staking_parameters_flow,
+                &ux_staking_operation_step,
+                &ux_staking_address_step,
+                &ux_staking_limit_step,
+                &ux_staking_edge_step,
+                &ux_staking_fee_step);
+
+int prompt_staking(ui_callback_t const ok_cb, ui_callback_t const cxl_cb) {
+    tz_exc exc = SW_OK;
+    struct parsed_operation const *const op = &G.maybe_ops.v.operation;
+    ux_flow_step_t const *const *flow = ux_staking_flow;
+    char const *operation = NULL;
+
+    TZ_ASSERT(G.maybe_ops.is_valid, EXC_MEMORY_ERROR);
+
+    operation = staking_entrypoint_to_string(op->entrypoint);
+    TZ_ASSERT(operation != NULL, EXC_PARSE_ERROR);
+
+    memset(&staking_context, 0, sizeof(staking_context));
+    strlcpy(staking_context.operation, operation, sizeof(staking_context.operation));
+
+    TZ_CHECK(bip32_path_with_curve_to_pkh_string(staking_context.address,
+                                                 sizeof(staking_context.address),
+                                                 &global.path_with_curve));
+
+    switch (op->entrypoint) {
+        case STAKING_ENTRYPOINT_STAKE:
+        case STAKING_ENTRYPOINT_UNSTAKE:
+            TZ_ASSERT(microtez_to_string(staking_context.amount,
+                                         sizeof(staking_context.amount),
+                                         op->amount) >= 0,
+                      EXC_WRONG_LENGTH);
+            flow = ux_staking_amount_flow;
+            break;
+        case STAKING_ENTRYPOINT_SET_DELEGATE_PARAMETERS:
+            TZ_ASSERT(number_to_string(staking_context.limit,
+                                       sizeof(staking_context.limit),
+                                       op->staking_limit) >= 0,
+                      EXC_WRONG_LENGTH);
+            TZ_ASSERT(number_to_string(staking_context.edge,
+                                       sizeof(staking_context.edge),
+                                       op->staking_edge) >= 0,
+                      EXC_WRONG_LENGTH);
+            flow = ux_staking_parameters_flow;
+            break;
+        default:
+            break;
+    }
+
+    TZ_ASSERT(microtez_to_string(staking_context.fee,
+                                 sizeof(staking_context.fee),
+                                 G.maybe_ops.v.total_fee) >= 0,
+              EXC_WRONG_LENGTH);
+
+    ux_prepare_confirm_callbacks(ok_cb, cxl_cb);
+    ux_flow_init(0, flow, NULL);
+    return 0;
+
+end:
+    return io_send_apdu_err(exc);
+}
+
+#endif  // HAVE_BAGL
@@ -0,0 +1,139 @@
+/* Tezos Ledger application - Staking NBGL UI handling
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#ifdef HAVE_NBGL
+#include "nbgl_use_case.h"
+#include "apdu_sign.h"
+#include "ui_staking.h"
+
+#include "apdu.h"
+#include "globals.h"
+#include "keys.h"
+#include "memory.h"
+#include "to_string.h"
+#include "ui.h"
+
+#include <string.h>
+
+#define G global.apdu.u.sign
+
+#define MAX_LENGTH 100
+
+/// Maximum number of values displayed for a staking operation
+#define STAKING_TAG_VALUE_MAX 4u
+
+/**
+ * @brief This structure represents a context needed for staking screens navigation
+ *
+ */
+typedef struct {
+    ui_callback_t ok_cb;   /// accept callback
+    ui_callback_t cxl_cb;  /// cancel callback
+    nbgl_layoutTagValue_t tagValuePair[STAKING_TAG_VALUE_MAX];
+    nbgl_layoutTagValueList_t tagValueList;
+    char tagValueRef[STAKING_TAG_VALUE_MAX][MAX_LENGTH];
+} StakingContext_t;
+
+/// Current staking context
+static StakingContext_t staking_context;
+
+/**
+ * @brief Callback called when the staking operation is accepted or cancelled
+ *
+ * @param confirm: true if accepted, false if cancelled
+ */
+static void confirmation_callback(bool confirm) {
+    if (confirm) {
+        nbgl_useCaseStatus("Staking operation\nconfirmed", true, ui_initial_screen);
+        staking_context.ok_cb();
+    } else {
+        nbgl_useCaseStatus("Staking operation\ncancelled", false, ui_initial_screen);
+        staking_context.cxl_cb();
+    }
+}
+
+/**
+ * @brief Adds a value to the staking review
+ *
+ * @param item: name of the value
+ * @return char*: buffer in which the value must be written
+ */
+static char *push_tag_value(char const *const item) {
+    uint8_t const idx = staking_context.tagValueList.nbPairs;
+    staking_context.tagValuePair[idx].item = item;
+    staking_context.tagValuePair[idx].value = staking_context.tagValueRef[idx];
+    staking_context.tagValueList.nbPairs++;
+    return staking_context.tagValueRef[idx];
+}
+
+int prompt_staking(ui_callback_t const ok_cb, ui_callback_t const cxl_cb) {
+    tz_exc exc = SW_OK;
+    struct parsed_operation const *const op = &G.maybe_ops.v.operation;
+    char const *operation = NULL;
+
+    TZ_ASSERT(G.maybe_ops.is_valid, EXC_MEMORY_ERROR);
+
+    operation = staking_entrypoint_to_string(op->entrypoint);
+    TZ_ASSERT(operation != NULL, EXC_PARSE_ERROR);
+
+    memset(&staking_context, 0, sizeof(staking_context));
+    staking_context.ok_cb = ok_cb;
+    staking_context.cxl_cb = cxl_cb;
+    staking_context.tagValueList.pairs = staking_context.tagValuePair;
+
+    TZ_CHECK(bip32_path_with_curve_to_pkh_string(push_tag_value("Address"),
+                                                 MAX_LENGTH,
+                                                 &global.path_with_curve));
+
+    switch (op->entrypoint) {
+        case STAKING_ENTRYPOINT_STAKE:
+        case STAKING_ENTRYPOINT_UNSTAKE:
+            TZ_ASSERT(microtez_to_string(push_tag_value("Amount"), MAX_LENGTH, op->amount) >= 0,
+                      EXC_WRONG_LENGTH);
+            break;
+        case STAKING_ENTRYPOINT_SET_DELEGATE_PARAMETERS:
+            TZ_ASSERT(number_to_string(push_tag_value("Limit (millionth)"),
+                                       MAX_LENGTH,
+                                       op->staking_limit) >= 0,
+                      EXC_WRONG_LENGTH);
+            TZ_ASSERT(number_to_string(push_tag_value("Edge (billionth)"),
+                                       MAX_LENGTH,
+                                       op->staking_edge) >= 0,
+                      EXC_WRONG_LENGTH);
+            break;
+        default:
+            break;
+    }
+
+    TZ_ASSERT(microtez_to_string(push_tag_value("Fee"), MAX_LENGTH, G.maybe_ops.v.total_fee) >= 0,
+              EXC_WRONG_LENGTH);
+
+    nbgl_useCaseReviewLight(TYPE_OPERATION,
+                            &staking_context.tagValueList,
+                            &C_tezos,
+                            operation,
+                            NULL,
+                            "Confirm staking operation",
+                            confirmation_callback);
+    return 0;
+
+end:
+    return io_send_apdu_err(exc);
+}
+
+#endif  // HAVE_NBGL
@@ -16,6 +16,8 @@
 """Pytest configuration file."""
 
 from functools import wraps
+from pathlib import Path
+from typing import Generator
 import pytest
 
 from ragger.backend import BackendInterface
@@ -23,6 +25,7 @@ from ragger.conftest import configuration
 from ragger.firmware import Firmware
 from ragger.navigator import Navigator
 from utils.account import SigScheme
+from utils.benchmark import Benchmark
 from utils.client import TezosClient
 from utils.navigator import TezosNavigator
 from common import DEFAULT_SEED
@@ -32,6 +35,40 @@ configuration.OPTIONAL.CUSTOM_SEED = DEFAULT_SEED
 # Pull all features from the base ragger conftest using the overridden configuration
 pytest_plugins = ("ragger.conftest.base_conftest", )
 
+def pytest_addoption(parser):
+    """Options of the benchmarks and of the load test."""
+    parser.addoption("--benchmark", action="store_true", default=False,
+                     help="Run the benchmarks of test_benchmark.py")
+    parser.addoption("--benchmark-iterations", type=int, default=50,
+                     help="Number of calls measured per benchmark")
+    parser.addoption("--benchmark-output", type=Path, default=Path("benchmark.json"),
+                     help="JSON report of the benchmarks")
+    parser.addoption("--benchmark-baseline", type=Path, default=None,
+                     help="JSON report the benchmarks must not be slower than")
+    parser.addoption("--benchmark-tolerance", type=float, default=0.2,
+                     help="Tolerated slowdown relative to the baseline")
+    parser.addoption("--load-duration", type=float, default=0.0,
+                     help="Duration, in seconds, of the load test of test_load.py")
+    parser.addoption("--load-seed", type=int, default=0,
+                     help="Seed of the schedule of the load test")
+    parser.addoption("--load-max-idle", type=float, default=60.0,
+                     help="Longest idle time, in seconds, between two requests of the load test")
+
+@pytest.fixture(scope="session")
+def bench(pytestconfig,
+          backend_name: str,
+          firmware: Firmware) -> Generator[Benchmark, None, None]:
+    """Get the benchmark, writing its report at the end of the session."""
+    if not pytestconfig.getoption("benchmark"):
+        pytest.skip("Benchmarks only run with --benchmark")
+    benchmark = Benchmark(
+        iterations=pytestconfig.getoption("benchmark_iterations"),
+        tolerance=pytestconfig.getoption("benchmark_tolerance"),
+        baseline=pytestconfig.getoption("benchmark_baseline")
+    )
+    yield benchmark
+    benchmark.write(pytestconfig.getoption("benchmark_output"), backend_name, firmware.name)
+
 @pytest.fixture(scope="function")
 def client(backend: BackendInterface) -> TezosClient:
     """Get a tezos client."""
@@ -0,0 +1,217 @@
+# Copyright 2024 Trilitech <contact@trili.tech>
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Module gathering the baking app benchmarks.
+
+Only run with --benchmark. The timings measured on Speculos are not
+device timings but are stable enough to catch regressions such as an
+extra derivation or an extra NVRAM write.
+"""
+
+from typing import Callable, Dict
+
+import pytest
+from conftest import skip_nanos_bls
+
+from ragger.firmware import Firmware
+from utils.benchmark import Benchmark
+from utils.client import TezosClient, Hwm
+from utils.account import Account, SigScheme
+from utils.message import (
+    Message,
+    Delegation,
+    Reveal,
+    Preattestation,
+    Attestation,
+    Fitness,
+    BlockHeader,
+    Block,
+    Default
+)
+from utils.navigator import TezosNavigator
+from common import ACCOUNTS, TZ1_ACCOUNT, TZ4_ACCOUNT
+
+# Delegations need a user validation, fewer of them are measured
+DELEGATION_ITERATIONS_DIVISOR = 10
+
+BAKING_MESSAGES: Dict[str, Callable[[int], Message]] = {
+    "preattestation": lambda level: Preattestation(
+        op_level=level,
+        chain_id=Default.CHAIN_ID
+    ),
+    "attestation": lambda level: Attestation(
+        op_level=level,
+        chain_id=Default.CHAIN_ID
+    ),
+    "block": lambda level: Block(
+        header=BlockHeader(level=level, fitness=Fitness(level=level)),
+        chain_id=Default.CHAIN_ID
+    ),
+}
+
+def setup_account(account: Account, tezos_navigator: TezosNavigator) -> None:
+    """Authorize the account with fresh high watermarks."""
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+@skip_nanos_bls
+@pytest.mark.parametrize("account", ACCOUNTS)
+@pytest.mark.parametrize("kind", list(BAKING_MESSAGES))
+def test_benchmark_sign_baking(account: Account,
+                               kind: str,
+                               firmware: Firmware,
+                               client: TezosClient,
+                               tezos_navigator: TezosNavigator,
+                               bench: Benchmark) -> None:
+    """Benchmark the signature of baking messages at increasing levels."""
+    setup_account(account, tezos_navigator)
+    build = BAKING_MESSAGES[kind]
+
+    bench.run(
+        f"sign_{kind}[{account}]",
+        lambda index: client.sign_message(account, build(index + 1))
+    )
+
+@skip_nanos_bls
+@pytest.mark.parametrize("account", ACCOUNTS)
+@pytest.mark.parametrize("cached", [True, False], ids=["cached", "derived"])
+def test_benchmark_sign_derived_key(account: Account,
+                                    cached: bool,
+                                    firmware: Firmware,
+                                    client: TezosClient,
+                                    tezos_navigator: TezosNavigator,
+                                    bench: Benchmark) -> None:
+    """Benchmark the signature of attestations with and without the derived key cache.
+
+    Only the first authorized key is kept derived in RAM: added after
+    a key of another curve, the key is derived on every signature.
+    """
+    if cached:
+        setup_account(account, tezos_navigator)
+    else:
+        first_account = next(
+            other for other in ACCOUNTS
+            if other.sig_scheme not in (account.sig_scheme, SigScheme.BLS)
+        )
+        setup_account(first_account, tezos_navigator)
+        tezos_navigator.authorize_baking(account, add=True)
+
+    build = BAKING_MESSAGES["attestation"]
+
+    bench.run(
+        f"sign_attestation[{account}][{'cached' if cached else 'derived'}]",
+        lambda index: client.sign_message(account, build(index + 1))
+    )
+
+@skip_nanos_bls
+@pytest.mark.parametrize("account", [TZ4_ACCOUNT])
+def test_benchmark_sign_tz4_derivations(account: Account,
+                                        firmware: Firmware,
+                                        client: TezosClient,
+                                        tezos_navigator: TezosNavigator,
+                                        bench: Benchmark) -> None:
+    """Benchmark a tz4 attestation signed with and without the derived key cache.
+
+    Reports the time of a derivation alongside: the time of
+    GET_PUBLIC_KEY with a key that is not the first authorized key,
+    whose public key is not stored. Speculos timings are too noisy to
+    be asserted on: the number of derivations is checked by
+    `test_query_perf_tz4_derivations`.
+    """
+    build = BAKING_MESSAGES["attestation"]
+
+    setup_account(account, tezos_navigator)
+    bench.run(
+        "sign_attestation[tz4][cached]",
+        lambda index: client.sign_message(account, build(index + 1))
+    )
+
+    setup_account(TZ1_ACCOUNT, tezos_navigator)
+    tezos_navigator.authorize_baking(account, add=True)
+    bench.run(
+        "sign_attestation[tz4][derived]",
+        lambda index: client.sign_message(account, build(index + 1))
+    )
+    bench.run(
+        "get_public_key[tz4][derived]",
+        lambda _: client.get_public_key_silent(account)
+    )
+
+@skip_nanos_bls
+@pytest.mark.parametrize("account", ACCOUNTS)
+def test_benchmark_sign_reveal(account: Account,
+                               firmware: Firmware,
+                               client: TezosClient,
+                               tezos_navigator: TezosNavigator,
+                               bench: Benchmark) -> None:
+    """Benchmark the signature of a reveal."""
+    setup_account(account, tezos_navigator)
+    reveal = Reveal(
+        public_key=account.public_key,
+        source=account.public_key_hash,
+    )
+
+    bench.run(
+        f"sign_reveal[{account}]",
+        lambda _: client.sign_message(account, reveal)
+    )
+
+@skip_nanos_bls
+@pytest.mark.parametrize("account", ACCOUNTS)
+def test_benchmark_sign_delegation(account: Account,
+                                   firmware: Firmware,
+                                   tezos_navigator: TezosNavigator,
+                                   bench: Benchmark) -> None:
+    """Benchmark the signature of a delegation, user validation included."""
+    setup_account(account, tezos_navigator)
+    delegation = Delegation(
+        delegate=account.public_key_hash,
+        source=account.public_key_hash,
+    )
+
+    bench.run(
+        f"sign_delegation[{account}]",
+        lambda _: tezos_navigator.sign_delegation(account, delegation),
+        iterations=max(1, bench.iterations // DELEGATION_ITERATIONS_DIVISOR)
+    )
+
+@skip_nanos_bls
+@pytest.mark.parametrize("account", ACCOUNTS)
+def test_benchmark_hmac(account: Account,
+                        firmware: Firmware,
+                        client: TezosClient,
+                        bench: Benchmark) -> None:
+    """Benchmark the HMAC instruction."""
+    message = bytes(32)
+
+    bench.run(
+        f"hmac[{account}]",
+        lambda _: client.hmac(account, message)
+    )
+
+@skip_nanos_bls
+@pytest.mark.parametrize("account", ACCOUNTS)
+def test_benchmark_get_public_key(account: Account,
+                                  firmware: Firmware,
+                                  client: TezosClient,
+                                  bench: Benchmark) -> None:
+    """Benchmark the silent GET_PUBLIC_KEY instruction."""
+    bench.run(
+        f"get_public_key[{account}]",
+        lambda _: client.get_public_key_silent(account)
+    )
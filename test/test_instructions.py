@@ -27,17 +27,22 @@ import pytest
 from conftest import skip_nanos_bls
 
 from ragger.backend import BackendInterface
+from ragger.error import ExceptionRAPDU
 from ragger.firmware import Firmware
-from utils.client import TezosClient, Version, Hwm, StatusCode
-from utils.account import Account, PublicKey, SigScheme
+from utils.client import TezosClient, Version, Hwm, Ins, StatusCode, MAX_APDU_SIZE
+from utils.account import Account, BipPath, PublicKey, SigScheme, check_bls_signature
 from utils.helper import get_current_commit
 from utils.message import (
     Message,
+    Micheline,
+    RawMessage,
     ManagerOperation,
     OperationGroup,
     Delegation,
     Reveal,
     Transaction,
+    UpdateConsensusKey,
+    Staking,
     Preattestation,
     Attestation,
     Fitness,
@@ -55,8 +60,10 @@ from common import (
     DEFAULT_ACCOUNT,
     DEFAULT_ACCOUNT_2,
     TZ1_ACCOUNTS,
+    TZ2_ACCOUNTS,
+    TZ3_ACCOUNTS,
+    TZ4_ACCOUNTS,
     ACCOUNTS,
-    ZEBRA_ACCOUNTS,
 )
 
 @skip_nanos_bls
@@ -505,53 +512,146 @@ def test_ledger_screensaver(firmware: Firmware,
         assert (res.find("y") != -1), "Ledger screensaver should have activated"
 
 
+def test_query_perf(client: TezosClient, tezos_navigator: TezosNavigator) -> None:
+    """Check that the phase timers count the phases of a signature.
+
+       Only runs if the app is built with PERF_COUNTERS.
+
+    """
+    try:
+        client.reset_perf()
+    except ExceptionRAPDU as e:
+        if e.status == StatusCode.INVALID_INS:
+            pytest.skip("App built without PERF_COUNTERS")
+        raise
+
+    account = DEFAULT_ACCOUNT
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    client.reset_perf()
+    assert all(counter.count == 0 for counter in client.query_perf()[1:])
+
+    attestation = build_attestation(op_level=1, op_round=0, chain_id=Default.CHAIN_ID)
+    client.sign_message(account, attestation)
+
+    counters = client.query_perf()
+    assert len(counters) == 10
+    # parse_consensus_operation, blake2b final, sign, nvm_write and response
+    for phase in [1, 5, 7, 8, 9]:
+        assert counters[phase].count == 1, f"Phase {phase}: {counters[phase]}"
+        assert counters[phase].min <= counters[phase].max
+    # The ticks come from a cycle counter or a timer that moves while signing
+    assert counters[7].max > 0, f"Phase 7: {counters[7]}"
+    # parse_block and parse_operations
+    for phase in [2, 3]:
+        assert counters[phase].count == 0, f"Phase {phase}: {counters[phase]}"
+
+    # The first packet selects the key, the second one is signed
+    histogram = client.query_perf_histogram(Ins.SIGN)
+    assert sum(histogram) == 2
+    # The signature takes more than the first bucket
+    assert sum(histogram[1:]) >= 1, f"Histogram: {histogram}"
+    assert sum(client.query_perf_histogram(Ins.HMAC)) == 0
+
+    with StatusCode.WRONG_PARAM.expected():
+        client.query_perf_histogram(0xff)
+
+
+def test_query_perf_signed(client: TezosClient, tezos_navigator: TezosNavigator) -> None:
+    """Check that the signed baking messages are counted by kind.
+
+       Only runs if the app is built with PERF_COUNTERS.
+
+    """
+    try:
+        client.reset_perf()
+    except ExceptionRAPDU as e:
+        if e.status == StatusCode.INVALID_INS:
+            pytest.skip("App built without PERF_COUNTERS")
+        raise
+
+    account = DEFAULT_ACCOUNT
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    client.reset_perf()
+    assert client.query_perf_signed() == [0, 0, 0, 0]
+
+    client.sign_message(account, build_preattestation(1, 0, Default.CHAIN_ID))
+    client.sign_message(account, build_attestation(1, 0, Default.CHAIN_ID))
+    client.sign_message(account, build_attestation_dal(2, 0, Default.CHAIN_ID))
+    client.sign_message(account, build_attestation_dal(3, 0, Default.CHAIN_ID))
+
+    # A refused message is not counted
+    with StatusCode.WRONG_VALUES.expected():
+        client.sign_message(account, build_attestation(1, 0, Default.CHAIN_ID))
+
+    # blocks, preattestations, attestations and attestations with DAL
+    assert client.query_perf_signed() == [0, 1, 1, 2]
+
+    client.reset_perf()
+    assert client.query_perf_signed() == [0, 0, 0, 0]
+
+
 @skip_nanos_bls
-@pytest.mark.parametrize("account", ZEBRA_ACCOUNTS)
-def test_benchmark_attestation_time(account: Account,
+@pytest.mark.parametrize("account", TZ4_ACCOUNTS)
+def test_query_perf_tz4_derivations(account: Account,
                                     firmware: Firmware,
                                     client: TezosClient,
-                                    tezos_navigator: TezosNavigator,
-                                    backend_name) -> None:
-    """Benchmark attestation signing time.
+                                    tezos_navigator: TezosNavigator) -> None:
+    """Check that a tz4 attestation derives the key once without the derived key cache.
 
-       Only runs for physical devices.
+       Only runs if the app is built with PERF_COUNTERS.
 
     """
-    # check if backend is speculos, then return .
-    if backend_name == "speculos":
-        assert True
-        return
+    try:
+        client.reset_perf()
+    except ExceptionRAPDU as e:
+        if e.status == StatusCode.INVALID_INS:
+            pytest.skip("App built without PERF_COUNTERS")
+        raise
 
-    lvl = 0
-    main_chain_id = Default.CHAIN_ID
-    main_hwm = Hwm(lvl, 0)
-    test_hwm = Hwm(0, 0)
+    key_derivation = 6
 
     tezos_navigator.setup_app_context(
         account,
-        main_chain_id,
-        main_hwm,
-        test_hwm
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
     )
-    st = time.time()
-    # Run test for 100 times.
-    for _ in range(100):
-        lvl += 1
-        attestation = build_attestation(
-            op_level=lvl,
-            op_round=0,
-            chain_id=main_chain_id
-        )
-        client.sign_message(account, attestation)
-    end= time.time()
-    with open("Avg_time_for_100_attestations.txt",'a') as f:
-        f.write(
-            "\nTime elapsed for derivation type : "
-            + str(account)
-            + " is : "
-            + str(end-st)
-            + "\n"
-        )
+
+    # The first authorized key is derived in RAM once
+    client.sign_message(account, build_attestation(1, 0, Default.CHAIN_ID))
+    client.reset_perf()
+    client.sign_message(account, build_attestation(2, 0, Default.CHAIN_ID))
+    counter = client.query_perf()[key_derivation]
+    assert counter.count == 0, f"Cached key: {counter}"
+
+    # Added after a key of another curve, the key is not cached
+    tezos_navigator.setup_app_context(
+        DEFAULT_ACCOUNT,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+    tezos_navigator.authorize_baking(account, add=True)
+
+    for level in range(1, 4):
+        client.reset_perf()
+        client.sign_message(account, build_attestation(level, 0, Default.CHAIN_ID))
+        counter = client.query_perf()[key_derivation]
+        assert counter.count == 1, f"Level {level}: {counter}"
 
 
 @skip_nanos_bls
@@ -999,6 +1099,56 @@ def test_sign_attestation_dal(
     )
 
 
+def test_sign_malformed_consensus_operation(
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that a consensus operation with a wrong tag or trailing bytes is refused."""
+    account = DEFAULT_ACCOUNT
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    # magic byte (1), chain id (4) and branch (32) precede the tag
+    tag_offset = 1 + 4 + 32
+
+    def with_tag(message: Message, tag: int) -> RawMessage:
+        raw = bytearray(bytes(message))
+        raw[tag_offset] = tag
+        return RawMessage(bytes(raw))
+
+    attestation = build_attestation(1, 0, Default.CHAIN_ID)
+    attestation_dal = build_attestation_dal(1, 0, Default.CHAIN_ID)
+    preattestation = build_preattestation(1, 0, Default.CHAIN_ID)
+
+    for message in [
+            # preattestation tag with the attestation magic byte
+            with_tag(attestation, 20),
+            # attestation tag with the preattestation magic byte
+            with_tag(preattestation, 21),
+            # attestation with DAL tag without its DAL content
+            with_tag(attestation, 23),
+            # plain attestation tag followed by the DAL content
+            with_tag(attestation_dal, 21),
+            RawMessage(bytes(attestation) + b'\x00'),
+            RawMessage(bytes(attestation_dal) + b'\x00'),
+            RawMessage(bytes(preattestation) + b'\x00'),
+    ]:
+        with StatusCode.PARSE_ERROR.expected():
+            client.sign_message(account, message)
+
+    # Nothing has been signed
+    tezos_navigator.check_app_context(
+        account,
+        chain_id=Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+
 @skip_nanos_bls
 @pytest.mark.parametrize("account", ACCOUNTS)
 @pytest.mark.parametrize("with_hash", [False, True])
@@ -1415,124 +1565,57 @@ def test_sign_not_authorized_key(
         client.sign_message(account_2, attestation)
 
 
-def test_sign_transaction(
+@skip_nanos_bls
+@pytest.mark.parametrize("account", ACCOUNTS)
+@pytest.mark.parametrize("with_hash", [False, True])
+def test_sign_with_authorized_key(
+        account: Account,
+        with_hash: bool,
         client: TezosClient,
         tezos_navigator: TezosNavigator) -> None:
-    """Check that signing a transaction is not allowed."""
-
-    account_1 = DEFAULT_ACCOUNT
-    account_2 = DEFAULT_ACCOUNT_2
+    """Test the SIGN(_WITH_HASH) instruction with the authorized key in a single exchange."""
 
     main_chain_id = Default.CHAIN_ID
 
     tezos_navigator.setup_app_context(
-        account_1,
+        account,
         main_chain_id,
         main_hwm=Hwm(0, 0),
         test_hwm=Hwm(0, 0)
     )
 
-    transaction = Transaction(
-        source=account_1.public_key_hash,
-        destination=account_2.public_key_hash,
-        amount=10_000,
+    attestation = build_attestation(
+        op_level=1,
+        op_round=2,
+        chain_id=main_chain_id
     )
 
-    with StatusCode.PARSE_ERROR.expected():
-        client.sign_message(account_1, transaction)
-
+    if not with_hash:
+        signature = client.sign_message_with_authorized_key(account, attestation)
+        account.check_signature(signature, bytes(attestation))
+    else:
+        attestation_hash, signature = \
+            client.sign_message_with_hash_with_authorized_key(account, attestation)
+        assert attestation_hash == attestation.hash, \
+            f"Expected hash {attestation.hash.hex()} but got {attestation_hash.hex()}"
+        account.check_signature(signature, bytes(attestation))
 
-def build_reveal(account: Account) -> Reveal:
-    """Build a reveal."""
-    return Reveal(
-        public_key=account.public_key,
-        source=account.public_key_hash,
-    )
-def build_delegation(account: Account) -> Delegation:
-    """Build a delegation."""
-    return Delegation(
-        delegate=account.public_key_hash,
-        source=account.public_key_hash,
-    )
-def build_transaction(account: Account) -> Transaction:
-    """Build a transaction."""
-    return Transaction(
-        source=account.public_key_hash,
-        destination=DEFAULT_ACCOUNT_2.public_key_hash,
-        amount=10_000,
-    )
-def build_bad_reveal_1(account: Account) -> Reveal:
-    """Build a bad reveal."""
-    return Reveal(
-        public_key=account.public_key,
-        source=DEFAULT_ACCOUNT_2.public_key_hash,
-    )
-def build_bad_reveal_2(account: Account) -> Reveal:
-    """Build an other bad reveal."""
-    return Reveal(
-        public_key=DEFAULT_ACCOUNT_2.public_key,
-        source=account.public_key_hash,
-    )
-def build_bad_delegation_1(account: Account) -> Delegation:
-    """Build a bad delegation."""
-    return Delegation(
-        delegate=account.public_key_hash,
-        source=DEFAULT_ACCOUNT_2.public_key_hash,
-    )
-def build_bad_delegation_2(account: Account) -> Delegation:
-    """Build a other bad delegation."""
-    return Delegation(
-        delegate=DEFAULT_ACCOUNT_2.public_key_hash,
-        source=account.public_key_hash,
+    tezos_navigator.check_app_context(
+        account,
+        chain_id=main_chain_id,
+        main_hwm=Hwm(1, 2),
+        test_hwm=Hwm(0, 0)
     )
 
+    # The HWM is checked in the same way
+    with StatusCode.WRONG_VALUES.expected():
+        client.sign_message_with_authorized_key(account, attestation)
 
-# Warning: operation PARSE_ERROR are not available on DEBUG-mode
-PARAMETERS_SIGN_MULTIPLE_OPERATIONS = [
-    (build_reveal,       build_reveal,           None,              False, StatusCode.OK         ),
-    (build_reveal,       build_delegation,       None,              True,  StatusCode.OK         ),
-    (build_delegation,   build_reveal,           None,              True,  StatusCode.OK         ),
-    (build_reveal,       build_delegation,       build_reveal,      True,  StatusCode.OK         ),
-] + [
-    (build_bad_reveal_1, build_reveal,           None,              False, StatusCode.PARSE_ERROR),
-    (build_bad_reveal_1, build_delegation,       None,              True,  StatusCode.PARSE_ERROR),
-    (build_bad_reveal_2, build_reveal,           None,              False, StatusCode.PARSE_ERROR),
-    (build_bad_reveal_2, build_delegation,       None,              True,  StatusCode.PARSE_ERROR),
-    (build_reveal,       build_bad_reveal_1,     None,              False, StatusCode.PARSE_ERROR),
-    (build_delegation,   build_bad_reveal_1,     None,              True,  StatusCode.PARSE_ERROR),
-    (build_reveal,       build_bad_reveal_2,     None,              False, StatusCode.PARSE_ERROR),
-    (build_delegation,   build_bad_reveal_2,     None,              True,  StatusCode.PARSE_ERROR),
-    (build_reveal,       build_bad_delegation_1, None,              True,  StatusCode.PARSE_ERROR),
-    (build_reveal,       build_bad_delegation_2, None,              True,  StatusCode.SECURITY   ),
-    (build_bad_delegation_1, build_reveal,       None,              True,  StatusCode.PARSE_ERROR),
-    (build_bad_delegation_2, build_reveal,       None,              True,  StatusCode.SECURITY   ),
-    (build_reveal,       build_transaction,      None,              False, StatusCode.PARSE_ERROR),
-    (build_transaction,  build_reveal,           None,              False, StatusCode.PARSE_ERROR),
-    (build_delegation,   build_delegation,       None,              True,  StatusCode.PARSE_ERROR),
-    (build_delegation,   build_delegation,       None,              True,  StatusCode.PARSE_ERROR),
-    (build_reveal,       build_delegation,       build_delegation,  True,  StatusCode.PARSE_ERROR),
-    (build_delegation,   build_delegation,       build_reveal,      True,  StatusCode.PARSE_ERROR),
-    (build_reveal,       build_delegation,       build_transaction, True,  StatusCode.PARSE_ERROR),
-    (build_transaction,  build_delegation,       build_reveal,      True,  StatusCode.PARSE_ERROR),
-]
 
-@pytest.mark.parametrize(
-    "operation_builder_1," \
-    "operation_builder_2," \
-    "operation_builder_3," \
-    "operation_display," \
-    "status_code",
-    PARAMETERS_SIGN_MULTIPLE_OPERATIONS
-)
-def test_sign_multiple_operation(
-        operation_builder_1: Callable[[Account], ManagerOperation],
-        operation_builder_2: Callable[[Account], ManagerOperation],
-        operation_builder_3: Optional[Callable[[Account], ManagerOperation]],
-        status_code: StatusCode,
-        operation_display: bool,
+def test_sign_with_authorized_key_constraints(
         client: TezosClient,
         tezos_navigator: TezosNavigator) -> None:
-    """Test multiple operations signing constraints."""
+    """Check that only baking messages are signed with the authorized key in one exchange."""
 
     account = DEFAULT_ACCOUNT
 
@@ -1543,58 +1626,683 @@ def test_sign_multiple_operation(
         test_hwm=Hwm(0, 0)
     )
 
-    operations = [
-        operation_builder_1(account),
-        operation_builder_2(account),
-    ]
-    if operation_builder_3 is not None:
-        operations.append(operation_builder_3(account))
-    operation = OperationGroup(operations)
+    reveal = Reveal(
+        public_key=account.public_key,
+        source=account.public_key_hash,
+    )
 
-    with status_code.expected():
-        if operation_display:
-            signature = send_and_navigate(
-                send=lambda: client.sign_message(
-                    account,
-                    operation
-                ),
-                navigate=tezos_navigator.accept_sign_navigate
-            )
-        else:
-            signature = client.sign_message(
-                account,
-                operation
-            )
-        account.check_signature(signature, bytes(operation))
+    with StatusCode.PARSE_ERROR.expected():
+        client.sign_message_with_authorized_key(account, reveal)
 
+    client.deauthorize()
 
-def test_sign_when_hwm_disabled(
+    attestation = build_attestation(1, 0, Default.CHAIN_ID)
+
+    with StatusCode.SECURITY.expected():
+        client.sign_message_with_authorized_key(account, attestation)
+
+
+@skip_nanos_bls
+@pytest.mark.parametrize("account", ACCOUNTS)
+def test_sign_batch(
+        account: Account,
         client: TezosClient,
         tezos_navigator: TezosNavigator) -> None:
-    """Check that signing, when HWM is disabled, changes the main HWM."""
-
-    account = DEFAULT_ACCOUNT
+    """Test the SIGN_BATCH instruction."""
 
-    tezos_navigator.disable_hwm()
+    main_chain_id = Default.CHAIN_ID
 
     tezos_navigator.setup_app_context(
         account,
-        Default.CHAIN_ID,  # Chain = 0
+        main_chain_id,
         main_hwm=Hwm(0, 0),
         test_hwm=Hwm(0, 0)
     )
 
-    attestation = build_attestation(
-        1, 0,
-        Default.CHAIN_ID  # Chain = 0
-    )
+    preattestation = build_preattestation(1, 2, main_chain_id)
+    attestation = build_attestation(1, 2, main_chain_id)
 
-    client.sign_message(account, attestation)
+    signatures = client.sign_batch(account, [preattestation, attestation])
+
+    assert len(signatures) == 2, f"Expected 2 signatures but got {len(signatures)}"
+    account.check_signature(signatures[0], bytes(preattestation))
+    account.check_signature(signatures[1], bytes(attestation))
 
     tezos_navigator.check_app_context(
         account,
-        chain_id=Default.CHAIN_ID,
-        main_hwm=Hwm(1, 0),
+        chain_id=main_chain_id,
+        main_hwm=Hwm(1, 2),
+        test_hwm=Hwm(0, 0)
+    )
+
+
+def test_sign_batch_constraints(
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that a batch is refused as a whole and leaves the HWM unchanged."""
+
+    account = DEFAULT_ACCOUNT
+    main_chain_id = Default.CHAIN_ID
+
+    tezos_navigator.setup_app_context(
+        account,
+        main_chain_id,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    preattestation = build_preattestation(1, 0, main_chain_id)
+    attestation = build_attestation(1, 0, main_chain_id)
+
+    # A preattestation cannot follow an attestation of the same level and round
+    with StatusCode.WRONG_VALUES.expected():
+        client.sign_batch(account, [attestation, preattestation])
+
+    with StatusCode.WRONG_LENGTH.expected():
+        client.sign_batch(account, [])
+
+    with StatusCode.WRONG_LENGTH.expected():
+        client.sign_batch(account, [
+            build_preattestation(1, 0, main_chain_id),
+            build_attestation(1, 0, main_chain_id),
+            build_attestation(2, 0, main_chain_id)
+        ])
+
+    tezos_navigator.check_app_context(
+        account,
+        chain_id=main_chain_id,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+
+def test_sign_transaction(
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that signing a transaction is not allowed."""
+
+    account_1 = DEFAULT_ACCOUNT
+    account_2 = DEFAULT_ACCOUNT_2
+
+    main_chain_id = Default.CHAIN_ID
+
+    tezos_navigator.setup_app_context(
+        account_1,
+        main_chain_id,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    transaction = Transaction(
+        source=account_1.public_key_hash,
+        destination=account_2.public_key_hash,
+        amount=10_000,
+    )
+
+    with StatusCode.PARSE_ERROR.expected():
+        client.sign_message(account_1, transaction)
+
+
+@skip_nanos_bls
+@pytest.mark.parametrize("account", ACCOUNTS)
+def test_sign_update_consensus_key(
+        account: Account,
+        tezos_navigator: TezosNavigator) -> None:
+    """Test the SIGN instruction on consensus key update."""
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    update_consensus_key = UpdateConsensusKey(
+        public_key=DEFAULT_ACCOUNT_2.public_key,
+        source=account.public_key_hash,
+    )
+
+    signature = tezos_navigator.sign_manager_operation(
+        account,
+        update_consensus_key
+    )
+    account.check_signature(signature, bytes(update_consensus_key))
+
+
+def test_sign_update_consensus_key_constraints(
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that a consensus key update is only signed for the authorized key."""
+
+    account = DEFAULT_ACCOUNT
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    # Warning: operation PARSE_ERROR are not available on DEBUG-mode
+    with StatusCode.PARSE_ERROR.expected():
+        client.sign_message(account, UpdateConsensusKey(
+            public_key=DEFAULT_ACCOUNT_2.public_key,
+            source=DEFAULT_ACCOUNT_2.public_key_hash,
+        ))
+
+    with StatusCode.SECURITY.expected():
+        client.sign_message(DEFAULT_ACCOUNT_2, UpdateConsensusKey(
+            public_key=account.public_key,
+            source=DEFAULT_ACCOUNT_2.public_key_hash,
+        ))
+
+
+PARAMETERS_SIGN_STAKING = [
+    ("stake", 1_000_000, Default.Micheline.VALUE),
+    ("unstake", 500_000, Default.Micheline.VALUE),
+    ("finalize_unstake", 0, Default.Micheline.VALUE),
+    ("set_delegate_parameters", 0, Staking.delegate_parameters(5_000_000, 100_000_000)),
+]
+
+@pytest.mark.parametrize("entrypoint, amount, parameter", PARAMETERS_SIGN_STAKING)
+def test_sign_staking(
+        entrypoint: str,
+        amount: int,
+        parameter: Micheline,
+        tezos_navigator: TezosNavigator) -> None:
+    """Test the SIGN instruction on staking operations."""
+
+    account = DEFAULT_ACCOUNT
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    staking = Staking(
+        entrypoint=entrypoint,
+        amount=amount,
+        parameter=parameter,
+        source=account.public_key_hash,
+    )
+
+    signature = tezos_navigator.sign_manager_operation(
+        account,
+        staking
+    )
+    account.check_signature(signature, bytes(staking))
+
+
+def test_sign_staking_constraints(
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that only well-formed staking operations are signed."""
+
+    account = DEFAULT_ACCOUNT
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    # Warning: operation PARSE_ERROR are not available on DEBUG-mode
+    for staking in [
+            # Amount on an entrypoint which does not transfer tez
+            Staking(
+                entrypoint="finalize_unstake",
+                amount=1,
+                source=account.public_key_hash,
+            ),
+            # Parameters not matching the entrypoint
+            Staking(
+                entrypoint="stake",
+                amount=1_000_000,
+                parameter=Staking.delegate_parameters(5_000_000, 100_000_000),
+                source=account.public_key_hash,
+            ),
+            Staking(
+                entrypoint="set_delegate_parameters",
+                source=account.public_key_hash,
+            ),
+            # Source not being the signing key
+            Staking(
+                entrypoint="stake",
+                amount=1_000_000,
+                source=DEFAULT_ACCOUNT_2.public_key_hash,
+            ),
+            # Destination not being the source
+            Transaction(
+                source=account.public_key_hash,
+                destination=DEFAULT_ACCOUNT_2.public_key_hash,
+                amount=1_000_000,
+                entrypoint="stake",
+            ),
+    ]:
+        with StatusCode.PARSE_ERROR.expected():
+            client.sign_message(account, staking)
+
+    with StatusCode.SECURITY.expected():
+        client.sign_message(DEFAULT_ACCOUNT_2, Staking(
+            entrypoint="stake",
+            amount=1_000_000,
+            source=DEFAULT_ACCOUNT_2.public_key_hash,
+        ))
+
+
+def build_reveal(account: Account) -> Reveal:
+    """Build a reveal."""
+    return Reveal(
+        public_key=account.public_key,
+        source=account.public_key_hash,
+    )
+def build_delegation(account: Account) -> Delegation:
+    """Build a delegation."""
+    return Delegation(
+        delegate=account.public_key_hash,
+        source=account.public_key_hash,
+    )
+def build_transaction(account: Account) -> Transaction:
+    """Build a transaction."""
+    return Transaction(
+        source=account.public_key_hash,
+        destination=DEFAULT_ACCOUNT_2.public_key_hash,
+        amount=10_000,
+    )
+def build_bad_reveal_1(account: Account) -> Reveal:
+    """Build a bad reveal."""
+    return Reveal(
+        public_key=account.public_key,
+        source=DEFAULT_ACCOUNT_2.public_key_hash,
+    )
+def build_bad_reveal_2(account: Account) -> Reveal:
+    """Build an other bad reveal."""
+    return Reveal(
+        public_key=DEFAULT_ACCOUNT_2.public_key,
+        source=account.public_key_hash,
+    )
+def build_bad_delegation_1(account: Account) -> Delegation:
+    """Build a bad delegation."""
+    return Delegation(
+        delegate=account.public_key_hash,
+        source=DEFAULT_ACCOUNT_2.public_key_hash,
+    )
+def build_bad_delegation_2(account: Account) -> Delegation:
+    """Build a other bad delegation."""
+    return Delegation(
+        delegate=DEFAULT_ACCOUNT_2.public_key_hash,
+        source=account.public_key_hash,
+    )
+
+
+# Warning: operation PARSE_ERROR are not available on DEBUG-mode
+PARAMETERS_SIGN_MULTIPLE_OPERATIONS = [
+    (build_reveal,       build_reveal,           None,              False, StatusCode.OK         ),
+    (build_reveal,       build_delegation,       None,              True,  StatusCode.OK         ),
+    (build_delegation,   build_reveal,           None,              True,  StatusCode.OK         ),
+    (build_reveal,       build_delegation,       build_reveal,      True,  StatusCode.OK         ),
+] + [
+    (build_bad_reveal_1, build_reveal,           None,              False, StatusCode.PARSE_ERROR),
+    (build_bad_reveal_1, build_delegation,       None,              True,  StatusCode.PARSE_ERROR),
+    (build_bad_reveal_2, build_reveal,           None,              False, StatusCode.PARSE_ERROR),
+    (build_bad_reveal_2, build_delegation,       None,              True,  StatusCode.PARSE_ERROR),
+    (build_reveal,       build_bad_reveal_1,     None,              False, StatusCode.PARSE_ERROR),
+    (build_delegation,   build_bad_reveal_1,     None,              True,  StatusCode.PARSE_ERROR),
+    (build_reveal,       build_bad_reveal_2,     None,              False, StatusCode.PARSE_ERROR),
+    (build_delegation,   build_bad_reveal_2,     None,              True,  StatusCode.PARSE_ERROR),
+    (build_reveal,       build_bad_delegation_1, None,              True,  StatusCode.PARSE_ERROR),
+    (build_reveal,       build_bad_delegation_2, None,              True,  StatusCode.SECURITY   ),
+    (build_bad_delegation_1, build_reveal,       None,              True,  StatusCode.PARSE_ERROR),
+    (build_bad_delegation_2, build_reveal,       None,              True,  StatusCode.SECURITY   ),
+    (build_reveal,       build_transaction,      None,              False, StatusCode.PARSE_ERROR),
+    (build_transaction,  build_reveal,           None,              False, StatusCode.PARSE_ERROR),
+    (build_delegation,   build_delegation,       None,              True,  StatusCode.PARSE_ERROR),
+    (build_delegation,   build_delegation,       None,              True,  StatusCode.PARSE_ERROR),
+    (build_reveal,       build_delegation,       build_delegation,  True,  StatusCode.PARSE_ERROR),
+    (build_delegation,   build_delegation,       build_reveal,      True,  StatusCode.PARSE_ERROR),
+    (build_reveal,       build_delegation,       build_transaction, True,  StatusCode.PARSE_ERROR),
+    (build_transaction,  build_delegation,       build_reveal,      True,  StatusCode.PARSE_ERROR),
+]
+
+@pytest.mark.parametrize(
+    "operation_builder_1," \
+    "operation_builder_2," \
+    "operation_builder_3," \
+    "operation_display," \
+    "status_code",
+    PARAMETERS_SIGN_MULTIPLE_OPERATIONS
+)
+def test_sign_multiple_operation(
+        operation_builder_1: Callable[[Account], ManagerOperation],
+        operation_builder_2: Callable[[Account], ManagerOperation],
+        operation_builder_3: Optional[Callable[[Account], ManagerOperation]],
+        status_code: StatusCode,
+        operation_display: bool,
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Test multiple operations signing constraints."""
+
+    account = DEFAULT_ACCOUNT
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    operations = [
+        operation_builder_1(account),
+        operation_builder_2(account),
+    ]
+    if operation_builder_3 is not None:
+        operations.append(operation_builder_3(account))
+    operation = OperationGroup(operations)
+
+    with status_code.expected():
+        if operation_display:
+            signature = send_and_navigate(
+                send=lambda: client.sign_message(
+                    account,
+                    operation
+                ),
+                navigate=tezos_navigator.accept_sign_navigate
+            )
+        else:
+            signature = client.sign_message(
+                account,
+                operation
+            )
+        account.check_signature(signature, bytes(operation))
+
+
+def test_sign_packet_without_key_path(
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that no packet is accepted once a message has been signed or refused."""
+
+    account = DEFAULT_ACCOUNT
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    operation = OperationGroup([build_reveal(account), build_reveal(account)])
+
+    signature = client.sign_message(account, operation)
+    account.check_signature(signature, bytes(operation))
+
+    with StatusCode.PARSE_ERROR.expected():
+        client.sign_last_packet(account, operation)
+
+    # Reveal of another key: refused while parsed
+    with StatusCode.PARSE_ERROR.expected():
+        client.sign_message(account, OperationGroup([build_reveal(DEFAULT_ACCOUNT_2)]))
+
+    with StatusCode.PARSE_ERROR.expected():
+        client.sign_last_packet(account, operation)
+
+    # Delegation to another key: refused once the message has been read
+    delegation = Delegation(
+        delegate=DEFAULT_ACCOUNT_2.public_key_hash,
+        source=account.public_key_hash,
+    )
+    with StatusCode.SECURITY.expected():
+        client.sign_message(account, OperationGroup([delegation]))
+
+    with StatusCode.PARSE_ERROR.expected():
+        client.sign_last_packet(account, operation)
+
+    # A new key path starts a new message
+    signature = client.sign_message(account, operation)
+    account.check_signature(signature, bytes(operation))
+
+
+@pytest.mark.parametrize(
+    "operation_builder_1," \
+    "operation_builder_2," \
+    "operation_display",
+    [
+        (build_reveal, build_reveal,     False),
+        (build_reveal, build_delegation, True ),
+    ]
+)
+def test_sign_operation_split_at_every_byte(
+        operation_builder_1: Callable[[Account], ManagerOperation],
+        operation_builder_2: Callable[[Account], ManagerOperation],
+        operation_display: bool,
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that an operation can be split in two packets at any byte."""
+
+    account = DEFAULT_ACCOUNT
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    operation = OperationGroup([operation_builder_1(account), operation_builder_2(account)])
+    raw_operation = bytes(operation)
+
+    for split in range(1, len(raw_operation)):
+        if operation_display:
+            signature = send_and_navigate(
+                send=lambda split=split: client.sign_message_in_packets(
+                    account,
+                    operation,
+                    [split]
+                ),
+                navigate=tezos_navigator.accept_sign_navigate
+            )
+        else:
+            signature = client.sign_message_in_packets(account, operation, [split])
+        account.check_signature(signature, raw_operation)
+
+
+@skip_nanos_bls
+@pytest.mark.parametrize("account", ACCOUNTS)
+def test_sign_large_operation(
+        account: Account,
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that an operation larger than a packet can be signed."""
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    operation = OperationGroup([build_reveal(account) for _ in range(5)])
+    raw_operation = bytes(operation)
+    assert len(raw_operation) > MAX_APDU_SIZE
+
+    packet_sizes = [MAX_APDU_SIZE] * ((len(raw_operation) - 1) // MAX_APDU_SIZE)
+
+    signature = client.sign_message_in_packets(account, operation, packet_sizes)
+    account.check_signature(signature, raw_operation)
+
+
+@skip_nanos_bls
+@pytest.mark.parametrize("account", ACCOUNTS)
+def test_sign_large_operation_with_hash(
+        account: Account,
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check when the hash of an operation larger than a packet can be returned."""
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    operation = OperationGroup([build_reveal(account) for _ in range(5)])
+    raw_operation = bytes(operation)
+    assert len(raw_operation) > MAX_APDU_SIZE
+
+    packet_sizes = [MAX_APDU_SIZE] * ((len(raw_operation) - 1) // MAX_APDU_SIZE)
+
+    operation_hash, signature = \
+        client.sign_message_in_packets_with_hash(account, operation, packet_sizes)
+    assert operation_hash == operation.hash, \
+        f"Expected hash {operation.hash.hex()} but got {operation_hash.hex()}"
+    account.check_signature(signature, raw_operation)
+
+    # A tz4 signature does not need the hash: it is only computed if
+    # requested from the first packet
+    if account.sig_scheme == SigScheme.BLS:
+        with StatusCode.WRONG_PARAM.expected():
+            client.sign_message_in_packets_with_hash(
+                account, operation, packet_sizes, first_ins=Ins.SIGN)
+    else:
+        operation_hash, signature = client.sign_message_in_packets_with_hash(
+            account, operation, packet_sizes, first_ins=Ins.SIGN)
+        assert operation_hash == operation.hash, \
+            f"Expected hash {operation.hash.hex()} but got {operation_hash.hex()}"
+        account.check_signature(signature, raw_operation)
+
+
+# Packet sizes around the blake2b block (128 bytes) and the
+# hash-to-field blocks of the BLS signature (64 and 136 bytes)
+TZ4_PACKET_SIZES = [1, 63, 64, 65, 127, 128, 135, 136, 137, MAX_APDU_SIZE]
+
+@skip_nanos_bls
+@pytest.mark.parametrize("account", TZ4_ACCOUNTS)
+@pytest.mark.parametrize("cached", [True, False], ids=["cached", "derived"])
+def test_sign_tz4_signature_verification(
+        account: Account,
+        cached: bool,
+        firmware: Firmware,
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check the tz4 signatures of messages sent in one or several packets with py_ecc.
+
+    The message of a tz4 signature is hashed to the field packet by
+    packet: each signature is verified by `check_bls_signature`,
+    independently of the app, against the public key computed from the
+    secret key of the account.
+    """
+
+    if cached:
+        tezos_navigator.setup_app_context(
+            account,
+            Default.CHAIN_ID,
+            main_hwm=Hwm(0, 0),
+            test_hwm=Hwm(0, 0)
+        )
+    else:
+        # Added after a key of another curve, the key is not cached
+        tezos_navigator.setup_app_context(
+            DEFAULT_ACCOUNT,
+            Default.CHAIN_ID,
+            main_hwm=Hwm(0, 0),
+            test_hwm=Hwm(0, 0)
+        )
+        tezos_navigator.authorize_baking(account, add=True)
+
+    # One packet
+    messages = [
+        build_preattestation(1, 0, Default.CHAIN_ID),
+        build_attestation(1, 0, Default.CHAIN_ID),
+        Block(
+            header=BlockHeader(level=2, fitness=Fitness(level=2)),
+            chain_id=Default.CHAIN_ID
+        ),
+        build_reveal(account),
+    ]
+    for message in messages:
+        signature = client.sign_message(account, message)
+        check_bls_signature(account.public_key, signature, bytes(message))
+
+    # Several packets
+    operation = OperationGroup([build_reveal(account) for _ in range(5)])
+    raw_operation = bytes(operation)
+    assert len(raw_operation) > MAX_APDU_SIZE
+
+    for packet_size in TZ4_PACKET_SIZES:
+        packet_sizes = [packet_size] * ((len(raw_operation) - 1) // packet_size)
+        signature = client.sign_message_in_packets(account, operation, packet_sizes)
+        check_bls_signature(account.public_key, signature, raw_operation)
+
+    uneven_packet_sizes = []
+    remaining = len(raw_operation)
+    for packet_size in TZ4_PACKET_SIZES:
+        if packet_size >= remaining:
+            break
+        uneven_packet_sizes.append(packet_size)
+        remaining -= packet_size
+    assert len(uneven_packet_sizes) > 1
+    signature = client.sign_message_in_packets(account, operation, uneven_packet_sizes)
+    check_bls_signature(account.public_key, signature, raw_operation)
+
+
+def test_sign_in_packets_constraints(
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check the limits of signing messages sent in several packets."""
+
+    account = DEFAULT_ACCOUNT
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    # Baking messages must fit in a single packet
+    attestation = build_attestation(1, 0, Default.CHAIN_ID)
+    with StatusCode.PARSE_ERROR.expected():
+        client.sign_message_in_packets(account, attestation, [10])
+
+    # The total size of a message is limited
+    operation = OperationGroup([build_reveal(account) for _ in range(20)])
+    raw_operation = bytes(operation)
+    assert len(raw_operation) > 1024
+    packet_sizes = [MAX_APDU_SIZE] * ((len(raw_operation) - 1) // MAX_APDU_SIZE)
+    with StatusCode.WRONG_LENGTH.expected():
+        client.sign_message_in_packets(account, operation, packet_sizes)
+
+
+def test_sign_when_hwm_disabled(
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that signing, when HWM is disabled, changes the main HWM."""
+
+    account = DEFAULT_ACCOUNT
+
+    tezos_navigator.disable_hwm()
+
+    tezos_navigator.setup_app_context(
+        account,
+        Default.CHAIN_ID,  # Chain = 0
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    attestation = build_attestation(
+        1, 0,
+        Default.CHAIN_ID  # Chain = 0
+    )
+
+    client.sign_message(account, attestation)
+
+    tezos_navigator.check_app_context(
+        account,
+        chain_id=Default.CHAIN_ID,
+        main_hwm=Hwm(1, 0),
         test_hwm=Hwm(0, 0)
     )
 
@@ -1783,11 +2491,14 @@ def test_sign_when_chain_is_setup(
         test_hwm=Hwm(2, 0)
     )
 
+    # Each test chain has its own HWM
     attestation = build_attestation(
         2, 0,
         "NetXH12Af5mrXhq" # Chain = 2
     )
 
+    client.sign_message(account, attestation)
+
     with StatusCode.WRONG_VALUES.expected():
         client.sign_message(account, attestation)
 
@@ -1799,6 +2510,249 @@ def test_sign_when_chain_is_setup(
     )
 
 
+def test_sign_on_several_test_chains(
+        firmware: Firmware,
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that each test chain has its own HWM until the table is full."""
+
+    account = DEFAULT_ACCOUNT
+    main_chain_id = "NetXH12AexHqTQa" # Chain = 1
+
+    tezos_navigator.setup_app_context(
+        account,
+        main_chain_id,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(5, 0)
+    )
+
+    # Sorted by chain id, as in the test chains table
+    test_chain_ids = [
+        "NetXH12Af5mrXhq", # Chain = 2
+        "NetXH12Af8zUiFb", # Chain = 3
+        "NetXH12AfFBQEcU", # Chain = 4
+        "NetXH12AfMXSusJ", # Chain = 5
+        "NetXH12AfXE1Kpe", # Chain = 6
+    ]
+    # The table holds 4 test chains, 2 on Nano S
+    nb_chains = 2 if firmware.name == "nanos" else 4
+
+    # Signed from the highest level to the lowest one: a shared HWM would refuse them
+    for index, chain_id in enumerate(test_chain_ids[:nb_chains]):
+        client.sign_message(account, build_block(10 - index, 0, chain_id))
+
+    with StatusCode.WRONG_VALUES.expected():
+        client.sign_message(account, build_block(10, 0, test_chain_ids[nb_chains]))
+
+    received_main_chain_id, main_hwm, test_hwm, chains_hwm = client.get_chains_hwm()
+
+    assert received_main_chain_id == main_chain_id, \
+        f"Expected main chain id {main_chain_id} but got {received_main_chain_id}"
+    assert main_hwm == Hwm(0, 0), f"Expected main hwm {Hwm(0, 0)} but got {main_hwm}"
+    assert test_hwm == Hwm(5, 0), f"Expected test hwm {Hwm(5, 0)} but got {test_hwm}"
+
+    expected_chains_hwm = [
+        (chain_id, Hwm(10 - index, 0))
+        for index, chain_id in enumerate(test_chain_ids[:nb_chains])
+    ]
+    assert chains_hwm == expected_chains_hwm, \
+        f"Expected test chains hwm {expected_chains_hwm} but got {chains_hwm}"
+
+    # A reset empties the table
+    tezos_navigator.reset_app_context(0)
+
+    client.sign_message(account, build_block(1, 0, test_chain_ids[nb_chains]))
+
+    _, _, _, chains_hwm = client.get_chains_hwm()
+    assert chains_hwm == [(test_chain_ids[nb_chains], Hwm(1, 0))], \
+        f"Expected a single test chain but got {chains_hwm}"
+
+
+def test_sign_manager_operation_with_full_test_chains(
+        firmware: Firmware,
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that manager operations leave the test chains table untouched."""
+
+    account = DEFAULT_ACCOUNT
+    main_chain_id = "NetXH12AexHqTQa" # Chain = 1
+
+    tezos_navigator.setup_app_context(
+        account,
+        main_chain_id,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    test_chain_ids = [
+        "NetXH12Af5mrXhq", # Chain = 2
+        "NetXH12Af8zUiFb", # Chain = 3
+        "NetXH12AfFBQEcU", # Chain = 4
+        "NetXH12AfMXSusJ", # Chain = 5
+    ]
+    # The table holds 4 test chains, 2 on Nano S
+    nb_chains = 2 if firmware.name == "nanos" else 4
+
+    for chain_id in test_chain_ids[:nb_chains]:
+        client.sign_message(account, build_block(1, 0, chain_id))
+
+    expected_chains_hwm = [(chain_id, Hwm(1, 0)) for chain_id in test_chain_ids[:nb_chains]]
+
+    delegation = build_delegation(account)
+    signature = tezos_navigator.sign_delegation(account, delegation)
+    account.check_signature(signature, bytes(delegation))
+
+    reveal = build_reveal(account)
+    signature = client.sign_message(account, reveal)
+    account.check_signature(signature, bytes(reveal))
+
+    _, main_hwm, _, chains_hwm = client.get_chains_hwm()
+    assert main_hwm == Hwm(0, 0), f"Expected main hwm {Hwm(0, 0)} but got {main_hwm}"
+    assert chains_hwm == expected_chains_hwm, \
+        f"Expected test chains hwm {expected_chains_hwm} but got {chains_hwm}"
+
+
+def test_sign_with_several_authorized_keys(
+        firmware: Firmware,
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that each authorized key has its own HWM until all the slots are taken."""
+
+    main_chain_id = "NetXH12AexHqTQa" # Chain = 1
+    # The BLS key is not available on Nano S
+    accounts = [account for account in ACCOUNTS if account.sig_scheme != SigScheme.BLS]
+    # 4 keys can be authorized, 2 on Nano S
+    nb_keys = 2 if firmware.name == "nanos" else 4
+
+    tezos_navigator.setup_app_context(
+        accounts[0],
+        main_chain_id,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    for account in accounts[1:nb_keys]:
+        tezos_navigator.authorize_baking(account, add=True)
+
+    # Refused before any prompt
+    with StatusCode.WRONG_VALUES.expected():
+        client.authorize_baking(accounts[nb_keys], add=True)
+
+    keys = client.get_auth_keys_with_curve()
+    expected_keys = [(account.sig_scheme, account.path) for account in accounts[:nb_keys]]
+    assert keys == expected_keys, f"Expected keys {expected_keys} but got {keys}"
+
+    # Signed from the highest level to the lowest one: a shared HWM would refuse them
+    for index, account in enumerate(accounts[:nb_keys]):
+        client.sign_message(account, build_block(10 - index, 0, main_chain_id))
+
+    with StatusCode.WRONG_VALUES.expected():
+        client.sign_message(accounts[0], build_block(9, 0, main_chain_id))
+
+    with StatusCode.SECURITY.expected():
+        client.sign_message(accounts[nb_keys], build_block(20, 0, main_chain_id))
+
+    for index in range(nb_keys):
+        _, main_hwm, _, _ = client.get_chains_hwm(index)
+        assert main_hwm == Hwm(10 - index, 0), \
+            f"Expected main hwm {Hwm(10 - index, 0)} for key {index} but got {main_hwm}"
+
+    # Re-authorizing a key makes it the only authorized key, with the
+    # highest HWM of the removed keys
+    tezos_navigator.authorize_baking(accounts[1])
+
+    keys = client.get_auth_keys_with_curve()
+    expected_keys = [(accounts[1].sig_scheme, accounts[1].path)]
+    assert keys == expected_keys, f"Expected keys {expected_keys} but got {keys}"
+
+    main_hwm = client.get_main_hwm()
+    assert main_hwm == Hwm(10, 0), f"Expected main hwm {Hwm(10, 0)} but got {main_hwm}"
+
+    with StatusCode.SECURITY.expected():
+        client.sign_message(accounts[0], build_block(20, 0, main_chain_id))
+
+    # Added again, a removed key does not sign below what it signed
+    tezos_navigator.authorize_baking(accounts[0], add=True)
+
+    with StatusCode.WRONG_VALUES.expected():
+        client.sign_message(accounts[0], build_block(10, 0, main_chain_id))
+
+    client.sign_message(accounts[0], build_block(11, 0, main_chain_id))
+
+
+def test_sign_with_companion(
+        firmware: Firmware,
+        client: TezosClient,
+        tezos_navigator: TezosNavigator) -> None:
+    """Check that the SIGN_WITH_COMPANION instruction checks and stores the HWM once."""
+
+    if firmware.name == "nanos":
+        pytest.skip("NanoS does not support BLS")
+
+    account = next(account for account in ACCOUNTS if account.sig_scheme == SigScheme.BLS)
+    companion_path = BipPath.from_string("m/44'/1729'/1'/0'")
+    main_chain_id = Default.CHAIN_ID
+
+    tezos_navigator.setup_app_context(
+        account,
+        main_chain_id,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    attestation = build_attestation(1, 2, main_chain_id)
+
+    # The companion key must have been registered by the user
+    with StatusCode.SECURITY.expected():
+        client.sign_with_companion(companion_path, attestation)
+
+    # An authorized key cannot be the companion key: it would bypass its own HWM
+    with StatusCode.SECURITY.expected():
+        client.register_companion(account.path)
+
+    companion_public_key = tezos_navigator.register_companion(companion_path)
+
+    signature, companion_signature = client.sign_with_companion(companion_path, attestation)
+
+    account.check_signature(signature, bytes(attestation))
+    check_bls_signature(companion_public_key, companion_signature, bytes(attestation))
+
+    # Only the registered companion key can sign
+    with StatusCode.SECURITY.expected():
+        client.sign_with_companion(
+            BipPath.from_string("m/44'/1729'/2'/0'"),
+            build_attestation(2, 0, main_chain_id))
+
+    with StatusCode.SECURITY.expected():
+        client.sign_with_companion(account.path, build_attestation(2, 0, main_chain_id))
+
+    tezos_navigator.check_app_context(
+        account,
+        chain_id=main_chain_id,
+        main_hwm=Hwm(1, 2),
+        test_hwm=Hwm(0, 0)
+    )
+
+    # The same attestation cannot be signed twice
+    with StatusCode.WRONG_VALUES.expected():
+        client.sign_with_companion(companion_path, attestation)
+
+    # Only attestations are accepted
+    with StatusCode.PARSE_ERROR.expected():
+        client.sign_with_companion(companion_path, build_preattestation(2, 0, main_chain_id))
+
+    # The authorized key must be a tz4 key
+    tezos_navigator.setup_app_context(
+        DEFAULT_ACCOUNT,
+        main_chain_id,
+        main_hwm=Hwm(0, 0),
+        test_hwm=Hwm(0, 0)
+    )
+
+    with StatusCode.SECURITY.expected():
+        client.sign_with_companion(companion_path, build_attestation(2, 0, main_chain_id))
+
+
 KEY_SHA256_HEX = "6c4e7e706c54d367c87a8d89c16adfe06cb5680cb7d18e625a90475ec0dbdb9f"
 
 def get_hmac_key(account):
@@ -1836,3 +2790,68 @@ def test_hmac(
     data = client.hmac(account, message)
     assert hmac.compare_digest(calculated_hmac, data), \
         f"Expected HMAC {calculated_hmac.hex()} but got {data.hex()}"
+
+
+# Largest number of HMAC keys the app caches, on devices other than the Nano S
+HMAC_KEY_CACHE_SIZE = 4
+
+
+def test_hmac_cached_keys(client: TezosClient) -> None:
+    """Check that repeated HMACs stay correct while the HMAC keys are cached and evicted."""
+
+    message = bytes.fromhex(HMAC_TEST_SET[2])
+
+    # One more key than the cache holds, so that every key gets evicted
+    accounts = TZ1_ACCOUNTS + TZ2_ACCOUNTS + TZ3_ACCOUNTS
+    assert len(accounts) > HMAC_KEY_CACHE_SIZE
+
+    # The HMAC of tz2 and tz3 keys cannot be computed here: check
+    # that it does not change once the key has been cached
+    expected_hmacs = [
+        hmac.digest(
+            key=get_hmac_key(account),
+            msg=message,
+            digest=hashlib.sha256
+        ) if account.sig_scheme in {SigScheme.ED25519, SigScheme.BIP32_ED25519} else
+        client.hmac(account, message)
+        for account in accounts
+    ]
+
+    for _ in range(3):
+        for account, calculated_hmac in zip(accounts, expected_hmacs):
+            # The first HMAC may derive the key, the second one uses the cache
+            for _ in range(2):
+                data = client.hmac(account, message)
+                assert hmac.compare_digest(calculated_hmac, data), \
+                    f"Expected HMAC {calculated_hmac.hex()} but got {data.hex()}"
+
+
+@pytest.mark.parametrize("account", TZ1_ACCOUNTS)
+def test_hmac_batch(account: Account, client: TezosClient) -> None:
+    """Test the HMAC_BATCH instruction."""
+
+    messages = [bytes.fromhex(message_hex) for message_hex in HMAC_TEST_SET]
+
+    hmac_key = get_hmac_key(account)
+
+    data = client.hmac_batch(account, messages)
+    for message, mac in zip(messages, data):
+        calculated_hmac = hmac.digest(
+            key=hmac_key,
+            msg=message,
+            digest=hashlib.sha256
+        )
+        assert hmac.compare_digest(calculated_hmac, mac), \
+            f"Expected HMAC {calculated_hmac.hex()} but got {mac.hex()}"
+
+
+def test_hmac_batch_constraints(client: TezosClient) -> None:
+    """Check that empty and too large HMAC batches are refused."""
+
+    account = TZ1_ACCOUNTS[0]
+
+    with StatusCode.WRONG_LENGTH.expected():
+        client.hmac_batch(account, [])
+
+    with StatusCode.WRONG_LENGTH.expected():
+        client.hmac_batch(account, [bytes([index]) for index in range(8)])
@@ -0,0 +1,90 @@
+# Copyright 2024 Trilitech <contact@trili.tech>
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Module gathering the baking app load test.
+
+Only runs with --load-duration. Drives the app for that long with the
+requests of a Tenderbake baker, checking every answer and the high
+watermarks after every request.
+"""
+
+import time
+
+import pytest
+
+from utils.client import TezosClient, Hwm, StatusCode
+from utils.navigator import TezosNavigator
+from utils.schedule import HwmModel, TenderbakeSchedule
+from common import DEFAULT_ACCOUNT
+
+MAIN_CHAIN_ID = "NetXH12AexHqTQa"  # Chain = 1
+TEST_CHAIN_ID = "NetXH12Af5mrXhq"  # Chain = 2
+
+def test_load_tenderbake_schedule(pytestconfig,
+                                  client: TezosClient,
+                                  tezos_navigator: TezosNavigator) -> None:
+    """Replay a Tenderbake schedule and check the high watermarks after each request."""
+    duration = pytestconfig.getoption("load_duration")
+    if duration <= 0:
+        pytest.skip("The load test only runs with --load-duration")
+
+    account = DEFAULT_ACCOUNT
+    main_hwm = Hwm(0, 0)
+    test_hwm = Hwm(0, 0)
+    tezos_navigator.setup_app_context(
+        account,
+        MAIN_CHAIN_ID,
+        main_hwm=main_hwm,
+        test_hwm=test_hwm
+    )
+    models = {
+        MAIN_CHAIN_ID: HwmModel(main_hwm),
+        TEST_CHAIN_ID: HwmModel(test_hwm),
+    }
+    schedule = TenderbakeSchedule(
+        MAIN_CHAIN_ID,
+        TEST_CHAIN_ID,
+        seed=pytestconfig.getoption("load_seed"),
+        max_idle=pytestconfig.getoption("load_max_idle")
+    )
+
+    nb_signed = 0
+    nb_rejected = 0
+    deadline = time.monotonic() + duration
+    for step in schedule.steps():
+        if time.monotonic() >= deadline:
+            break
+        time.sleep(step.idle)
+
+        model = models[step.chain_id]
+        message = step.message
+        if model.is_authorized(step):
+            signature = client.sign_message(account, message)
+            account.check_signature(signature, bytes(message))
+            model.update(step)
+            nb_signed += 1
+        else:
+            with StatusCode.WRONG_VALUES.expected():
+                client.sign_message(account, message)
+            nb_rejected += 1
+
+        chain_id, main_hwm, test_hwm = client.get_all_hwm()
+        assert chain_id == MAIN_CHAIN_ID, \
+            f"After {step}: expected main chain {MAIN_CHAIN_ID} but got {chain_id}"
+        assert main_hwm == models[MAIN_CHAIN_ID].hwm, \
+            f"After {step}: expected main HWM {models[MAIN_CHAIN_ID].hwm} but got {main_hwm}"
+        assert test_hwm == models[TEST_CHAIN_ID].hwm, \
+            f"After {step}: expected test HWM {models[TEST_CHAIN_ID].hwm} but got {test_hwm}"
+
+    print(f"{nb_signed} requests signed, {nb_rejected} rejected")
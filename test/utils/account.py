@@ -195,6 +195,17 @@ class PublicKey:
 
         assert False, f"Wrong signature type: {sig_scheme}"
 
+def check_bls_signature(public_key: str,
+                        signature: str,
+                        message: bytes) -> None:
+    """Check that the signature is the BLS signature of the message by the public key."""
+    pk_raw = base58.b58decode_check(public_key.encode())[4:]
+    signature_raw = base58.b58decode_check(signature.encode())[4:]
+    assert bls.Verify(pk_raw, message, signature_raw), \
+        f"Fail to verify signature {signature}, \n\
+        with public key {public_key} \n\
+        and message {message.hex()}"
+
 class Account:
     """Class representing account."""
 
@@ -293,12 +304,7 @@ class Account:
         if isinstance(signature, bytes):
             signature = Signature.from_bytes(signature, self.sig_scheme)
         if isinstance(self.key, str):
-            pk_raw = base58.b58decode_check(self.public_key.encode())[4:]
-            signature_raw = base58.b58decode_check(signature.encode())[4:]
-            assert bls.Verify(pk_raw, message, signature_raw), \
-                f"Fail to verify signature {signature}, \n\
-                with account {self} \n\
-                and message {message.hex()}"
+            check_bls_signature(self.public_key, signature, message)
         else:
             assert self.key.verify(signature.encode(), message), \
                 f"Fail to verify signature {signature}, \n\
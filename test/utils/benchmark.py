@@ -0,0 +1,125 @@
+# Copyright 2024 Trilitech <contact@trili.tech>
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Module measuring and reporting the time taken by the instructions."""
+
+import json
+import math
+import time
+from pathlib import Path
+from typing import Any, Callable, Dict, List, Optional
+
+class Measure:
+    """Class representing the timings of an instruction."""
+
+    name: str
+    durations: List[float]
+
+    def __init__(self, name: str, durations: List[float]):
+        self.name = name
+        self.durations = sorted(durations)
+
+    def percentile(self, rank: float) -> float:
+        """Duration, in milliseconds, below which `rank` percent of the calls are."""
+        index = max(0, math.ceil(rank / 100 * len(self.durations)) - 1)
+        return self.durations[index] * 1000
+
+    @property
+    def ops_per_s(self) -> float:
+        """Number of calls per second."""
+        total = sum(self.durations)
+        return len(self.durations) / total if total > 0 else 0.0
+
+    def to_json(self) -> Dict[str, Any]:
+        """JSON representation of the measure."""
+        return {
+            "name": self.name,
+            "iterations": len(self.durations),
+            "p50_ms": round(self.percentile(50), 3),
+            "p95_ms": round(self.percentile(95), 3),
+            "p99_ms": round(self.percentile(99), 3),
+            "ops_per_s": round(self.ops_per_s, 3),
+        }
+
+class Benchmark:
+    """Class measuring instructions and comparing them to a baseline.
+
+    The report is a JSON object:
+      {"backend": ..., "firmware": ..., "results": [<measure>, ...]}
+
+    A measure is slower than the baseline when its p50 exceeds the p50
+    of the baseline by more than the tolerance.
+    """
+
+    iterations: int
+    tolerance: float
+    results: List[Measure]
+    baseline: Dict[str, Dict[str, Any]]
+
+    def __init__(self,
+                 iterations: int,
+                 tolerance: float = 0.2,
+                 baseline: Optional[Path] = None):
+        self.iterations = iterations
+        self.tolerance = tolerance
+        self.results = []
+        self.baseline = {}
+        if baseline is not None:
+            with open(baseline, encoding="utf-8") as file:
+                self.baseline = {
+                    result["name"]: result
+                    for result in json.load(file)["results"]
+                }
+
+    def run(self,
+            name: str,
+            call: Callable[[int], Any],
+            iterations: Optional[int] = None) -> Measure:
+        """Time `iterations` calls of `call`, given the index of the call.
+
+        Fails if the measure is slower than the baseline.
+        """
+        if iterations is None:
+            iterations = self.iterations
+        durations = []
+        for index in range(iterations):
+            start = time.perf_counter()
+            call(index)
+            durations.append(time.perf_counter() - start)
+
+        measure = Measure(name, durations)
+        self.results.append(measure)
+        self.check_baseline(measure)
+        return measure
+
+    def check_baseline(self, measure: Measure) -> None:
+        """Assert the measure is not slower than the baseline."""
+        if measure.name not in self.baseline:
+            return
+        expected = self.baseline[measure.name]["p50_ms"]
+        actual = measure.percentile(50)
+        assert actual <= expected * (1 + self.tolerance), \
+            f"{measure.name}: p50 of {actual:.3f} ms " \
+            f"exceeds the baseline of {expected:.3f} ms by more than {self.tolerance:.0%}"
+
+    def write(self, path: Path, backend: str, firmware: str) -> None:
+        """Write the JSON report."""
+        report = {
+            "backend": backend,
+            "firmware": firmware,
+            "results": [measure.to_json() for measure in self.results],
+        }
+        with open(path, "w", encoding="utf-8") as file:
+            json.dump(report, file, indent=2)
+            file.write("\n")
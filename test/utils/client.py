@@ -15,7 +15,7 @@
 
 """Module providing a tezos client."""
 
-from typing import Tuple, Optional, Generator
+from typing import List, Tuple, Optional, Generator, Union
 from enum import IntEnum
 from contextlib import contextmanager
 
@@ -118,6 +118,36 @@ class Hwm:
 
         return Hwm(highest_level, highest_round)
 
+class PerfCounter:
+    """Class representing the timers of a phase."""
+
+    min: int
+    max: int
+    sum: int
+    count: int
+
+    def __init__(self, min_: int, max_: int, sum_: int, count: int):
+        self.min = min_
+        self.max = max_
+        self.sum = sum_
+        self.count = count
+
+    def __repr__(self) -> str:
+        return f"(Min={self.min}, Max={self.max}, Sum={self.sum}, Count={self.count})"
+
+    @classmethod
+    def from_bytes(cls, raw_counter: bytes) -> 'PerfCounter':
+        """Create the timers of a phase from bytes."""
+
+        reader = BytesReader(raw_counter)
+        min_ = reader.read_int(4)
+        max_ = reader.read_int(4)
+        sum_ = reader.read_int(4)
+        count = reader.read_int(4)
+        reader.assert_finished()
+
+        return PerfCounter(min_, max_, sum_, count)
+
 class Cla(IntEnum):
     """Class representing APDU class."""
 
@@ -143,14 +173,44 @@ class Ins(IntEnum):
     RESET                     = 0x06
     SETUP                     = 0x0a
     SIGN_WITH_HASH            = 0x0f
+    SIGN_BATCH                = 0x10
+    QUERY_PERF                = 0x11
+    HMAC_BATCH                = 0x12
+    QUERY_CHAINS_HWM          = 0x13
+    SIGN_WITH_COMPANION       = 0x14
 
 
 class Index(IntEnum):
     """Class representing packet index."""
 
+    FIRST          = 0x00
+    OTHER          = 0x01
+    LAST           = 0x81
+    AUTHORIZED_KEY = 0x82
+
+
+class AuthorizeCommand(IntEnum):
+    """Class representing the AUTHORIZE_BAKING sub-commands."""
+
+    REPLACE   = 0x00
+    ADD       = 0x01
+    COMPANION = 0x02
+
+
+class AuthKeyCommand(IntEnum):
+    """Class representing the QUERY_AUTH_KEY_WITH_CURVE sub-commands."""
+
     FIRST = 0x00
-    OTHER = 0x01
-    LAST  = 0x81
+    ALL   = 0x01
+
+
+class PerfCommand(IntEnum):
+    """Class representing the QUERY_PERF sub-commands."""
+
+    QUERY     = 0x00
+    RESET     = 0x01
+    HISTOGRAM = 0x02
+    SIGNED    = 0x03
 
 
 class StatusCode(IntEnum):
@@ -200,7 +260,7 @@ class TezosClient:
 
     def _exchange(self,
                   ins: Ins,
-                  index: Index = Index.FIRST,
+                  index: Union[Index, AuthorizeCommand, AuthKeyCommand, PerfCommand] = Index.FIRST,
                   sig_scheme: SigScheme = SigScheme.DEFAULT,
                   payload: bytes = b'') -> bytes:
 
@@ -228,8 +288,11 @@ class TezosClient:
             f"Should end with by '\x00' but got {raw_commit.hex()}"
         return raw_commit[:-1].decode('utf-8')
 
-    def authorize_baking(self, account: Optional[Account]) -> bytes:
-        """Send the AUTHORIZE_BAKING instruction."""
+    def authorize_baking(self, account: Optional[Account], add: bool = False) -> bytes:
+        """Send the AUTHORIZE_BAKING instruction.
+
+        Add the key to the authorized keys instead of replacing them if `add` is set.
+        """
 
         sig_scheme=SigScheme.DEFAULT # None will raise EXC_WRONG_PARAM
         payload=b''
@@ -240,6 +303,7 @@ class TezosClient:
 
         data = self._exchange(
             ins=Ins.AUTHORIZE_BAKING,
+            index=AuthorizeCommand.ADD if add else AuthorizeCommand.REPLACE,
             sig_scheme=sig_scheme,
             payload=payload)
 
@@ -248,6 +312,19 @@ class TezosClient:
 
         return data
 
+    def register_companion(self, companion_path: BipPath) -> str:
+        """Send the AUTHORIZE_BAKING instruction to register the companion key."""
+        data = self._exchange(
+            ins=Ins.AUTHORIZE_BAKING,
+            index=AuthorizeCommand.COMPANION,
+            sig_scheme=SigScheme.BLS,
+            payload=bytes(companion_path))
+
+        length, data = data[0], data[1:]
+        assert length == len(data), f"Wrong data size, {length} != {len(data)}"
+
+        return PublicKey.from_bytes(data, SigScheme.BLS)
+
     def deauthorize(self) -> None:
         """Send the DEAUTHORIZE instruction."""
         data = self._exchange(ins=Ins.DEAUTHORIZE)
@@ -265,6 +342,21 @@ class TezosClient:
         sig_scheme = SigScheme(data[0])
         return sig_scheme, BipPath.from_bytes(data[1:])
 
+    def get_auth_keys_with_curve(self) -> List[Tuple[SigScheme, BipPath]]:
+        """Send the QUERY_AUTH_KEY_WITH_CURVE instruction to get all the authorized keys."""
+        raw_data = self._exchange(ins=Ins.QUERY_AUTH_KEY_WITH_CURVE, index=AuthKeyCommand.ALL)
+
+        reader = BytesReader(raw_data)
+        keys = []
+        for _ in range(reader.read_int(1)):
+            sig_scheme = SigScheme(reader.read_int(1))
+            length = reader.read_int(1)
+            raw_path = bytes([length]) + reader.read_bytes(4 * length)
+            keys.append((sig_scheme, BipPath.from_bytes(raw_path)))
+        reader.assert_finished()
+
+        return keys
+
     def get_public_key_silent(self, account: Account) -> str:
         """Send the GET_PUBLIC_KEY instruction."""
         data = self._exchange(
@@ -341,6 +433,79 @@ class TezosClient:
 
         return (main_chain_id, main_hwm, test_hwm)
 
+    def get_chains_hwm(self, key_index: int = 0) -> Tuple[str, Hwm, Hwm, List[Tuple[str, Hwm]]]:
+        """Send the QUERY_CHAINS_HWM instruction for the authorized key at `key_index`."""
+        rapdu: RAPDU = self.backend.exchange(Cla.DEFAULT,
+                                             Ins.QUERY_CHAINS_HWM,
+                                             p1=0,
+                                             p2=key_index)
+
+        if rapdu.status != StatusCode.OK:
+            raise ExceptionRAPDU(rapdu.status, rapdu.data)
+
+        reader = BytesReader(rapdu.data)
+        hwm_len = Hwm.raw_length(migrated=True)
+
+        main_chain_id = forge.unforge_chain_id(reader.read_bytes(4))
+        main_hwm = Hwm.from_bytes(reader.read_bytes(hwm_len))
+        test_hwm = Hwm.from_bytes(reader.read_bytes(hwm_len))
+
+        chains_hwm = []
+        for _ in range(reader.read_int(1)):
+            chain_id = forge.unforge_chain_id(reader.read_bytes(4))
+            chains_hwm.append((chain_id, Hwm.from_bytes(reader.read_bytes(hwm_len))))
+
+        reader.assert_finished()
+
+        return (main_chain_id, main_hwm, test_hwm, chains_hwm)
+
+    def query_perf(self) -> List[PerfCounter]:
+        """Send the QUERY_PERF instruction."""
+        raw_data = self._exchange(ins=Ins.QUERY_PERF, index=PerfCommand.QUERY)
+
+        reader = BytesReader(raw_data)
+        nb_phases = reader.read_int(1)
+        counters = [PerfCounter.from_bytes(reader.read_bytes(16)) for _ in range(nb_phases)]
+        reader.assert_finished()
+
+        return counters
+
+    def query_perf_histogram(self, ins: int) -> List[int]:
+        """Send the QUERY_PERF instruction to get the latency histogram of an instruction."""
+        rapdu: RAPDU = self.backend.exchange(Cla.DEFAULT,
+                                             Ins.QUERY_PERF,
+                                             p1=PerfCommand.HISTOGRAM,
+                                             p2=ins)
+
+        if rapdu.status != StatusCode.OK:
+            raise ExceptionRAPDU(rapdu.status, rapdu.data)
+
+        reader = BytesReader(rapdu.data)
+        nb_buckets = reader.read_int(1)
+        histogram = [reader.read_int(2) for _ in range(nb_buckets)]
+        reader.assert_finished()
+
+        return histogram
+
+    def query_perf_signed(self) -> List[int]:
+        """Send the QUERY_PERF instruction to get the number of signed baking messages.
+
+        The counts are of blocks, preattestations, attestations and
+        attestations with DAL content.
+        """
+        raw_data = self._exchange(ins=Ins.QUERY_PERF, index=PerfCommand.SIGNED)
+
+        reader = BytesReader(raw_data)
+        nb_kinds = reader.read_int(1)
+        counts = [reader.read_int(4) for _ in range(nb_kinds)]
+        reader.assert_finished()
+
+        return counts
+
+    def reset_perf(self) -> None:
+        """Send the QUERY_PERF instruction to reset the timers, histograms and counts."""
+        self._exchange(ins=Ins.QUERY_PERF, index=PerfCommand.RESET)
+
     def sign_message(self,
                      account: Account,
                      message: Message) -> str:
@@ -358,6 +523,85 @@ class TezosClient:
 
         return Signature.from_bytes(signature, account.sig_scheme)
 
+    def sign_last_packet(self,
+                         account: Account,
+                         message: Message) -> str:
+        """Send the last packet of the SIGN instruction, without the key path."""
+
+        signature = self._exchange(
+            ins=Ins.SIGN,
+            index=Index.LAST,
+            payload=bytes(message))
+
+        return Signature.from_bytes(signature, account.sig_scheme)
+
+    def sign_message_in_packets(self,
+                                account: Account,
+                                message: Message,
+                                packet_sizes: List[int]) -> str:
+        """Send the SIGN instruction with the message split in several packets.
+
+        The last packet holds the rest of the message.
+        """
+
+        self._exchange(
+            ins=Ins.SIGN,
+            sig_scheme=account.sig_scheme,
+            payload=bytes(account.path))
+
+        raw_message = bytes(message)
+        for packet_size in packet_sizes:
+            self._exchange(
+                ins=Ins.SIGN,
+                index=Index.OTHER,
+                payload=raw_message[:packet_size])
+            raw_message = raw_message[packet_size:]
+
+        signature = self._exchange(
+            ins=Ins.SIGN,
+            index=Index.LAST,
+            payload=raw_message)
+
+        return Signature.from_bytes(signature, account.sig_scheme)
+
+    def sign_message_in_packets_with_hash(
+            self,
+            account: Account,
+            message: Message,
+            packet_sizes: List[int],
+            first_ins: Ins = Ins.SIGN_WITH_HASH) -> Tuple[bytes, str]:
+        """Send the SIGN_WITH_HASH instruction with the message split in several packets.
+
+        The last packet holds the rest of the message. The packets
+        before it are sent with `first_ins`.
+        """
+
+        self._exchange(
+            ins=first_ins,
+            sig_scheme=account.sig_scheme,
+            payload=bytes(account.path))
+
+        raw_message = bytes(message)
+        for packet_size in packet_sizes:
+            self._exchange(
+                ins=first_ins,
+                index=Index.OTHER,
+                payload=raw_message[:packet_size])
+            raw_message = raw_message[packet_size:]
+
+        data = self._exchange(
+            ins=Ins.SIGN_WITH_HASH,
+            index=Index.LAST,
+            payload=raw_message)
+
+        return (
+            data[:Message.HASH_SIZE],
+            Signature.from_bytes(
+                data[Message.HASH_SIZE:],
+                account.sig_scheme
+            )
+        )
+
     def sign_message_with_hash(self,
                      account: Account,
                      message: Message) -> Tuple[bytes, str]:
@@ -381,6 +625,83 @@ class TezosClient:
             )
         )
 
+    def sign_message_with_authorized_key(self,
+                                         account: Account,
+                                         message: Message) -> str:
+        """Send the SIGN instruction with the authorized key."""
+
+        signature = self._exchange(
+            ins=Ins.SIGN,
+            index=Index.AUTHORIZED_KEY,
+            payload=bytes(message))
+
+        return Signature.from_bytes(signature, account.sig_scheme)
+
+    def sign_message_with_hash_with_authorized_key(self,
+                                                   account: Account,
+                                                   message: Message) -> Tuple[bytes, str]:
+        """Send the SIGN_WITH_HASH instruction with the authorized key."""
+
+        data = self._exchange(
+            ins=Ins.SIGN_WITH_HASH,
+            index=Index.AUTHORIZED_KEY,
+            payload=bytes(message))
+
+        return (
+            data[:Message.HASH_SIZE],
+            Signature.from_bytes(
+                data[Message.HASH_SIZE:],
+                account.sig_scheme
+            )
+        )
+
+    def sign_batch(self,
+                   account: Account,
+                   messages: List[Message]) -> List[str]:
+        """Send the SIGN_BATCH instruction."""
+
+        data: bytes = b''
+        for message in messages:
+            raw_message = bytes(message)
+            data += len(raw_message).to_bytes(1, 'big')
+            data += raw_message
+
+        raw_signatures = self._exchange(
+            ins=Ins.SIGN_BATCH,
+            payload=data)
+
+        reader = BytesReader(raw_signatures)
+        signatures = []
+        for _ in messages:
+            signature_len = reader.read_int(1)
+            signatures.append(
+                Signature.from_bytes(reader.read_bytes(signature_len), account.sig_scheme))
+        reader.assert_finished()
+
+        return signatures
+
+    def sign_with_companion(self,
+                            companion_path: BipPath,
+                            message: Message) -> Tuple[str, str]:
+        """Send the SIGN_WITH_COMPANION instruction.
+
+        Return the signature of the authorized key and the one of the companion key.
+        """
+
+        raw_signatures = self._exchange(
+            ins=Ins.SIGN_WITH_COMPANION,
+            payload=bytes(companion_path) + bytes(message))
+
+        reader = BytesReader(raw_signatures)
+        signatures = []
+        for _ in range(2):
+            signature_len = reader.read_int(1)
+            signatures.append(
+                Signature.from_bytes(reader.read_bytes(signature_len), SigScheme.BLS))
+        reader.assert_finished()
+
+        return (signatures[0], signatures[1])
+
     def hmac(self,
              account: Account,
              message: bytes) -> bytes:
@@ -394,3 +715,25 @@ class TezosClient:
             ins=Ins.HMAC,
             sig_scheme=account.sig_scheme,
             payload=data)
+
+    def hmac_batch(self,
+                   account: Account,
+                   messages: List[bytes]) -> List[bytes]:
+        """Send the HMAC_BATCH instruction."""
+
+        data: bytes = b''
+        data += bytes(account.path)
+        for message in messages:
+            data += len(message).to_bytes(1, 'big')
+            data += message
+
+        raw_hmacs = self._exchange(
+            ins=Ins.HMAC_BATCH,
+            sig_scheme=account.sig_scheme,
+            payload=data)
+
+        reader = BytesReader(raw_hmacs)
+        hmacs = [reader.read_bytes(32) for _ in messages]
+        reader.assert_finished()
+
+        return hmacs
@@ -26,9 +26,11 @@ from pytezos.crypto.encoding import base58_encodings
 from pytezos.crypto.key import blake2b_32
 from pytezos.michelson.forge import (
     forge_address,
+    forge_array,
     forge_base58,
     forge_int16,
     forge_int32,
+    forge_micheline,
     forge_nat,
     # forge_public_key, # overrode until BLS key included
 )
@@ -99,6 +101,15 @@ class OperationTag(IntEnum):
     PREATTESTATION       = 20
     ATTESTATION          = 21
     ATTESTATION_WITH_DAL = 23
+    UPDATE_CONSENSUS_KEY = 114
+
+class StakingEntrypoint(IntEnum):
+    """Class representing the tags of the staking entrypoints."""
+
+    STAKE                   = 6
+    UNSTAKE                 = 7
+    FINALIZE_UNSTAKE        = 8
+    SET_DELEGATE_PARAMETERS = 9
 
 Micheline = Union[List, Dict]
 
@@ -206,6 +217,35 @@ class OperationForge:
         res += forge_public_key(content['public_key'])
         return res
 
+    @staticmethod
+    def manager_header(tag: int, content: Dict[str, Any]) -> bytes:
+        """Forge the tag and the common fields of a tezos manager operation."""
+        res = forge_tag(tag)
+        res += forge_address(content['source'], tz_only=True)
+        res += forge_nat(int(content['fee']))
+        res += forge_nat(int(content['counter']))
+        res += forge_nat(int(content['gas_limit']))
+        res += forge_nat(int(content['storage_limit']))
+        return res
+
+    @staticmethod
+    def update_consensus_key(content: Dict[str, Any]) -> bytes:
+        """Forge a tezos consensus key update."""
+        res = OperationForge.manager_header(OperationTag.UPDATE_CONSENSUS_KEY, content)
+        res += forge_public_key(content['pk'])
+        return res
+
+    @staticmethod
+    def staking(content: Dict[str, Any]) -> bytes:
+        """Forge a tezos staking operation, with its entrypoint as a tag."""
+        res = OperationForge.manager_header(OperationTag.BABYLON_TRANSACTION, content)
+        res += forge_nat(int(content['amount']))
+        res += forge_address(content['destination'])
+        res += b'\xff'  # parameters present
+        res += forge_int_fixed(StakingEntrypoint[content['entrypoint'].upper()], 1)
+        res += forge_array(forge_micheline(content['value']))
+        return res
+
     @staticmethod
     def preattestation(content: Dict[str, Any]) -> bytes:
         """Forge a tezos preattestation."""
@@ -378,6 +418,76 @@ class Transaction(ManagerOperation):
             )
         )
 
+class UpdateConsensusKey(ManagerOperation):
+    """Class representing a tezos consensus key update."""
+
+    public_key: str
+
+    def __init__(self,
+                 public_key: str = Default.ED25519_PUBLIC_KEY,
+                 *args, **kwargs):
+        self.public_key = public_key
+        ManagerOperation.__init__(self, *args, **kwargs)
+
+    def forge(self) -> bytes:
+        return OperationForge.update_consensus_key(
+            {
+                'source': self.source,
+                'fee': self.fee,
+                'counter': self.counter,
+                'gas_limit': self.gas_limit,
+                'storage_limit': self.storage_limit,
+                'pk': self.public_key,
+            }
+        )
+
+class Staking(ManagerOperation):
+    """Class representing a tezos staking operation.
+
+    A transaction from the source to itself calling a staking entrypoint:
+    stake, unstake, finalize_unstake or set_delegate_parameters.
+    """
+
+    entrypoint: str
+    amount: int
+    parameter: Micheline
+
+    def __init__(self,
+                 entrypoint: str = 'stake',
+                 amount: int = 0,
+                 parameter: Micheline = Default.Micheline.VALUE,
+                 *args, **kwargs):
+        self.entrypoint = entrypoint
+        self.amount = amount
+        self.parameter = parameter
+        ManagerOperation.__init__(self, *args, **kwargs)
+
+    @staticmethod
+    def delegate_parameters(staking_limit: int, staking_edge: int) -> Micheline:
+        """Parameters of set_delegate_parameters, in millionth and billionth."""
+        return {
+            'prim': 'Pair',
+            'args': [
+                {'int': str(staking_limit)},
+                {'prim': 'Pair', 'args': [{'int': str(staking_edge)}, {'prim': 'Unit'}]},
+            ]
+        }
+
+    def forge(self) -> bytes:
+        return OperationForge.staking(
+            {
+                'source': self.source,
+                'fee': self.fee,
+                'counter': self.counter,
+                'gas_limit': self.gas_limit,
+                'storage_limit': self.storage_limit,
+                'amount': self.amount,
+                'destination': self.source,
+                'entrypoint': self.entrypoint,
+                'value': self.parameter,
+            }
+        )
+
 class Preattestation(Operation):
     """Class representing a tezos preattestation."""
 
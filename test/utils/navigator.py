@@ -45,8 +45,8 @@ from ragger.navigator import Navigator, NavInsID, NavIns
 
 from common import TESTS_ROOT_DIR, EMPTY_PATH
 from utils.client import TezosClient, Hwm
-from utils.account import Account
-from utils.message import Delegation
+from utils.account import Account, BipPath
+from utils.message import Delegation, ManagerOperation
 
 RESPONSE = TypeVar('RESPONSE')
 
@@ -394,12 +394,25 @@ class TezosNavigator(metaclass=MetaScreen):
     def authorize_baking(self,
                          account: Optional[Account],
                          navigate: Optional[Callable] = None,
+                         add: bool = False,
                          **kwargs) -> bytes:
         """Send an authorize baking request and navigate until accept"""
         if navigate is None:
             navigate = self.accept_key_navigate
         return send_and_navigate(
-            send=lambda: self.client.authorize_baking(account),
+            send=lambda: self.client.authorize_baking(account, add=add),
+            navigate=lambda: navigate(**kwargs)
+        )
+
+    def register_companion(self,
+                           companion_path: BipPath,
+                           navigate: Optional[Callable] = None,
+                           **kwargs) -> str:
+        """Send a companion key registration request and navigate until accept"""
+        if navigate is None:
+            navigate = self.accept_key_navigate
+        return send_and_navigate(
+            send=lambda: self.client.register_companion(companion_path),
             navigate=lambda: navigate(**kwargs)
         )
 
@@ -539,6 +552,22 @@ class TezosNavigator(metaclass=MetaScreen):
             navigate=lambda: navigate(**kwargs)
         )
 
+    def sign_manager_operation(self,
+                               account: Account,
+                               operation: ManagerOperation,
+                               navigate: Optional[Callable] = None,
+                               **kwargs) -> str:
+        """Send a sign request on a manager operation and navigate until accept"""
+        if navigate is None:
+            navigate = self.accept_sign_navigate
+        return send_and_navigate(
+            send=lambda: self.client.sign_message(
+                account,
+                operation
+            ),
+            navigate=lambda: navigate(**kwargs)
+        )
+
     def right(self):
         """Move to right screen"""
         self.backend.right_click()
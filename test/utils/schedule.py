@@ -0,0 +1,200 @@
+# Copyright 2024 Trilitech <contact@trili.tech>
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Module generating the signing requests of a Tenderbake baker."""
+
+import random
+from enum import Enum
+from typing import Iterator
+
+from utils.client import Hwm
+from utils.message import (
+    Message,
+    Preattestation,
+    Attestation,
+    Fitness,
+    BlockHeader,
+    Block,
+)
+
+class Kind(str, Enum):
+    """Class representing the kind of a baking message."""
+
+    BLOCK            = "block"
+    PREATTESTATION   = "preattestation"
+    ATTESTATION      = "attestation"
+    ATTESTATION_DAL  = "attestation_dal"
+
+    def __str__(self) -> str:
+        return self.value
+
+class Step:
+    """Class representing a signing request of the schedule."""
+
+    chain_id: str
+    kind: Kind
+    level: int
+    round: int
+    idle: float
+
+    def __init__(self,
+                 chain_id: str,
+                 kind: Kind,
+                 level: int,
+                 round_: int,
+                 idle: float = 0.0):
+        self.chain_id = chain_id
+        self.kind = kind
+        self.level = level
+        self.round = round_
+        self.idle = idle
+
+    def __repr__(self) -> str:
+        return f"{self.kind}(chain={self.chain_id}, level={self.level}, round={self.round})"
+
+    @property
+    def message(self) -> Message:
+        """Message to sign."""
+        if self.kind == Kind.BLOCK:
+            return Block(
+                header=BlockHeader(
+                    level=self.level,
+                    fitness=Fitness(level=self.level, current_round=self.round)
+                ),
+                chain_id=self.chain_id
+            )
+        if self.kind == Kind.PREATTESTATION:
+            return Preattestation(
+                op_level=self.level,
+                op_round=self.round,
+                chain_id=self.chain_id
+            )
+        return Attestation(
+            op_level=self.level,
+            op_round=self.round,
+            dal_attestation=0 if self.kind == Kind.ATTESTATION_DAL else None,
+            chain_id=self.chain_id
+        )
+
+class HwmModel:
+    """Class mirroring the high watermark of a chain as the app handles it.
+
+    See `doc/signing.md#checks`.
+    """
+
+    level: int
+    round: int
+    had_preattestation: bool
+    had_attestation: bool
+
+    def __init__(self, hwm: Hwm):
+        self.level = hwm.highest_level
+        self.round = hwm.highest_round
+        self.had_preattestation = False
+        self.had_attestation = False
+
+    @property
+    def hwm(self) -> Hwm:
+        """High watermark as the app returns it."""
+        return Hwm(self.level, self.round)
+
+    def is_authorized(self, step: Step) -> bool:
+        """Whether the app signs the request."""
+        if step.level > self.level:
+            return True
+        if step.level < self.level:
+            return False
+        if step.round != self.round:
+            return step.round > self.round
+        if step.kind == Kind.PREATTESTATION:
+            return not (self.had_preattestation or self.had_attestation)
+        if step.kind in (Kind.ATTESTATION, Kind.ATTESTATION_DAL):
+            return not self.had_attestation
+        return False
+
+    def update(self, step: Step) -> None:
+        """Record a signed request."""
+        if step.level > self.level or step.round > self.round:
+            self.had_preattestation = False
+            self.had_attestation = False
+        self.level = max(self.level, step.level)
+        self.round = step.round
+        self.had_preattestation |= step.kind == Kind.PREATTESTATION
+        self.had_attestation |= step.kind in (Kind.ATTESTATION, Kind.ATTESTATION_DAL)
+
+class TenderbakeSchedule:
+    """Class generating the requests a baker sends, level after level.
+
+    At each level, the baker preattests then attests the block of each
+    round, and sometimes proposes it. A round is sometimes missed, which
+    bumps the round of the level. Some attestations carry a DAL content,
+    some requests are sent twice, as a baker retrying would do, and some
+    requests of a test chain are mixed in. The baker is sometimes idle
+    before a request.
+    """
+
+    rng: random.Random
+    main_chain_id: str
+    test_chain_id: str
+    max_idle: float
+
+    ROUND_BUMP_RATE = 0.05
+    PROPOSAL_RATE   = 0.3
+    DAL_RATE        = 0.2
+    RETRY_RATE      = 0.02
+    TEST_CHAIN_RATE = 0.1
+    IDLE_RATE       = 0.01
+
+    def __init__(self,
+                 main_chain_id: str,
+                 test_chain_id: str,
+                 seed: int = 0,
+                 max_idle: float = 0.0):
+        self.rng = random.Random(seed)
+        self.main_chain_id = main_chain_id
+        self.test_chain_id = test_chain_id
+        self.max_idle = max_idle
+
+    def _idle(self) -> float:
+        if self.max_idle > 0 and self.rng.random() < self.IDLE_RATE:
+            return self.rng.uniform(0, self.max_idle)
+        return 0.0
+
+    def _round(self, chain_id: str, level: int, round_: int) -> Iterator[Step]:
+        kinds = [Kind.PREATTESTATION]
+        kinds.append(Kind.ATTESTATION_DAL if self.rng.random() < self.DAL_RATE
+                     else Kind.ATTESTATION)
+        if self.rng.random() < self.PROPOSAL_RATE:
+            kinds.insert(0, Kind.BLOCK)
+
+        for kind in kinds:
+            yield Step(chain_id, kind, level, round_, self._idle())
+            if self.rng.random() < self.RETRY_RATE:
+                yield Step(chain_id, kind, level, round_)
+
+    def steps(self, first_level: int = 1) -> Iterator[Step]:
+        """Infinite sequence of requests, starting at `first_level`."""
+        level = first_level
+        test_level = first_level
+        while True:
+            round_ = 0
+            while True:
+                yield from self._round(self.main_chain_id, level, round_)
+                if self.rng.random() >= self.ROUND_BUMP_RATE:
+                    break
+                round_ += 1
+            if self.rng.random() < self.TEST_CHAIN_RATE:
+                yield from self._round(self.test_chain_id, test_level, 0)
+                test_level += 1
+            level += 1
@@ -0,0 +1,321 @@
+/* Tezos Ledger application - Host microbenchmarks
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+/*
+ * Times the parsing and HWM logic of the app on the host.
+ *
+ * Prints one JSON object per line:
+ *   {"name": ..., "value": ..., "unit": ..., "iterations": ...}
+ *
+ * Usage: bench [iterations]
+ */
+
+#include "baking_auth.h"
+#include "globals.h"
+#include "operations.h"
+#include "to_string.h"
+#include "write.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_ITERATIONS 200000u
+
+#define CONSENSUS_OPERATION_SIZE 79u
+#define BLOCK_SIZE               (4u + 4u + 1u + 32u + 8u + 1u + 32u + 4u + 33u)
+#define OPERATION_MAX_SIZE       1024u
+#define NB_REVEALS               8u
+
+/// Keeps the results alive so that the calls are not optimized out
+static volatile uint32_t sink;
+
+static bip32_path_with_curve_t const SIGNING_KEY = {
+    .bip32_path = {.length = 4u,
+                   .components = {0x8000002Cu, 0x800006C1u, 0x80000000u, 0x80000000u}},
+    .derivation_type = DERIVATION_TYPE_ED25519};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000u) + (uint64_t) ts.tv_nsec;
+}
+
+static void report(char const *name,
+                   uint64_t elapsed_ns,
+                   double units,
+                   char const *unit,
+                   size_t iterations) {
+    printf("{\"name\": \"%s\", \"value\": %.3f, \"unit\": \"%s\", \"iterations\": %zu}\n",
+           name,
+           (double) elapsed_ns / units,
+           unit,
+           iterations);
+}
+
+static void fail(char const *name) {
+    fprintf(stderr, "%s: unexpected parsing result\n", name);
+    exit(EXIT_FAILURE);
+}
+
+/***** Messages *****/
+
+static size_t build_consensus_operation(uint8_t *out, uint32_t level, uint32_t round) {
+    size_t offset = 0;
+
+    memset(out, 0, CONSENSUS_OPERATION_SIZE);
+    write_u32_be(out, offset, 0x7A06A770u);  // chain id
+    offset += 4u + 32u;                      // branch
+    out[offset] = 0x15u;                     // tag
+    offset += 1u + 2u;                       // slot
+    write_u32_be(out, offset, level);
+    offset += 4u;
+    write_u32_be(out, offset, round);
+    offset += 4u + 32u;  // block payload hash
+
+    return offset;
+}
+
+static size_t build_block(uint8_t *out, uint32_t level, uint32_t round) {
+    size_t offset = 0;
+
+    memset(out, 0, BLOCK_SIZE);
+    write_u32_be(out, offset, 0x7A06A770u);  // chain id
+    offset += 4u;
+    write_u32_be(out, offset, level);
+    offset += 4u + 1u + 32u + 8u + 1u + 32u;  // proto, predecessor, timestamp, pass, hash
+    // Fitness, without locked round
+    write_u32_be(out, offset, 33u);
+    offset += 4u;
+    write_u32_be(out, offset, 1u);
+    offset += 4u;
+    out[offset] = 2u;  // tag
+    offset += 1u;
+    write_u32_be(out, offset, 4u);
+    offset += 4u;
+    write_u32_be(out, offset, level);
+    offset += 4u;
+    write_u32_be(out, offset, 0u);  // locked round
+    offset += 4u;
+    write_u32_be(out, offset, 4u);
+    offset += 4u + 4u;  // predecessor round
+    write_u32_be(out, offset, 4u);
+    offset += 4u;
+    write_u32_be(out, offset, round);
+    offset += 4u;
+
+    return offset;
+}
+
+static size_t write_z(uint8_t *out, uint64_t value) {
+    size_t len = 0;
+    do {
+        out[len] = (uint8_t) (value & 0x7Fu);
+        value >>= 7u;
+        if (value != 0u) {
+            out[len] |= 0x80u;
+        }
+        len++;
+    } while (value != 0u);
+    return len;
+}
+
+static size_t build_manager_header(uint8_t *out, uint8_t tag, uint8_t const pkh[KEY_HASH_SIZE]) {
+    size_t offset = 0;
+
+    out[offset] = tag;
+    offset++;
+    out[offset] = (uint8_t) SIGNATURE_TYPE_ED25519;
+    offset++;
+    memcpy(out + offset, pkh, KEY_HASH_SIZE);
+    offset += KEY_HASH_SIZE;
+    offset += write_z(out + offset, 374u);     // fee
+    offset += write_z(out + offset, 123456u);  // counter
+    offset += write_z(out + offset, 1100u);    // gas limit
+    offset += write_z(out + offset, 0u);       // storage limit
+
+    return offset;
+}
+
+/**
+ * Reveals followed by a self-delegation, signed by SIGNING_KEY
+ */
+static size_t build_operation(uint8_t *out) {
+    uint8_t pkh[KEY_HASH_SIZE];
+    tz_ecfp_compressed_public_key_t pk = {0};
+    size_t offset = 0;
+
+    if (generate_public_key_hash(pkh,
+                                 sizeof(pkh),
+                                 (cx_ecfp_compressed_public_key_t *) &pk,
+                                 &SIGNING_KEY) != CX_OK) {
+        fail("build_operation");
+    }
+
+    memset(out, 0x42, 32u);  // branch
+    offset += 32u;
+
+    for (size_t i = 0; i < NB_REVEALS; i++) {
+        offset += build_manager_header(out + offset, (uint8_t) OPERATION_TAG_REVEAL, pkh);
+        out[offset] = (uint8_t) SIGNATURE_TYPE_ED25519;
+        offset++;
+        memcpy(out + offset, pk.pk_ed25519.W, TZ_EDPK_LEN);
+        offset += TZ_EDPK_LEN;
+    }
+
+    offset += build_manager_header(out + offset, (uint8_t) OPERATION_TAG_DELEGATION, pkh);
+    out[offset] = 0xFFu;  // delegate present
+    offset++;
+    out[offset] = (uint8_t) SIGNATURE_TYPE_ED25519;
+    offset++;
+    memcpy(out + offset, pkh, KEY_HASH_SIZE);
+    offset += KEY_HASH_SIZE;
+
+    return offset;
+}
+
+/***** Benchmarks *****/
+
+static void bench_parse_operations(size_t iterations) {
+    uint8_t operation[OPERATION_MAX_SIZE];
+    size_t const size = build_operation(operation);
+    struct parsed_operation_group out;
+
+    uint64_t const start = now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        buffer_t buf = {.ptr = operation, .size = size, .offset = 0};
+        if ((parse_operations_init(&out, &SIGNING_KEY, &global.apdu.u.sign.parse_state) !=
+             SW_OK) ||
+            (parse_operations(&buf, &out) != SW_OK) ||
+            !parse_operations_final(&global.apdu.u.sign.parse_state, &out)) {
+            fail("parse_operations");
+        }
+        sink += (uint32_t) out.total_fee;
+    }
+    uint64_t const elapsed = now_ns() - start;
+
+    report("parse_operations", elapsed, (double) iterations * (double) size, "ns/byte", iterations);
+}
+
+static void bench_parse_block(size_t iterations) {
+    uint8_t block[BLOCK_SIZE];
+    size_t const size = build_block(block, 42u, 1u);
+    parsed_baking_data_t out;
+
+    uint64_t const start = now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        buffer_t buf = {.ptr = block, .size = size, .offset = 0};
+        if (!parse_block(&buf, &out)) {
+            fail("parse_block");
+        }
+        sink += out.level;
+    }
+    uint64_t const elapsed = now_ns() - start;
+
+    report("parse_block", elapsed, (double) iterations, "ns/op", iterations);
+}
+
+static void bench_parse_consensus_operation(size_t iterations) {
+    uint8_t operation[CONSENSUS_OPERATION_SIZE];
+    size_t const size = build_consensus_operation(operation, 42u, 1u);
+    parsed_baking_data_t out;
+
+    uint64_t const start = now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        buffer_t buf = {.ptr = operation, .size = size, .offset = 0};
+        if (!parse_consensus_operation(&buf, &out, true)) {
+            fail("parse_consensus_operation");
+        }
+        sink += out.level;
+    }
+    uint64_t const elapsed = now_ns() - start;
+
+    report("parse_consensus_operation", elapsed, (double) iterations, "ns/op", iterations);
+}
+
+static void bench_guard_baking_authorized(size_t iterations) {
+    parsed_baking_data_t data = {.chain_id = {.v = 0x7A06A770u},
+                                 .level = 42u,
+                                 .round = 1u,
+                                 .type = BAKING_TYPE_ATTESTATION,
+                                 .is_tenderbake = true};
+
+    memcpy(&g_baking_key.key, &SIGNING_KEY, sizeof(g_baking_key.key));
+    g_baking_key.hwm.main.highest_level = 42u;
+    g_baking_key.hwm.main.highest_round = 0u;
+
+    uint64_t const start = now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        if (guard_baking_authorized(&data, &SIGNING_KEY) != SW_OK) {
+            fail("guard_baking_authorized");
+        }
+        sink += data.level;
+    }
+    uint64_t const elapsed = now_ns() - start;
+
+    report("guard_baking_authorized", elapsed, (double) iterations, "ns/op", iterations);
+}
+
+static void bench_microtez_to_string(size_t iterations) {
+    char str[32];
+
+    uint64_t const start = now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        sink += (uint32_t) microtez_to_string(str, sizeof(str), 1234567890123u + i);
+    }
+    uint64_t const elapsed = now_ns() - start;
+
+    report("microtez_to_string", elapsed, (double) iterations, "ns/call", iterations);
+}
+
+static void bench_pkh_to_string(size_t iterations) {
+    uint8_t pkh[KEY_HASH_SIZE] = {0};
+    char str[40];
+
+    uint64_t const start = now_ns();
+    for (size_t i = 0; i < iterations; i++) {
+        pkh[0] = (uint8_t) i;
+        sink += (uint32_t) pkh_to_string(str, sizeof(str), SIGNATURE_TYPE_ED25519, pkh);
+    }
+    uint64_t const elapsed = now_ns() - start;
+
+    report("pkh_to_string", elapsed, (double) iterations, "ns/call", iterations);
+}
+
+int main(int argc, char *argv[]) {
+    size_t iterations = DEFAULT_ITERATIONS;
+
+    if (argc > 1) {
+        iterations = strtoul(argv[1], NULL, 10);
+        if (iterations == 0u) {
+            fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    memset(&global, 0, sizeof(global));
+
+    bench_parse_operations(iterations / 10u + 1u);
+    bench_parse_block(iterations);
+    bench_parse_consensus_operation(iterations);
+    bench_guard_baking_authorized(iterations);
+    bench_microtez_to_string(iterations);
+    bench_pkh_to_string(iterations / 10u + 1u);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,113 @@
+# Copyright 2024 Trilitech <contact@trili.tech>
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Generates the known answers of the BLS hash to field of the app.
+
+The reference follows RFC 9380 and is first checked against the
+expand_message_xmd test vectors of its appendix K.1.
+"""
+
+import argparse
+import hashlib
+from pathlib import Path
+from typing import List, Tuple
+
+# Modulus of the base field of BLS12-381
+FIELD_MODULUS = int(
+    "1a0111ea397fe69a4b1ba7b6434bacd764774b84f38512bf"
+    "6730d2a0f6b0f6241eabfffeb153ffffb9feffffffffaaab", 16)
+
+# Cipher suite used by tezos to sign with tz4 keys
+TEZOS_DST = b"BLS_SIG_BLS12381G2_XMD:SHA-256_SSWU_RO_AUG_"
+
+# RFC 9380, appendix K.1: expand_message_xmd(SHA-256)
+RFC_DST = b"QUUX-V01-CS02-with-expander-SHA256-128"
+RFC_VECTORS: List[Tuple[bytes, int, str]] = [
+    (b"", 0x20,
+     "68a985b87eb6b46952128911f2a4412bbc302a9d759667f87f7a21d803f07235"),
+    (b"abc", 0x20,
+     "d8ccab23b5985ccea865c6c97b6e5b8350e794e603b4b97902f53a8a0d605615"),
+    (b"abcdef0123456789", 0x20,
+     "eff31487c770a893cfb36f912fbfcbff40d5661771ca4b2cb4eafe524333f5c1"),
+    (b"q128_" + b"q" * 128, 0x20,
+     "b23a1d2b4d97b2ef7785562a7e8bac7eed54ed6e97e29aa51bfe3f12ddad1ff9"),
+    (b"a512_" + b"a" * 512, 0x20,
+     "4623227bcc01293b8c130bf771da8c298dede7383243dc0993d2d94823958c4c"),
+    (b"", 0x80,
+     "af84c27ccfd45d41914fdff5df25293e221afc53d8ad2ac06d5e3e29485dadbe"
+     "e0d121587713a3e0dd4d5e69e93eb7cd4f5df4cd103e188cf60cb02edc3edf18"
+     "eda8576c412b18ffb658e3dd6ec849469b979d444cf7b26911a08e63cf31f9dc"
+     "c541708d3491184472c2c29bb749d4286b004ceb5ee6b9a7fa5b646c993f0ced"),
+]
+
+# Lengths of the messages: around the SHA-256 blocks and the APDU payloads
+MESSAGE_LENGTHS = [0, 1, 31, 32, 55, 56, 63, 64, 65, 119, 120, 200, 235, 236, 470, 1000, 4096]
+
+
+def expand_message_xmd(msg: bytes, dst: bytes, len_in_bytes: int) -> bytes:
+    """expand_message_xmd with SHA-256, RFC 9380 section 5.3.1."""
+    ell = (len_in_bytes + 31) // 32
+    assert ell <= 255 and len(dst) <= 255
+    dst_prime = dst + bytes([len(dst)])
+    b_0 = hashlib.sha256(
+        bytes(64) + msg + len_in_bytes.to_bytes(2, "big") + b"\x00" + dst_prime).digest()
+    b_i = hashlib.sha256(b_0 + b"\x01" + dst_prime).digest()
+    uniform_bytes = b_i
+    for i in range(2, ell + 1):
+        b_i = hashlib.sha256(
+            bytes(x ^ y for x, y in zip(b_0, b_i)) + bytes([i]) + dst_prime).digest()
+        uniform_bytes += b_i
+    return uniform_bytes[:len_in_bytes]
+
+
+def hash_to_field(msg: bytes, dst: bytes) -> bytes:
+    """hash_to_field of 2 elements of Fp2, RFC 9380 section 5.2, big endian."""
+    uniform_bytes = expand_message_xmd(msg, dst, 4 * 64)
+    elements = [int.from_bytes(uniform_bytes[64 * i:64 * (i + 1)], "big") % FIELD_MODULUS
+                for i in range(4)]
+    return b"".join(element.to_bytes(48, "big") for element in elements)
+
+
+def pseudo_random_bytes(seed: bytes, length: int) -> bytes:
+    """Deterministic bytes, so that the vectors do not change."""
+    out = b""
+    counter = 0
+    while len(out) < length:
+        out += hashlib.sha256(seed + counter.to_bytes(4, "big")).digest()
+        counter += 1
+    return out[:length]
+
+
+def main() -> None:
+    """Checks the reference, then writes the known answers."""
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("output", type=Path, help="file of the known answers")
+    args = parser.parse_args()
+
+    for msg, len_in_bytes, expected in RFC_VECTORS:
+        assert expand_message_xmd(msg, RFC_DST, len_in_bytes).hex() == expected, \
+            f"expand_message_xmd does not match RFC 9380 for {msg[:16]!r}"
+
+    lines = ["# compressed public key, message (- if empty), hash to field"]
+    for length in MESSAGE_LENGTHS:
+        pubkey = pseudo_random_bytes(b"pubkey" + length.to_bytes(4, "big"), 48)
+        msg = pseudo_random_bytes(b"message" + length.to_bytes(4, "big"), length)
+        field_hash = hash_to_field(pubkey + msg, TEZOS_DST)
+        lines.append(f"{pubkey.hex()} {msg.hex() or '-'} {field_hash.hex()}")
+
+    args.output.write_text("\n".join(lines) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,162 @@
+/* Tezos Ledger application - BLS hash to field known answer tests
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+/*
+ * Checks `bls_hash_to_field_init/update/final` against the known
+ * answers of a RFC 9380 reference (crypto/gen_vectors.py), the message
+ * being given whole, byte by byte and in APDU-sized packets.
+ *
+ * Usage: hash_to_field_test <vectors file>
+ *
+ * Each line of the vectors file holds, in hexadecimal, the compressed
+ * public key, the message (`-` if empty) and its hash to field. Lines
+ * starting with `#` are ignored.
+ */
+
+#include "crypto.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Sizes of the parts the messages are given in
+static size_t const PART_SIZES[] = {1u, 64u, 235u, SIZE_MAX};
+
+/**
+ * @brief Decodes an hexadecimal string
+ *
+ * @param hex: hexadecimal string, `-` for no bytes
+ * @param out: output buffer, allocated
+ * @param out_len: output length
+ * @return bool: whether the string is valid
+ */
+static bool decode_hex(char const *hex, uint8_t **out, size_t *out_len) {
+    size_t const hex_len = (strcmp(hex, "-") == 0) ? 0u : strlen(hex);
+
+    if ((hex_len % 2u) != 0u) {
+        return false;
+    }
+    *out_len = hex_len / 2u;
+    *out = malloc(*out_len + 1u);
+    if (*out == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < *out_len; i++) {
+        unsigned int byte = 0;
+        if (sscanf(hex + (2u * i), "%2x", &byte) != 1) {
+            return false;
+        }
+        (*out)[i] = (uint8_t) byte;
+    }
+    return true;
+}
+
+/**
+ * @brief Hashes a message to the field, given in parts
+ *
+ * @param pubkey: compressed public key
+ * @param msg: message
+ * @param msg_len: message length
+ * @param part_size: size of the parts
+ * @param hash: output hash
+ * @return cx_err_t: error, CX_OK if none
+ */
+static cx_err_t hash_in_parts(uint8_t const pubkey[static BLS_COMPRESSED_PK_LEN],
+                              uint8_t const *msg,
+                              size_t msg_len,
+                              size_t part_size,
+                              uint8_t hash[static BLS_FIELD_HASH_LEN]) {
+    cx_err_t error = CX_OK;
+    cx_sha256_t state;
+
+    CX_CHECK(bls_hash_to_field_init(&state, pubkey));
+    for (size_t offset = 0; offset < msg_len; offset += part_size) {
+        size_t const size = ((msg_len - offset) < part_size) ? (msg_len - offset) : part_size;
+        CX_CHECK(bls_hash_to_field_update(&state, msg + offset, size));
+    }
+    CX_CHECK(bls_hash_to_field_final(&state, hash));
+
+end:
+    return error;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned int nb_vectors = 0;
+    unsigned int nb_failures = 0;
+    char *line = NULL;
+    size_t line_size = 0;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <vectors file>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *const file = fopen(argv[1], "r");
+    if (file == NULL) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    while (getline(&line, &line_size, file) != -1) {
+        char *const pubkey_hex = strtok(line, " \n");
+        char *const msg_hex = strtok(NULL, " \n");
+        char *const hash_hex = strtok(NULL, " \n");
+        uint8_t *pubkey = NULL;
+        uint8_t *msg = NULL;
+        uint8_t *expected = NULL;
+        size_t pubkey_len = 0;
+        size_t msg_len = 0;
+        size_t expected_len = 0;
+
+        if ((pubkey_hex == NULL) || (pubkey_hex[0] == '#')) {
+            continue;
+        }
+        if ((msg_hex == NULL) || (hash_hex == NULL) ||
+            !decode_hex(pubkey_hex, &pubkey, &pubkey_len) ||
+            !decode_hex(msg_hex, &msg, &msg_len) ||
+            !decode_hex(hash_hex, &expected, &expected_len) ||
+            (pubkey_len != BLS_COMPRESSED_PK_LEN) || (expected_len != BLS_FIELD_HASH_LEN)) {
+            fprintf(stderr, "%s: invalid vector %u\n", argv[1], nb_vectors + 1u);
+            return EXIT_FAILURE;
+        }
+        nb_vectors++;
+
+        for (size_t i = 0; i < (sizeof(PART_SIZES) / sizeof(PART_SIZES[0])); i++) {
+            uint8_t hash[BLS_FIELD_HASH_LEN] = {0};
+            cx_err_t const error = hash_in_parts(pubkey, msg, msg_len, PART_SIZES[i], hash);
+            if ((error != CX_OK) || (memcmp(hash, expected, sizeof(hash)) != 0)) {
+                nb_failures++;
+                printf("vector %u: %zu-byte message in %zu-byte parts: %s\n",
+                       nb_vectors,
+                       msg_len,
+                       (PART_SIZES[i] == SIZE_MAX) ? msg_len : PART_SIZES[i],
+                       (error != CX_OK) ? "error" : "wrong hash");
+            }
+        }
+
+        free(pubkey);
+        free(msg);
+        free(expected);
+    }
+
+    free(line);
+    fclose(file);
+
+    fprintf(stderr, "%s: %u vectors, %u failures\n", argv[1], nb_vectors, nb_failures);
+    return ((nb_vectors != 0u) && (nb_failures == 0u)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
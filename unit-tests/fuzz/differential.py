@@ -0,0 +1,335 @@
+# Copyright 2024 Trilitech <contact@trili.tech>
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Compares the parsers of the app with reference decoders.
+
+Each input of the corpus, and some mutations of it, is decoded by the
+standalone fuzz target and by the reference decoder of this module. The
+summaries they give must be identical.
+"""
+
+import argparse
+import random
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+from typing import Callable, Dict, List, Optional, Tuple
+
+class DecodeError(Exception):
+    """Raised when the reference decoder rejects an input."""
+
+class Reader:
+    """Reads an input from its start."""
+
+    def __init__(self, data: bytes):
+        self.data = data
+        self.offset = 0
+
+    def read(self, size: int) -> bytes:
+        """Reads size bytes."""
+        if size < 0 or self.offset + size > len(self.data):
+            raise DecodeError("end of input")
+        raw = self.data[self.offset:self.offset + size]
+        self.offset += size
+        return raw
+
+    def u8(self) -> int:
+        """Reads an uint8."""
+        return self.read(1)[0]
+
+    def u32(self) -> int:
+        """Reads a big-endian uint32."""
+        return int.from_bytes(self.read(4), 'big')
+
+    def at_end(self) -> bool:
+        """Whether the input has been entirely read."""
+        return self.offset == len(self.data)
+
+U64_MASK = 2**64 - 1
+
+# Fitness of a tenderbake block
+MINIMUM_FITNESS_SIZE = 33
+MAXIMUM_FITNESS_SIZE = 37
+TENDERBAKE_PROTO_FITNESS_VERSION = 2
+
+def decode_block(data: bytes) -> str:
+    """Reference decoder of parse_block."""
+    reader = Reader(data)
+    chain_id = reader.u32()
+    level = reader.u32()
+    reader.read(1 + 32 + 8 + 1 + 32)
+    if reader.u32() not in (MINIMUM_FITNESS_SIZE, MAXIMUM_FITNESS_SIZE):
+        raise DecodeError("fitness size")
+    if reader.u32() != 1 or reader.u8() != TENDERBAKE_PROTO_FITNESS_VERSION:
+        raise DecodeError("fitness tag")
+    for _ in range(3):  # level, locked_round, predecessor_round
+        reader.read(reader.u32())
+    if reader.u32() != 4:
+        raise DecodeError("current round size")
+    round_ = reader.u32()
+    return f"block chain_id={chain_id:08x} level={level} round={round_}"
+
+TAG_ATTESTATION = 21
+TAG_ATTESTATION_WITH_DAL = 23
+
+def decode_consensus_operation(data: bytes) -> str:
+    """Reference decoder of parse_consensus_operation, for attestations."""
+    reader = Reader(data)
+    chain_id = reader.u32()
+    reader.read(32)  # branch
+    tag = reader.u8()
+    if tag not in (TAG_ATTESTATION, TAG_ATTESTATION_WITH_DAL):
+        raise DecodeError("tag")
+    slot = int.from_bytes(reader.read(2), "big")
+    level = reader.u32()
+    round_ = reader.u32()
+    reader.read(32)  # block payload hash
+    has_dal = tag == TAG_ATTESTATION_WITH_DAL
+    dal = read_z(reader) if has_dal else 0
+    if not reader.at_end():
+        raise DecodeError("trailing bytes")
+    return (f"consensus chain_id={chain_id:08x} slot={slot} level={level} round={round_} "
+            f"has_dal={int(has_dal)} dal={dal}")
+
+# Key given to every path by the stubs of the host build
+SIGNER_SIGNATURE_TYPE = 0  # ed25519
+SIGNER_PKH = bytes(20)
+SIGNER_PK = bytes(32)
+
+TAG_REVEAL = 107
+TAG_TRANSACTION = 108
+TAG_DELEGATION = 110
+TAG_UPDATE_CONSENSUS_KEY = 114
+TAG_NONE = -1
+# Signature types on the host build, which has BLS
+SIGNATURE_TYPE_UNSET = 4
+
+def read_z(reader: Reader) -> int:
+    """Reads a Z number holding on 64 bits."""
+    value = 0
+    shift = 0
+    while True:
+        byte = reader.u8()
+        if shift > 63 or (shift == 63 and byte != 1):
+            raise DecodeError("Z overflow")
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte & 0x80 == 0:
+            return value
+
+def read_signature_type(reader: Reader) -> int:
+    """Reads a signature type."""
+    signature_type = reader.u8()
+    if signature_type >= SIGNATURE_TYPE_UNSET:
+        raise DecodeError("signature type")
+    return signature_type
+
+# Length of the public keys of each signature type
+PUBLIC_KEY_LENGTHS = [32, 33, 33, 48]
+
+# Staking entrypoints: stake, unstake, finalize_unstake, set_delegate_parameters
+ENTRYPOINT_STAKE = 6
+ENTRYPOINT_UNSTAKE = 7
+ENTRYPOINT_FINALIZE_UNSTAKE = 8
+ENTRYPOINT_SET_DELEGATE_PARAMETERS = 9
+
+# Micheline encoding of the staking parameters
+MICHELINE_INT = b"\x00"
+MICHELINE_PAIR = b"\x07\x07"
+MICHELINE_UNIT = b"\x03\x0b"
+
+def read_micheline_nat(reader: Reader) -> int:
+    """Reads a non-negative Micheline integer holding on 62 bits."""
+    byte = reader.u8()
+    if byte & 0x40:
+        raise DecodeError("negative integer")
+    value = byte & 0x3F
+    shift = 6
+    while byte & 0x80:
+        if shift > 55:
+            raise DecodeError("integer overflow")
+        byte = reader.u8()
+        value |= (byte & 0x7F) << shift
+        shift += 7
+    return value
+
+def read_staking_parameters(reader: Reader, entrypoint: int) -> Tuple[int, int]:
+    """Reads the Micheline parameters of a staking entrypoint."""
+    parameters = Reader(reader.read(reader.u32()))
+    staking_limit = staking_edge = 0
+    if entrypoint == ENTRYPOINT_SET_DELEGATE_PARAMETERS:
+        if parameters.read(3) != MICHELINE_PAIR + MICHELINE_INT:
+            raise DecodeError("parameters")
+        staking_limit = read_micheline_nat(parameters)
+        if parameters.read(3) != MICHELINE_PAIR + MICHELINE_INT:
+            raise DecodeError("parameters")
+        staking_edge = read_micheline_nat(parameters)
+    if parameters.read(2) != MICHELINE_UNIT or not parameters.at_end():
+        raise DecodeError("parameters")
+    return staking_limit, staking_edge
+
+def decode_operations(data: bytes) -> str:
+    """Reference decoder of parse_operations, ignoring the packet size."""
+    if len(data) < 1:
+        raise DecodeError("no packet size")
+    reader = Reader(data[1:])
+    total_fee = 0
+    total_storage_limit = 0
+    has_reveal = False
+    tag = TAG_NONE
+    destination: Tuple[int, bytes] = (0, bytes(20))
+    details = ""
+
+    reader.read(32)  # branch
+    while not reader.at_end():
+        op_tag = reader.u8()
+        if op_tag not in (TAG_REVEAL, TAG_TRANSACTION, TAG_DELEGATION, TAG_UPDATE_CONSENSUS_KEY):
+            raise DecodeError("tag")
+        source = (read_signature_type(reader), reader.read(20))
+        if source != (SIGNER_SIGNATURE_TYPE, SIGNER_PKH):
+            raise DecodeError("source")
+        total_fee = (total_fee + read_z(reader)) & U64_MASK
+        read_z(reader)  # counter
+        read_z(reader)  # gas limit
+        total_storage_limit = (total_storage_limit + read_z(reader)) & U64_MASK
+        if op_tag == TAG_REVEAL:
+            if read_signature_type(reader) != SIGNER_SIGNATURE_TYPE:
+                raise DecodeError("reveal signature type")
+            if reader.read(len(SIGNER_PK)) != SIGNER_PK:
+                raise DecodeError("reveal public key")
+            has_reveal = True
+            continue
+        if tag != TAG_NONE:
+            raise DecodeError("several operations")
+        tag = op_tag
+        if op_tag == TAG_UPDATE_CONSENSUS_KEY:
+            key_type = read_signature_type(reader)
+            key = reader.read(PUBLIC_KEY_LENGTHS[key_type])
+            details = f" consensus_key={key_type}:{key.hex()}"
+        elif op_tag == TAG_TRANSACTION:
+            amount = read_z(reader)
+            if reader.u8() != 0:
+                raise DecodeError("originated destination")
+            destination = (read_signature_type(reader), reader.read(20))
+            if destination != (SIGNER_SIGNATURE_TYPE, SIGNER_PKH):
+                raise DecodeError("destination")
+            if reader.u8() != 0xFF:
+                raise DecodeError("no parameters")
+            entrypoint = reader.u8()
+            if entrypoint not in (ENTRYPOINT_STAKE, ENTRYPOINT_UNSTAKE,
+                                  ENTRYPOINT_FINALIZE_UNSTAKE,
+                                  ENTRYPOINT_SET_DELEGATE_PARAMETERS):
+                raise DecodeError("entrypoint")
+            if entrypoint in (ENTRYPOINT_FINALIZE_UNSTAKE,
+                              ENTRYPOINT_SET_DELEGATE_PARAMETERS) and amount != 0:
+                raise DecodeError("amount")
+            staking_limit, staking_edge = read_staking_parameters(reader, entrypoint)
+            details = (f" amount={amount} entrypoint={entrypoint} "
+                       f"staking_limit={staking_limit} staking_edge={staking_edge}")
+        elif reader.u8() != 0:
+            destination = (read_signature_type(reader), reader.read(20))
+        else:
+            destination = (SIGNATURE_TYPE_UNSET, destination[1])
+
+    if tag == TAG_NONE and not has_reveal:
+        raise DecodeError("no operation")
+    return (f"operations tag={tag} total_fee={total_fee} "
+            f"total_storage_limit={total_storage_limit} has_reveal={int(has_reveal)} "
+            f"destination={destination[0]}:{destination[1].hex()}{details}")
+
+DECODERS: Dict[str, Callable[[bytes], str]] = {
+    "parse_operations": decode_operations,
+    "parse_block": decode_block,
+    "parse_consensus_operation": decode_consensus_operation,
+}
+
+def reference(decoder: Callable[[bytes], str], data: bytes) -> str:
+    """Summary of the reference decoder."""
+    try:
+        return decoder(data)
+    except DecodeError:
+        return "error"
+
+def mutate(data: bytes, rng: random.Random) -> bytes:
+    """Flips, truncates or extends an input."""
+    raw = bytearray(data)
+    choice = rng.randrange(3)
+    if choice == 0 and raw:
+        raw[rng.randrange(len(raw))] ^= 1 << rng.randrange(8)
+    elif choice == 1 and raw:
+        del raw[rng.randrange(len(raw)):]
+    else:
+        raw += rng.randbytes(rng.randrange(1, 8))
+    return bytes(raw)
+
+def run_target(build: Path, target: str, directory: Path) -> Dict[str, str]:
+    """Summaries given by the standalone fuzz target."""
+    output = subprocess.run([str(build / f"standalone_{target}"), "-d", str(directory)],
+                            check=True,
+                            capture_output=True,
+                            text=True).stdout
+    summaries = {}
+    for line in output.splitlines():
+        path, summary = line.split("\t", 1)
+        summaries[Path(path).name] = summary
+    return summaries
+
+def check_target(build: Path,
+                 target: str,
+                 seeds: List[bytes],
+                 mutations: int,
+                 rng: random.Random) -> int:
+    """Compares the target and its reference decoder, returns the number of mismatches."""
+    inputs = list(seeds)
+    for _ in range(mutations):
+        if inputs:
+            inputs.append(mutate(rng.choice(inputs), rng))
+
+    with tempfile.TemporaryDirectory() as tmp:
+        directory = Path(tmp)
+        for index, data in enumerate(inputs):
+            (directory / f"{index:06}").write_bytes(data)
+        summaries = run_target(build, target, directory)
+
+    mismatches = 0
+    for index, data in enumerate(inputs):
+        expected = reference(DECODERS[target], data)
+        actual = summaries.get(f"{index:06}")
+        if actual != expected:
+            mismatches += 1
+            print(f"{target}: {data.hex()}\n  app:       {actual}\n  reference: {expected}")
+    print(f"{target}: {len(inputs)} inputs, {mismatches} mismatches")
+    return mismatches
+
+def main(argv: Optional[List[str]] = None) -> int:
+    """Runs the comparison on every target."""
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("corpus", type=Path, help="corpus directory, one sub-directory per target")
+    parser.add_argument("--build", type=Path, default=Path("build"), help="build directory")
+    parser.add_argument("--mutations", type=int, default=10000, help="mutated inputs per target")
+    parser.add_argument("--seed", type=int, default=0, help="random seed")
+    args = parser.parse_args(argv)
+
+    rng = random.Random(args.seed)
+    mismatches = 0
+    for target in DECODERS:
+        directory = args.corpus / target
+        seeds = [path.read_bytes() for path in sorted(directory.glob("*")) if path.is_file()] \
+            if directory.is_dir() else []
+        mismatches += check_target(args.build, target, seeds, args.mutations, rng)
+    return 1 if mismatches else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,46 @@
+/* Tezos Ledger application - Fuzzing harness
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Size of the summary of a decoded input
+#define FUZZ_SUMMARY_SIZE 512u
+
+/**
+ * @brief Decodes an input with the parser of the target
+ *
+ *        Each target implements it. Aborts if the parser breaks one of
+ *        its invariants.
+ *
+ * @param data: input
+ * @param size: input size
+ * @param summary: output, one line describing what has been parsed
+ * @param summary_size: output size
+ * @return bool: whether the parser accepted the input
+ */
+bool fuzz_decode(uint8_t const *data, size_t size, char *summary, size_t summary_size);
+
+/**
+ * @brief Resets the application state between two inputs
+ *
+ */
+void fuzz_reset(void);
@@ -0,0 +1,38 @@
+/* Tezos Ledger application - Fuzzing harness: libFuzzer entry point
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+#include "fuzz.h"
+
+#include "globals.h"
+
+#include <string.h>
+
+int LLVMFuzzerTestOneInput(uint8_t const *data, size_t size);
+
+void fuzz_reset(void) {
+    memset(&global, 0, sizeof(global));
+}
+
+int LLVMFuzzerTestOneInput(uint8_t const *data, size_t size) {
+    char summary[FUZZ_SUMMARY_SIZE];
+
+    fuzz_reset();
+    (void) fuzz_decode(data, size, summary, sizeof(summary));
+
+    return 0;
+}
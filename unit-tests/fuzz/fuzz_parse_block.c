@@ -0,0 +1,50 @@
+/* Tezos Ledger application - Fuzzing harness: parse_block
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+/*
+ * Input: a block header, without its magic byte.
+ */
+
+#include "fuzz.h"
+
+#include "baking_auth.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+bool fuzz_decode(uint8_t const *data, size_t size, char *summary, size_t summary_size) {
+    buffer_t buf = {.ptr = data, .size = size, .offset = 0};
+    parsed_baking_data_t out = {0};
+
+    if (!parse_block(&buf, &out)) {
+        snprintf(summary, summary_size, "error");
+        return false;
+    }
+
+    if ((buf.offset > size) || (out.type != BAKING_TYPE_BLOCK)) {
+        abort();
+    }
+
+    snprintf(summary,
+             summary_size,
+             "block chain_id=%08x level=%u round=%u",
+             out.chain_id.v,
+             out.level,
+             out.round);
+    return true;
+}
@@ -0,0 +1,142 @@
+/* Tezos Ledger application - Fuzzing harness: parse_operations
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+/*
+ * Input: one byte giving the size of the packets, followed by a group
+ * of operations without its magic byte.
+ *
+ * The group is parsed once in a single packet, then once split into
+ * packets of the given size (0 meaning a single packet). Since the
+ * parser resumes where the previous packet stopped, both parsings must
+ * give the same result.
+ */
+
+#include "fuzz.h"
+
+#include "globals.h"
+#include "operations.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bip32_path_with_curve_t const SIGNING_KEY = {
+    .bip32_path = {.length = 4u,
+                   .components = {0x8000002Cu, 0x800006C1u, 0x80000000u, 0x80000000u}},
+    .derivation_type = DERIVATION_TYPE_ED25519};
+
+/**
+ * @brief Parses a group of operations split into packets
+ *
+ * @param data: group of operations
+ * @param size: group size
+ * @param packet_size: size of the packets, 0 for a single packet
+ * @param out: parsing output
+ * @return bool: whether the parser accepted the group
+ */
+static bool parse_split(uint8_t const *data,
+                        size_t size,
+                        size_t packet_size,
+                        struct parsed_operation_group *out) {
+    if (packet_size == 0u) {
+        packet_size = size;
+    }
+
+    if (parse_operations_init(out, &SIGNING_KEY, &global.apdu.u.sign.parse_state) != SW_OK) {
+        abort();
+    }
+
+    size_t offset = 0u;
+    do {
+        size_t const len = CUSTOM_MIN(packet_size, size - offset);
+        buffer_t buf = {.ptr = data + offset, .size = len, .offset = 0};
+        if (parse_operations(&buf, out) != SW_OK) {
+            return false;
+        }
+        offset += len;
+    } while (offset < size);
+
+    return parse_operations_final(&global.apdu.u.sign.parse_state, out);
+}
+
+static void print_contract(char *summary, size_t summary_size, parsed_contract_t const *contract) {
+    size_t len = strlen(summary);
+
+    snprintf(summary + len, summary_size - len, "%u:", contract->signature_type);
+    for (size_t i = 0; i < sizeof(contract->hash); i++) {
+        len = strlen(summary);
+        snprintf(summary + len, summary_size - len, "%02x", contract->hash[i]);
+    }
+}
+
+bool fuzz_decode(uint8_t const *data, size_t size, char *summary, size_t summary_size) {
+    struct parsed_operation_group whole;
+    struct parsed_operation_group split;
+
+    if (size < 1u) {
+        snprintf(summary, summary_size, "error");
+        return false;
+    }
+
+    size_t const packet_size = data[0];
+    data++;
+    size--;
+
+    bool const result = parse_split(data, size, 0u, &whole);
+    struct parse_state const whole_state = global.apdu.u.sign.parse_state;
+
+    if ((parse_split(data, size, packet_size, &split) != result) ||
+        (memcmp(&whole, &split, sizeof(whole)) != 0) ||
+        (memcmp(&whole_state, &global.apdu.u.sign.parse_state, sizeof(whole_state)) != 0)) {
+        abort();
+    }
+
+    if (!result) {
+        snprintf(summary, summary_size, "error");
+        return false;
+    }
+
+    snprintf(summary,
+             summary_size,
+             "operations tag=%d total_fee=%llu total_storage_limit=%llu has_reveal=%u "
+             "destination=",
+             whole.operation.tag,
+             (unsigned long long) whole.total_fee,
+             (unsigned long long) whole.total_storage_limit,
+             whole.has_reveal);
+    print_contract(summary, summary_size, &whole.operation.destination);
+
+    size_t len = strlen(summary);
+    if (whole.operation.tag == OPERATION_TAG_TRANSACTION) {
+        snprintf(summary + len,
+                 summary_size - len,
+                 " amount=%llu entrypoint=%u staking_limit=%llu staking_edge=%llu",
+                 (unsigned long long) whole.operation.amount,
+                 whole.operation.entrypoint,
+                 (unsigned long long) whole.operation.staking_limit,
+                 (unsigned long long) whole.operation.staking_edge);
+    } else if (whole.operation.tag == OPERATION_TAG_UPDATE_CONSENSUS_KEY) {
+        parsed_public_key_t const *const key = &whole.operation.consensus_key;
+        snprintf(summary + len, summary_size - len, " consensus_key=%u:", key->signature_type);
+        for (size_t i = 0; i < signature_type_to_public_key_len(key->signature_type); i++) {
+            len = strlen(summary);
+            snprintf(summary + len, summary_size - len, "%02x", key->W[i]);
+        }
+    }
+    return true;
+}
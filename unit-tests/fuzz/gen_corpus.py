@@ -0,0 +1,116 @@
+# Copyright 2024 Trilitech <contact@trili.tech>
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+#     http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Generates the seed corpus of the fuzz targets from the test messages."""
+
+import argparse
+import sys
+from pathlib import Path
+from typing import Dict, List
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[2] / "test"))
+
+# pylint: disable=wrong-import-position
+from utils.message import (  # noqa: E402
+    Attestation,
+    Block,
+    BlockHeader,
+    Delegation,
+    Fitness,
+    Message,
+    OperationGroup,
+    Preattestation,
+    Reveal,
+    Staking,
+    UpdateConsensusKey,
+)
+
+# Sizes of the packets the group of operations is split into, 0 for
+# a single packet
+PACKET_SIZES: List[int] = [0, 1, 7, 32, 64, 235]
+
+def body(message: Message) -> bytes:
+    """Message without its magic byte."""
+    return bytes(message)[1:]
+
+def operations() -> Dict[str, bytes]:
+    """Groups of operations."""
+    groups = {
+        "reveal": OperationGroup([Reveal(fee=1, counter=2, gas_limit=3, storage_limit=4)]),
+        "delegation": OperationGroup([
+            Delegation(delegate="tz1Ke2h7sDdakHJQh8WX4Z372du1KChsksyU", fee=10000)
+        ]),
+        "undelegation": OperationGroup([Delegation()]),
+        "reveal_delegation": OperationGroup([
+            Reveal(fee=2**35, storage_limit=2**20),
+            Delegation(delegate="tz1Ke2h7sDdakHJQh8WX4Z372du1KChsksyU",
+                       fee=2**40,
+                       storage_limit=2**62),
+        ]),
+        "many_reveals": OperationGroup([Reveal(fee=i, counter=i) for i in range(8)]),
+        "update_consensus_key": OperationGroup([UpdateConsensusKey(fee=500)]),
+        "stake": OperationGroup([Staking(amount=6_000_000_000, fee=1000)]),
+        "unstake": OperationGroup([Staking(entrypoint='unstake', amount=2**62)]),
+        "finalize_unstake": OperationGroup([Staking(entrypoint='finalize_unstake')]),
+        "set_delegate_parameters": OperationGroup([
+            Staking(entrypoint='set_delegate_parameters',
+                    parameter=Staking.delegate_parameters(5_000_000, 100_000_000))
+        ]),
+        "reveal_stake": OperationGroup([Reveal(), Staking(amount=1)]),
+    }
+    return {
+        f"{name}_{packet_size}": bytes([packet_size]) + body(group)
+        for name, group in groups.items()
+        for packet_size in PACKET_SIZES
+    }
+
+def blocks() -> Dict[str, bytes]:
+    """Block headers."""
+    headers = {
+        "default": BlockHeader(),
+        "level": BlockHeader(level=2**31, fitness=Fitness(level=2**31, current_round=5)),
+        "locked_round": BlockHeader(fitness=Fitness(locked_round=3, current_round=4)),
+        "protocol_data": BlockHeader(protocol_data="00" * 64),
+    }
+    return {name: body(Block(header)) for name, header in headers.items()}
+
+def consensus_operations() -> Dict[str, bytes]:
+    """Attestations, and a preattestation whose tag the attestation target refuses."""
+    return {
+        "preattestation": body(Preattestation(op_level=1, op_round=2)),
+        "attestation": body(Attestation(slot=3, op_level=2**31, op_round=1)),
+        "attestation_dal": body(Attestation(op_level=5, dal_attestation=1)),
+        "attestation_dal_large": body(Attestation(op_level=5, dal_attestation=2**63 + 1)),
+    }
+
+CORPORA = {
+    "parse_operations": operations,
+    "parse_block": blocks,
+    "parse_consensus_operation": consensus_operations,
+}
+
+def main() -> None:
+    """Writes one file per seed in <corpus>/<target>/."""
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("corpus", type=Path, help="corpus directory")
+    args = parser.parse_args()
+
+    for target, generate in CORPORA.items():
+        directory = args.corpus / target
+        directory.mkdir(parents=True, exist_ok=True)
+        for name, data in generate().items():
+            (directory / name).write_bytes(data)
+
+if __name__ == "__main__":
+    main()
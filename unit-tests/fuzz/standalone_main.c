@@ -0,0 +1,112 @@
+/* Tezos Ledger application - Fuzzing harness: standalone driver
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+/*
+ * Runs a fuzz target on files, without libFuzzer.
+ *
+ * Usage: <target> [-d] <file or directory>...
+ *
+ * With -d, prints for each file its name and the summary of the
+ * decoded input, separated by a tab.
+ */
+
+#include "fuzz.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+int LLVMFuzzerTestOneInput(uint8_t const *data, size_t size);
+
+/// Largest input read from a file
+#define MAX_INPUT_SIZE 4096u
+
+static bool describe = false;
+
+static int run_file(char const *path) {
+    static uint8_t data[MAX_INPUT_SIZE];
+    char summary[FUZZ_SUMMARY_SIZE];
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    size_t const size = fread(data, 1, sizeof(data), file);
+    fclose(file);
+
+    if (describe) {
+        fuzz_reset();
+        (void) fuzz_decode(data, size, summary, sizeof(summary));
+        printf("%s\t%s\n", path, summary);
+    } else {
+        (void) LLVMFuzzerTestOneInput(data, size);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int run_path(char const *path) {
+    struct stat st;
+
+    if (stat(path, &st) != 0) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return run_file(path);
+    }
+
+    struct dirent **entries;
+    int const nb_entries = scandir(path, &entries, NULL, alphasort);
+    if (nb_entries < 0) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    int result = EXIT_SUCCESS;
+    for (int i = 0; i < nb_entries; i++) {
+        if (entries[i]->d_name[0] != '.') {
+            char child[4096];
+            snprintf(child, sizeof(child), "%s/%s", path, entries[i]->d_name);
+            if (run_path(child) != EXIT_SUCCESS) {
+                result = EXIT_FAILURE;
+            }
+        }
+        free(entries[i]);
+    }
+    free(entries);
+
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    int result = EXIT_SUCCESS;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0) {
+            describe = true;
+        } else if (run_path(argv[i]) != EXIT_SUCCESS) {
+            result = EXIT_FAILURE;
+        }
+    }
+
+    return result;
+}
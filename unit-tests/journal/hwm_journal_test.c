@@ -0,0 +1,425 @@
+/* Tezos Ledger application - HWM journal tests
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+/*
+ * Checks that the HWM restored by `init_globals` after a restart is
+ * the one of the last record fully written to the HWM journal, when
+ * records are corrupted, when a write is cut halfway or when the ring
+ * is full.
+ *
+ * Usage: hwm_journal_test [-q] [page size]
+ *
+ * Then reports the NVRAM written on each signature and the number of
+ * signatures made per erase cycle of the most erased flash page, for
+ * flash pages of the given size (512 bytes by default).
+ */
+
+#include "baking_auth.h"
+#include "globals.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// First key authorized to bake
+static bip32_path_with_curve_t const BAKING_KEY = {
+    .bip32_path = {.length = 4u,
+                   .components = {0x8000002Cu, 0x800006C1u, 0x80000000u, 0x80000000u}},
+    .derivation_type = DERIVATION_TYPE_ED25519};
+
+/// Key added to the authorized keys
+static bip32_path_with_curve_t const OTHER_KEY = {
+    .bip32_path = {.length = 4u,
+                   .components = {0x8000002Cu, 0x800006C1u, 0x80000001u, 0x80000000u}},
+    .derivation_type = DERIVATION_TYPE_ED25519};
+
+/// Key replacing another one in its slot
+static bip32_path_with_curve_t const THIRD_KEY = {
+    .bip32_path = {.length = 4u,
+                   .components = {0x8000002Cu, 0x800006C1u, 0x80000002u, 0x80000000u}},
+    .derivation_type = DERIVATION_TYPE_ED25519};
+
+/// Default size of a flash page, in bytes
+#define DEFAULT_PAGE_SIZE 512u
+
+static bool quiet = false;
+static unsigned int nb_checks = 0;
+static unsigned int nb_failures = 0;
+
+/// Counts a check, reports it if it fails
+#define CHECK(cond)                                                                             \
+    do {                                                                                        \
+        nb_checks++;                                                                            \
+        if (!(cond)) {                                                                          \
+            nb_failures++;                                                                      \
+            printf("%s:%d: %s: check failed: %s\n", __FILE__, __LINE__, __func__, #cond);       \
+        }                                                                                       \
+    } while (0)
+
+/**
+ * @brief Erases the NVRAM and authorizes the baking key, as a fresh setup
+ */
+static void setup(void) {
+    nvm_write((void *) &N_data_real, NULL, sizeof(N_data_real));
+    nvm_write((void *) &N_hwm_journal_real, NULL, sizeof(N_hwm_journal_real));
+    memset(&global, 0, sizeof(global));
+    memcpy(&g_baking_key.key, &BAKING_KEY, sizeof(g_baking_key.key));
+    UPDATE_NVRAM;
+}
+
+/**
+ * @brief Signs a block at a level on the main chain with a key, as the app does
+ *
+ * @param key: authorized key
+ * @param level: level of the block
+ * @return bool: whether the block is signed
+ */
+static bool sign_block_with(bip32_path_with_curve_t const *key, level_t level) {
+    parsed_baking_data_t data = {0};
+
+    data.type = BAKING_TYPE_BLOCK;
+    data.level = level;
+    data.is_tenderbake = true;
+    return (guard_baking_authorized(&data, key) == SW_OK) &&
+           (write_high_water_mark(&data, key) == SW_OK);
+}
+
+/**
+ * @brief Signs a block at a level on the main chain with the first key
+ */
+static bool sign_block(level_t level) {
+    return sign_block_with(&BAKING_KEY, level);
+}
+
+/**
+ * @brief Gets the main HWM level of an authorized key
+ */
+static level_t main_level(bip32_path_with_curve_t const *key) {
+    baking_key_t const *const baking_key = find_baking_key(key);
+    return (baking_key == NULL) ? 0u : baking_key->hwm.main.highest_level;
+}
+
+/**
+ * @brief Simulates a restart of the app
+ *
+ * @return level_t: main HWM level restored
+ */
+static level_t restart(void) {
+    init_globals();
+    return g_baking_key.hwm.main.highest_level;
+}
+
+/**
+ * @brief Gets the record of the journal holding a sequence number
+ */
+static hwm_journal_record_t const *journal_record(uint32_t sequence) {
+    return &N_hwm_journal_real.records[sequence % HWM_JOURNAL_SIZE];
+}
+
+static void test_replay_last_record(void) {
+    setup();
+    // More signatures than records: the ring wraps
+    for (level_t level = 1u; level <= (2u * HWM_JOURNAL_SIZE) + 3u; level++) {
+        CHECK(sign_block(level));
+    }
+    uint32_t const sequence = global.hwm_journal_sequence;
+
+    CHECK(restart() == (2u * HWM_JOURNAL_SIZE) + 3u);
+    CHECK(global.hwm_journal_sequence == sequence);
+
+    // The signatures go on after the restart, without reusing a sequence number
+    CHECK(!sign_block((2u * HWM_JOURNAL_SIZE) + 3u));
+    CHECK(sign_block((2u * HWM_JOURNAL_SIZE) + 4u));
+    CHECK(restart() == (2u * HWM_JOURNAL_SIZE) + 4u);
+    CHECK(global.hwm_journal_sequence == sequence + 1u);
+}
+
+static void test_skip_bad_checksum(void) {
+    setup();
+    for (level_t level = 1u; level <= 10u; level++) {
+        CHECK(sign_block(level));
+    }
+
+    // Corrupt the last record: the previous one is restored
+    hwm_journal_record_t record;
+    memcpy(&record, journal_record(global.hwm_journal_sequence), sizeof(record));
+    record.level ^= 0x100u;
+    nvm_write((void *) journal_record(record.sequence), &record, sizeof(record));
+
+    CHECK(restart() == 9u);
+    // The level of the lost record can be signed again: its signature was never sent
+    CHECK(sign_block(10u));
+    CHECK(restart() == 10u);
+}
+
+static void test_interrupted_write(void) {
+    setup();
+    for (level_t level = 1u; level <= HWM_JOURNAL_SIZE + 5u; level++) {
+        CHECK(sign_block(level));
+    }
+
+    // The next record overwrites a record already included in `N_data`: keep its content
+    uint32_t const sequence = global.hwm_journal_sequence + 1u;
+    hwm_journal_record_t oldest;
+    memcpy(&oldest, journal_record(sequence), sizeof(oldest));
+
+    CHECK(sign_block(HWM_JOURNAL_SIZE + 6u));
+
+    // Cut the write halfway: the second half still holds the oldest record
+    hwm_journal_record_t torn;
+    memcpy(&torn, journal_record(sequence), sizeof(torn));
+    memcpy((uint8_t *) &torn + (sizeof(torn) / 2u),
+           (uint8_t const *) &oldest + (sizeof(oldest) / 2u),
+           sizeof(torn) - (sizeof(torn) / 2u));
+    nvm_write((void *) journal_record(sequence), &torn, sizeof(torn));
+
+    CHECK(restart() == HWM_JOURNAL_SIZE + 5u);
+
+    // Cut before any byte is written: nothing changes
+    nvm_write((void *) journal_record(sequence), &oldest, sizeof(oldest));
+    CHECK(restart() == HWM_JOURNAL_SIZE + 5u);
+}
+
+static void test_no_valid_record(void) {
+    setup();
+    // Written in place along with the keys
+    g_baking_key.hwm.main.highest_level = 100u;
+    UPDATE_NVRAM_BAKING_KEYS;
+    for (level_t level = 101u; level <= 110u; level++) {
+        CHECK(sign_block(level));
+    }
+
+    // Every record is corrupted: the HWM written in place is restored
+    for (size_t i = 0; i < HWM_JOURNAL_SIZE; i++) {
+        hwm_journal_record_t record;
+        memcpy(&record, &N_hwm_journal_real.records[i], sizeof(record));
+        record.checksum ^= 0xFFFFu;
+        nvm_write((void *) &N_hwm_journal_real.records[i], &record, sizeof(record));
+    }
+    CHECK(restart() == 100u);
+}
+
+static void test_superseded_records(void) {
+    setup();
+    for (level_t level = 1u; level <= 10u; level++) {
+        CHECK(sign_block(level));
+    }
+
+    // Written in place, as by `RESET`: the records are not replayed over it
+    g_baking_key.hwm.main.highest_level = 5u;
+    UPDATE_NVRAM;
+    CHECK(restart() == 5u);
+    CHECK(sign_block(6u));
+    CHECK(restart() == 6u);
+}
+
+static void test_test_chains(void) {
+    parsed_baking_data_t data = {0};
+
+    setup();
+    g_hwm.main_chain_id.v = 1u;
+    UPDATE_NVRAM;
+
+    // Signatures on the main chain and on two test chains, the last one on chain 3
+    data.type = BAKING_TYPE_ATTESTATION;
+    data.is_tenderbake = true;
+    data.chain_id.v = 1u;
+    data.level = 10u;
+    CHECK(write_high_water_mark(&data, &BAKING_KEY) == SW_OK);
+    data.chain_id.v = 3u;
+    data.level = 30u;
+    CHECK(write_high_water_mark(&data, &BAKING_KEY) == SW_OK);
+    data.chain_id.v = 2u;
+    data.level = 20u;
+    CHECK(write_high_water_mark(&data, &BAKING_KEY) == SW_OK);
+    data.chain_id.v = 3u;
+    data.level = 31u;
+    data.type = BAKING_TYPE_PREATTESTATION;
+    CHECK(write_high_water_mark(&data, &BAKING_KEY) == SW_OK);
+
+    restart();
+    high_watermarks_t const *const hwm = &g_baking_key.hwm;
+    CHECK(hwm->main.highest_level == 10u);
+    CHECK(hwm->main.had_attestation);
+    CHECK(hwm->nb_chains == 2u);
+    CHECK(hwm->chains[0].chain_id.v == 2u);
+    CHECK(hwm->chains[0].hwm.highest_level == 20u);
+    CHECK(hwm->chains[1].chain_id.v == 3u);
+    CHECK(hwm->chains[1].hwm.highest_level == 31u);
+    CHECK(!hwm->chains[1].hwm.had_attestation);
+    CHECK(hwm->chains[1].hwm.had_preattestation);
+    CHECK(hwm->last_chain == 1u);
+}
+
+static void test_removed_key(void) {
+    setup();
+    CHECK(add_baking_key(&OTHER_KEY) == SW_OK);
+    for (level_t level = 1u; level <= 20u; level++) {
+        CHECK(sign_block_with(&OTHER_KEY, level));
+    }
+    CHECK(sign_block(5u));
+
+    // The HWM of the removed key is kept in the one of the first key
+    CHECK(authorize_baking(BAKING_KEY.derivation_type, &BAKING_KEY.bip32_path) == SW_OK);
+    CHECK(main_level(&BAKING_KEY) == 20u);
+    CHECK(find_baking_key(&OTHER_KEY) == NULL);
+    restart();
+    CHECK(main_level(&BAKING_KEY) == 20u);
+
+    // Added again, the key does not sign below what it signed
+    CHECK(add_baking_key(&OTHER_KEY) == SW_OK);
+    CHECK(!sign_block_with(&OTHER_KEY, 20u));
+    CHECK(sign_block_with(&OTHER_KEY, 21u));
+    restart();
+    CHECK(main_level(&OTHER_KEY) == 21u);
+}
+
+static void test_interrupted_key_change(void) {
+    setup();
+    CHECK(add_baking_key(&OTHER_KEY) == SW_OK);
+    for (level_t level = 1u; level <= 20u; level++) {
+        CHECK(sign_block_with(&OTHER_KEY, level));
+    }
+
+    // Replace the key of the second slot, but cut the change before the
+    // sequence number superseding the journal is written
+    baking_key_t *const baking_key = &g_hwm.baking_keys[1];
+    memcpy(&baking_key->key, &THIRD_KEY, sizeof(baking_key->key));
+    memset(&baking_key->hwm, 0, sizeof(baking_key->hwm));
+    UPDATE_NVRAM_VAR(baking_keys);
+
+    // The records of the previous key of the slot only raise the HWM of the new key
+    restart();
+    CHECK(main_level(&THIRD_KEY) == 20u);
+    CHECK(!sign_block_with(&THIRD_KEY, 20u));
+    CHECK(sign_block_with(&THIRD_KEY, 21u));
+}
+
+/**
+ * @brief Gets the number of erases of the most erased flash page of
+ *        an area, when given ranges of bytes of it are written
+ *
+ *        A page is erased for every range written over it. The area is
+ *        assumed to start on a page.
+ *
+ * @param area_size: size of the area, in bytes
+ * @param range_size: size of the ranges, in bytes
+ * @param nb_ranges: number of ranges written one after the other
+ * @param page_size: size of a flash page, in bytes
+ * @return size_t: erases of the most erased page
+ */
+static size_t max_page_erases(size_t area_size,
+                              size_t range_size,
+                              size_t nb_ranges,
+                              size_t page_size) {
+    size_t const nb_pages = (area_size + page_size - 1u) / page_size;
+    size_t max_erases = 0;
+
+    for (size_t page = 0; page < nb_pages; page++) {
+        size_t erases = 0;
+        for (size_t i = 0; i < nb_ranges; i++) {
+            size_t const first = (i * range_size) / page_size;
+            size_t const last = (((i + 1u) * range_size) - 1u) / page_size;
+            if ((first <= page) && (page <= last)) {
+                erases++;
+            }
+        }
+        if (erases > max_erases) {
+            max_erases = erases;
+        }
+    }
+    return max_erases;
+}
+
+/**
+ * @brief Reports the NVRAM written on each signature and the flash wear
+ *
+ * @param page_size: size of a flash page, in bytes
+ */
+static void report_nvram_usage(size_t page_size) {
+    // A turn of the ring: a record per signature, then `N_data` is rewritten once
+    size_t const nb_signatures_per_turn = HWM_JOURNAL_SIZE + 1u;
+    size_t const nb_turns = 10u;
+
+    setup();
+    CHECK(sign_block(1u));
+
+    nvm_write_calls = 0;
+    nvm_write_bytes = 0;
+    for (level_t level = 2u; level < 2u + (nb_turns * nb_signatures_per_turn); level++) {
+        CHECK(sign_block(level));
+    }
+    CHECK(nvm_write_calls == nb_turns * nb_signatures_per_turn);
+    CHECK(nvm_write_bytes ==
+          nb_turns * ((HWM_JOURNAL_SIZE * sizeof(hwm_journal_record_t)) + sizeof(baking_data)));
+
+    // Each turn writes every record once and `N_data` once
+    size_t const journal_erases = max_page_erases(sizeof(N_hwm_journal_real),
+                                                  sizeof(hwm_journal_record_t),
+                                                  HWM_JOURNAL_SIZE,
+                                                  page_size);
+    size_t const max_erases = (journal_erases > 1u) ? journal_erases : 1u;
+    double const nb_signatures = (double) (nb_turns * nb_signatures_per_turn);
+
+    printf("record: %zu bytes, journal: %u records, %zu bytes, N_data: %zu bytes\n",
+           sizeof(hwm_journal_record_t),
+           HWM_JOURNAL_SIZE,
+           sizeof(N_hwm_journal_real),
+           sizeof(baking_data));
+    printf("per signature: %.1f nvm_write, %.1f bytes, %zu bytes if written in place\n",
+           (double) nvm_write_calls / nb_signatures,
+           (double) nvm_write_bytes / nb_signatures,
+           sizeof(high_watermarks_t));
+    printf("%zu-byte pages: the most erased one %zu times every %zu signatures\n",
+           page_size,
+           max_erases,
+           nb_signatures_per_turn);
+    printf("endurance: %.1f signatures per erase cycle of a page, 1 if written in place\n",
+           (double) nb_signatures_per_turn / (double) max_erases);
+}
+
+int main(int argc, char *argv[]) {
+    size_t page_size = DEFAULT_PAGE_SIZE;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else {
+            page_size = strtoul(argv[i], NULL, 10);
+            if (page_size == 0u) {
+                fprintf(stderr, "usage: %s [-q] [page size]\n", argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    test_replay_last_record();
+    test_skip_bad_checksum();
+    test_interrupted_write();
+    test_no_valid_record();
+    test_superseded_records();
+    test_test_chains();
+    test_removed_key();
+    test_interrupted_key_change();
+    if (!quiet) {
+        report_nvram_usage(page_size);
+    }
+
+    fprintf(stderr, "hwm_journal_test: %u checks, %u failures\n", nb_checks, nb_failures);
+    return (nb_failures == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
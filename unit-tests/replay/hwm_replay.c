@@ -0,0 +1,373 @@
+/* Tezos Ledger application - HWM replay tool
+
+   Copyright 2024 TriliTech <contact@trili.tech>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+*/
+
+/*
+ * Replays a trace of signing requests through the baking authorization
+ * code of the app, and prints for each request whether the device
+ * would sign it and the high watermarks after it.
+ *
+ * Usage: hwm_replay [-q] [-m <main chain id>] [trace]
+ *
+ * Each line of the trace is a request:
+ *   <chain id> <type> <level> <round> [accept|reject]
+ * where the chain id is in base58 (NetXdQprcVkpaWU) or in hex
+ * (7a06a770) and the type is block, preattestation or attestation.
+ * The optional last column is the expected result: the tool exits with
+ * an error if a request does not get it, so that a trace can be used
+ * as a regression test. Empty lines and lines starting with '#' are
+ * ignored. The trace is read from stdin if no file is given.
+ *
+ * The main chain id is not set by default, as after a fresh setup: all
+ * chains then share the main HWM. It is set by -m or, from a given
+ * point of the trace, by a line:
+ *   main-chain <chain id>
+ *
+ * After each request, the main HWM, the initial test HWM and the HWM of
+ * each chain of the test chains table are printed.
+ *
+ * With -q, only the mismatches and the summary are printed.
+ */
+
+#include "baking_auth.h"
+#include "globals.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_LINE_SIZE 256u
+
+/// Size of a base58 chain id once decoded: prefix, chain id and checksum
+#define CHAIN_ID_DECODED_SIZE 11u
+
+/// Prefix of the base58 chain ids ("Net")
+static uint8_t const CHAIN_ID_PREFIX[] = {0x57u, 0x52u, 0x00u};
+
+/// Key authorized to bake, every request is signed with it
+static bip32_path_with_curve_t const BAKING_KEY = {
+    .bip32_path = {.length = 4u,
+                   .components = {0x8000002Cu, 0x800006C1u, 0x80000000u, 0x80000000u}},
+    .derivation_type = DERIVATION_TYPE_ED25519};
+
+/// Expected result of a request
+typedef enum {
+    EXPECT_NONE,
+    EXPECT_ACCEPT,
+    EXPECT_REJECT
+} expect_t;
+
+/// Request of the trace
+typedef struct {
+    parsed_baking_data_t data;  ///< request
+    expect_t expect;            ///< expected result
+    bool sets_main_chain;       ///< if the line sets the main chain id instead
+    unsigned int lineno;        ///< line of the request in the trace
+} request_t;
+
+static char const *const BAKING_TYPE_NAMES[] = {
+    [BAKING_TYPE_BLOCK] = "block",
+    [BAKING_TYPE_ATTESTATION] = "attestation",
+    [BAKING_TYPE_PREATTESTATION] = "preattestation",
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000u) + (uint64_t) ts.tv_nsec;
+}
+
+static bool base58_decode(char const *in, uint8_t *out, size_t out_size) {
+    static char const ALPHABET[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+    memset(out, 0, out_size);
+    for (; *in != '\0'; in++) {
+        char const *digit = strchr(ALPHABET, *in);
+        if (digit == NULL) {
+            return false;
+        }
+        unsigned int carry = (unsigned int) (digit - ALPHABET);
+        for (size_t i = out_size; i > 0u; i--) {
+            carry += 58u * out[i - 1u];
+            out[i - 1u] = (uint8_t) carry;
+            carry >>= 8u;
+        }
+        if (carry != 0u) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool parse_chain_id(char const *in, chain_id_t *out) {
+    char *end = NULL;
+
+    if (strlen(in) == 8u) {
+        errno = 0;
+        unsigned long const value = strtoul(in, &end, 16);
+        if ((errno == 0) && (*end == '\0')) {
+            out->v = (uint32_t) value;
+            return true;
+        }
+    }
+
+    uint8_t decoded[CHAIN_ID_DECODED_SIZE];
+    uint8_t checksum[CX_SHA256_SIZE];
+    if (!base58_decode(in, decoded, sizeof(decoded)) ||
+        (memcmp(decoded, CHAIN_ID_PREFIX, sizeof(CHAIN_ID_PREFIX)) != 0)) {
+        return false;
+    }
+    size_t const payload_size = CHAIN_ID_DECODED_SIZE - 4u;
+    cx_hash_sha256(decoded, payload_size, checksum, sizeof(checksum));
+    cx_hash_sha256(checksum, sizeof(checksum), checksum, sizeof(checksum));
+    if (memcmp(decoded + payload_size, checksum, 4u) != 0) {
+        return false;
+    }
+    out->v = ((uint32_t) decoded[3] << 24u) | ((uint32_t) decoded[4] << 16u) |
+             ((uint32_t) decoded[5] << 8u) | (uint32_t) decoded[6];
+    return true;
+}
+
+static bool parse_baking_type(char const *in, baking_type_t *out) {
+    for (size_t i = 0; i < sizeof(BAKING_TYPE_NAMES) / sizeof(BAKING_TYPE_NAMES[0]); i++) {
+        if (strcmp(in, BAKING_TYPE_NAMES[i]) == 0) {
+            *out = (baking_type_t) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_u32(char const *in, uint32_t *out) {
+    char *end = NULL;
+
+    errno = 0;
+    unsigned long const value = strtoul(in, &end, 10);
+    if ((errno != 0) || (*in == '\0') || (*end != '\0') || (value > UINT32_MAX)) {
+        return false;
+    }
+    *out = (uint32_t) value;
+    return true;
+}
+
+/**
+ * @brief Parses a line of the trace
+ *
+ * @param line: line
+ * @param out: request output
+ * @return int: 1 if a request has been read, 0 if the line is empty, -1 on error
+ */
+static int parse_request(char *line, request_t *out) {
+    char *fields[6] = {NULL};
+    size_t nb_fields = 0;
+
+    line += strspn(line, " \t");
+    if (line[0] == '#') {
+        return 0;
+    }
+    for (char *field = strtok(line, " \t\r\n"); field != NULL; field = strtok(NULL, " \t\r\n")) {
+        if (nb_fields == sizeof(fields) / sizeof(fields[0])) {
+            return -1;
+        }
+        fields[nb_fields] = field;
+        nb_fields++;
+    }
+    if (nb_fields == 0u) {
+        return 0;
+    }
+
+    memset(out, 0, sizeof(*out));
+    if (strcmp(fields[0], "main-chain") == 0) {
+        out->sets_main_chain = true;
+        return ((nb_fields == 2u) && parse_chain_id(fields[1], &out->data.chain_id)) ? 1 : -1;
+    }
+    if ((nb_fields != 4u) && (nb_fields != 5u)) {
+        return -1;
+    }
+
+    out->data.is_tenderbake = true;
+    if (!parse_chain_id(fields[0], &out->data.chain_id) ||
+        !parse_baking_type(fields[1], &out->data.type) ||
+        !parse_u32(fields[2], &out->data.level) || !parse_u32(fields[3], &out->data.round)) {
+        return -1;
+    }
+
+    out->expect = EXPECT_NONE;
+    if (nb_fields == 5u) {
+        if (strcmp(fields[4], "accept") == 0) {
+            out->expect = EXPECT_ACCEPT;
+        } else if (strcmp(fields[4], "reject") == 0) {
+            out->expect = EXPECT_REJECT;
+        } else {
+            return -1;
+        }
+    }
+    return 1;
+}
+
+static request_t *read_trace(FILE *file, char const *name, size_t *nb_requests) {
+    char line[MAX_LINE_SIZE];
+    size_t capacity = 1024u;
+    unsigned int lineno = 0;
+    request_t *requests = malloc(capacity * sizeof(*requests));
+
+    *nb_requests = 0;
+    while ((requests != NULL) && (fgets(line, sizeof(line), file) != NULL)) {
+        lineno++;
+        if (*nb_requests == capacity) {
+            capacity *= 2u;
+            request_t *const grown = realloc(requests, capacity * sizeof(*requests));
+            if (grown == NULL) {
+                free(requests);
+                return NULL;
+            }
+            requests = grown;
+        }
+        int const result = parse_request(line, &requests[*nb_requests]);
+        if (result < 0) {
+            fprintf(stderr, "%s:%u: invalid request\n", name, lineno);
+            free(requests);
+            return NULL;
+        }
+        if (result > 0) {
+            requests[*nb_requests].lineno = lineno;
+            (*nb_requests)++;
+        }
+    }
+    return requests;
+}
+
+/**
+ * @brief Handles a request as the app does when asked to sign it
+ *
+ *        The request is checked against the HWM, which is then updated
+ *        and written into the (stubbed) NVRAM if it is accepted
+ *
+ * @param data: request
+ * @return bool: whether the request is signed
+ */
+static bool replay(parsed_baking_data_t const *data) {
+    return (guard_baking_authorized(data, &BAKING_KEY) == SW_OK) &&
+           (write_high_water_mark(data, &BAKING_KEY) == SW_OK);
+}
+
+static void print_hwm(char const *name, high_watermark_t const *hwm) {
+    printf(" %s=%u:%u%s%s",
+           name,
+           hwm->highest_level,
+           hwm->highest_round,
+           hwm->had_preattestation ? ":pre" : "",
+           hwm->had_attestation ? ":att" : "");
+}
+
+int main(int argc, char *argv[]) {
+    bool quiet = false;
+    char const *trace_name = "<stdin>";
+    FILE *trace = stdin;
+
+    memset(&global, 0, sizeof(global));
+    memcpy(&g_baking_key.key, &BAKING_KEY, sizeof(g_baking_key.key));
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else if ((strcmp(argv[i], "-m") == 0) && (i + 1 < argc)) {
+            i++;
+            if (!parse_chain_id(argv[i], &g_hwm.main_chain_id)) {
+                fprintf(stderr, "%s: invalid chain id\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (trace == stdin) {
+            trace_name = argv[i];
+            trace = fopen(trace_name, "r");
+            if (trace == NULL) {
+                perror(trace_name);
+                return EXIT_FAILURE;
+            }
+        } else {
+            fprintf(stderr, "usage: %s [-q] [-m <main chain id>] [trace]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    size_t nb_requests = 0;
+    request_t *const requests = read_trace(trace, trace_name, &nb_requests);
+    if (trace != stdin) {
+        fclose(trace);
+    }
+    if (requests == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    size_t nb_accepted = 0;
+    size_t nb_mismatches = 0;
+    uint64_t const start = now_ns();
+    for (size_t i = 0; i < nb_requests; i++) {
+        request_t const *const request = &requests[i];
+        if (request->sets_main_chain) {
+            g_hwm.main_chain_id = request->data.chain_id;
+            if (!quiet) {
+                printf("%s:%u: main-chain %08x\n",
+                       trace_name,
+                       request->lineno,
+                       g_hwm.main_chain_id.v);
+            }
+            continue;
+        }
+        bool const accepted = replay(&request->data);
+        bool const mismatch = ((request->expect == EXPECT_ACCEPT) && !accepted) ||
+                              ((request->expect == EXPECT_REJECT) && accepted);
+
+        nb_accepted += accepted ? 1u : 0u;
+        nb_mismatches += mismatch ? 1u : 0u;
+        if (!quiet || mismatch) {
+            printf("%s:%u: %08x %s %u %u %s",
+                   trace_name,
+                   request->lineno,
+                   request->data.chain_id.v,
+                   BAKING_TYPE_NAMES[request->data.type],
+                   request->data.level,
+                   request->data.round,
+                   accepted ? "accept" : "reject");
+            print_hwm("main", &g_baking_key.hwm.main);
+            print_hwm("test", &g_baking_key.hwm.test);
+            for (size_t j = 0; j < g_baking_key.hwm.nb_chains; j++) {
+                char name[sizeof("ffffffff")];
+                snprintf(name, sizeof(name), "%08x", g_baking_key.hwm.chains[j].chain_id.v);
+                print_hwm(name, &g_baking_key.hwm.chains[j].hwm);
+            }
+            printf("%s\n", mismatch ? " MISMATCH" : "");
+        }
+    }
+    uint64_t const elapsed = now_ns() - start;
+    fflush(stdout);
+
+    fprintf(stderr,
+            "%s: %zu requests, %zu accepted, %zu rejected, %zu mismatches, %.0f requests/s\n",
+            trace_name,
+            nb_requests,
+            nb_accepted,
+            nb_requests - nb_accepted,
+            nb_mismatches,
+            (elapsed == 0u) ? 0.0 : ((double) nb_requests * 1e9 / (double) elapsed));
+    free(requests);
+
+    return (nb_mismatches == 0u) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,78 @@
+/* Host stubs of the key functions of the application
+ *
+ * Keys are not derived on the host: every path gets a zero public key
+ * and a zero public key hash, as the default keys of the messages of
+ * test/utils/message.py. Public keys are not hashed either: their hash
+ * is zero. The authorized key cache is never used.
+ */
+
+#include "keys.h"
+
+cx_err_t generate_public_key_hash(uint8_t *const hash_out,
+                                  size_t const hash_out_size,
+                                  cx_ecfp_compressed_public_key_t *const compressed_out,
+                                  bip32_path_with_curve_t const *const path_with_curve) {
+    if ((hash_out == NULL) || (path_with_curve == NULL)) {
+        return CX_INVALID_PARAMETER;
+    }
+
+    if (hash_out_size < KEY_HASH_SIZE) {
+        return CX_INVALID_PARAMETER_SIZE;
+    }
+
+    size_t pk_len;
+    switch (path_with_curve->derivation_type) {
+        case DERIVATION_TYPE_ED25519:
+        case DERIVATION_TYPE_BIP32_ED25519:
+            pk_len = TZ_EDPK_LEN;
+            break;
+        case DERIVATION_TYPE_SECP256K1:
+        case DERIVATION_TYPE_SECP256R1:
+            pk_len = COMPRESSED_PK_LEN;
+            break;
+        case DERIVATION_TYPE_BLS12_381:
+            pk_len = BLS_COMPRESSED_PK_LEN;
+            break;
+        default:
+            return CX_INVALID_PARAMETER;
+    }
+
+    memset(hash_out, 0, KEY_HASH_SIZE);
+
+    if (compressed_out != NULL) {
+        compressed_out->W_len = pk_len;
+        memset(((tz_ecfp_compressed_public_key_t *) compressed_out)->pk_bls.W, 0, pk_len);
+    }
+
+    return CX_OK;
+}
+
+cx_err_t compressed_public_key_hash(uint8_t *const hash_out,
+                                    size_t const hash_out_size,
+                                    uint8_t const *const compressed,
+                                    size_t const compressed_len) {
+    if ((hash_out == NULL) || (compressed == NULL)) {
+        return CX_INVALID_PARAMETER;
+    }
+
+    if (hash_out_size < KEY_HASH_SIZE) {
+        return CX_INVALID_PARAMETER_SIZE;
+    }
+
+    memset(hash_out, 0, KEY_HASH_SIZE);
+    return CX_OK;
+}
+
+bool is_authorized_key_cached(bip32_path_with_curve_t const *const path_with_curve) {
+    (void) path_with_curve;
+    return false;
+}
+
+cx_err_t update_authorized_key_cache(void) {
+    return CX_OK;
+}
+
+cx_err_t cache_derived_key(bip32_path_with_curve_t const *const path_with_curve) {
+    (void) path_with_curve;
+    return CX_OK;
+}
@@ -0,0 +1,5 @@
+/* Host stubs of the Ledger SDK: bip32 */
+
+#pragma once
+
+#define MAX_BIP32_PATH 10
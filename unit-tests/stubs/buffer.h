@@ -0,0 +1,21 @@
+/* Host stubs of the Ledger SDK: buffer reader */
+
+#pragma once
+
+#include "os.h"
+
+typedef enum { BE, LE } endianness_t;
+
+typedef struct {
+    const uint8_t *ptr;
+    size_t size;
+    size_t offset;
+} buffer_t;
+
+bool buffer_can_read(const buffer_t *buffer, size_t n);
+bool buffer_seek_cur(buffer_t *buffer, size_t offset);
+bool buffer_move(buffer_t *buffer, uint8_t *out, size_t out_len);
+bool buffer_peek(const buffer_t *buffer, uint8_t *value);
+bool buffer_read_u8(buffer_t *buffer, uint8_t *value);
+bool buffer_read_u16(buffer_t *buffer, uint16_t *value, endianness_t endianness);
+bool buffer_read_u32(buffer_t *buffer, uint32_t *value, endianness_t endianness);
@@ -0,0 +1,139 @@
+/* Host stubs of the Ledger SDK: cryptography types
+ *
+ * Only the hash functions used by the host build are implemented.
+ */
+
+#pragma once
+
+#include "os.h"
+
+typedef uint32_t cx_err_t;
+
+#define CX_OK                      0x00000000u
+#define CX_INVALID_PARAMETER       0xFFFFFF82u
+#define CX_INVALID_PARAMETER_SIZE  0xFFFFFF83u
+#define CX_INVALID_PARAMETER_VALUE 0xFFFFFF84u
+#define CX_EC_INVALID_CURVE        0xFFFFFFC5u
+#define CX_INTERNAL_ERROR          0xFFFFFF85u
+
+#define CX_CHECK(call)         \
+    do {                       \
+        error = (call);        \
+        if (error != CX_OK) {  \
+            goto end;          \
+        }                      \
+    } while (0)
+
+typedef enum {
+    CX_CURVE_NONE,
+    CX_CURVE_Ed25519,
+    CX_CURVE_SECP256K1,
+    CX_CURVE_SECP256R1,
+    CX_CURVE_BLS12_381_G1
+} cx_curve_t;
+
+typedef enum { CX_NONE, CX_SHA256, CX_SHA512, CX_BLAKE2B } cx_md_t;
+
+#define CX_LAST                   1u
+#define CX_SHA256_SIZE            32u
+#define CX_SHA512_SIZE            64u
+#define CX_BLS_BLS12381_PARAM_LEN 48u
+
+typedef struct {
+    cx_curve_t curve;
+    size_t W_len;
+    uint8_t W[1];
+} cx_ecfp_public_key_t;
+typedef struct {
+    cx_curve_t curve;
+    size_t W_len;
+    uint8_t W[65];
+} cx_ecfp_256_public_key_t;
+typedef struct {
+    cx_curve_t curve;
+    size_t W_len;
+    uint8_t W[97];
+} cx_ecfp_384_public_key_t;
+typedef struct {
+    cx_curve_t curve;
+    size_t d_len;
+    uint8_t d[1];
+} cx_ecfp_private_key_t;
+typedef struct {
+    cx_curve_t curve;
+    size_t d_len;
+    uint8_t d[32];
+} cx_ecfp_256_private_key_t;
+typedef struct {
+    cx_curve_t curve;
+    size_t d_len;
+    uint8_t d[48];
+} cx_ecfp_384_private_key_t;
+
+typedef struct {
+    cx_md_t algo;
+} cx_hash_t;
+typedef struct {
+    cx_hash_t header;
+    uint8_t state[248];
+} cx_blake2b_t;
+typedef struct {
+    cx_hash_t header;
+    uint64_t length;
+    uint32_t h[8];
+    uint8_t block[64];
+    size_t block_len;
+} cx_sha256_t;
+
+size_t cx_hash_sha256(const uint8_t *in, size_t len, uint8_t *out, size_t out_len);
+cx_err_t cx_sha256_init_no_throw(cx_sha256_t *hash);
+/// Only SHA-256 states are supported
+cx_err_t cx_hash_no_throw(cx_hash_t *hash,
+                          uint32_t mode,
+                          const uint8_t *in,
+                          size_t len,
+                          uint8_t *out,
+                          size_t out_len);
+
+/// Big numbers of at most 64 bytes, enough to reduce the BLS12-381 expanded elements
+typedef uint32_t cx_bn_t;
+
+cx_err_t cx_bn_lock(size_t word_nbytes, uint32_t flags);
+uint32_t cx_bn_unlock(void);
+bool cx_bn_is_locked(void);
+cx_err_t cx_bn_alloc(cx_bn_t *x, size_t nbytes);
+cx_err_t cx_bn_alloc_init(cx_bn_t *x, size_t nbytes, const uint8_t *value, size_t value_nbytes);
+cx_err_t cx_bn_reduce(cx_bn_t r, const cx_bn_t d, const cx_bn_t n);
+cx_err_t cx_bn_export(const cx_bn_t x, uint8_t *bytes, size_t nbytes);
+
+/*
+ * The key derivation and the elliptic curve operations are not
+ * available on the host: they fail with CX_INTERNAL_ERROR.
+ */
+
+typedef enum { CX_CURVE_PARAM_Field } cx_curve_domain_param_t;
+
+cx_err_t os_derive_eip2333_no_throw(cx_curve_t curve,
+                                    const uint32_t *path,
+                                    size_t path_len,
+                                    uint8_t *private_key);
+cx_err_t cx_ecfp_init_private_key_no_throw(cx_curve_t curve,
+                                           const uint8_t *raw_key,
+                                           size_t key_len,
+                                           cx_ecfp_private_key_t *pvkey);
+cx_err_t cx_ecfp_generate_pair_no_throw(cx_curve_t curve,
+                                        cx_ecfp_public_key_t *pubkey,
+                                        cx_ecfp_private_key_t *privkey,
+                                        bool keepprivate);
+cx_err_t cx_math_mult_no_throw(uint8_t *r, const uint8_t *a, const uint8_t *b, size_t len);
+cx_err_t cx_ecdomain_parameter(cx_curve_t cv,
+                               cx_curve_domain_param_t id,
+                               uint8_t *p,
+                               uint32_t p_len);
+cx_err_t cx_math_cmp_no_throw(const uint8_t *a, const uint8_t *b, size_t length, int *diff);
+cx_err_t ox_bls12381_sign(const cx_ecfp_384_private_key_t *key,
+                          const uint8_t *message,
+                          size_t message_len,
+                          uint8_t *signature,
+                          size_t signature_len);
+uint16_t cx_crc16(const void *buf, size_t len);
@@ -0,0 +1,8 @@
+/* Host stubs of the Ledger SDK: APDU IO */
+
+#pragma once
+
+#include "os.h"
+
+int io_send_sw(uint16_t sw);
+int io_send_response_pointer(const uint8_t *ptr, size_t size, uint16_t sw);
@@ -0,0 +1,39 @@
+/* Host stubs of the Ledger SDK: OS primitives */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PRINTF(...) \
+    do {            \
+    } while (0)
+#define PIC(x)             pic((void *) (x))
+#define UNUSED(x)          (void) (x)
+#define WARN_UNUSED_RESULT __attribute__((warn_unused_result))
+#define ARRAYLEN(a)        (sizeof(a) / sizeof(*(a)))
+
+#define BOLOS_UX_OK 0xAAu
+
+#define APPVERSION    "0.0.0"
+#define MAJOR_VERSION 0
+#define MINOR_VERSION 0
+#define PATCH_VERSION 0
+
+/// Returns its argument, opaquely as the SDK `pic`: the compiler must not assume the NVRAM
+/// objects, written through `nvm_write`, still hold their constant initial value
+void *pic(void *link_address);
+
+/// Writes in the host memory
+void nvm_write(void *dst, void *src, unsigned int len);
+
+/// Number of calls to `nvm_write` and number of bytes written, to measure the NVRAM usage
+extern unsigned int nvm_write_calls;
+extern size_t nvm_write_bytes;
+
+/// Always validated on the host
+unsigned int os_global_pin_is_validated(void);
+
+size_t strlcpy(char *dst, const char *src, size_t size);
@@ -0,0 +1,11 @@
+/* Host stubs of the Ledger SDK: IO layer */
+
+#pragma once
+
+typedef struct {
+    unsigned int ms;
+} io_seph_app_t;
+
+extern io_seph_app_t G_io_app;
+
+void io_seproxyhal_io_heartbeat(void);
@@ -0,0 +1,8 @@
+/* Host stubs of the Ledger SDK: big-endian readers */
+
+#pragma once
+
+#include "os.h"
+
+uint16_t read_u16_be(const uint8_t *ptr, size_t offset);
+uint32_t read_u32_be(const uint8_t *ptr, size_t offset);
@@ -0,0 +1,540 @@
+/* Host stubs of the Ledger SDK
+ *
+ * Plain C implementations of the SDK functions used by the parsing and
+ * HWM logic, so that it can run on the host.
+ */
+
+#include "base58.h"
+#include "buffer.h"
+#include "cx.h"
+#include "io.h"
+#include "os.h"
+#include "os_io_seproxyhal.h"
+#include "read.h"
+#include "write.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+io_seph_app_t G_io_app;
+
+/// Number of NVRAM pages that can be unlocked
+#define MAX_UNLOCKED_PAGES 32u
+
+/**
+ * The NVRAM variables of the app are const, so the host puts them in
+ * read-only pages. Those pages are made writable on the first write.
+ */
+static void unlock_nvram(void const *dst, unsigned int len) {
+    static uintptr_t unlocked[MAX_UNLOCKED_PAGES];
+    static size_t nb_unlocked = 0;
+    uintptr_t const page_size = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t const first = (uintptr_t) dst & ~(page_size - 1u);
+    uintptr_t const last = ((uintptr_t) dst + len - 1u) & ~(page_size - 1u);
+
+    for (uintptr_t page = first; page <= last; page += page_size) {
+        bool is_unlocked = false;
+        for (size_t i = 0; (i < nb_unlocked) && !is_unlocked; i++) {
+            is_unlocked = unlocked[i] == page;
+        }
+        if (!is_unlocked) {
+            if ((nb_unlocked == MAX_UNLOCKED_PAGES) ||
+                (mprotect((void *) page, page_size, PROT_READ | PROT_WRITE) != 0)) {
+                abort();
+            }
+            unlocked[nb_unlocked] = page;
+            nb_unlocked++;
+        }
+    }
+}
+
+void *pic(void *link_address) {
+    return link_address;
+}
+
+unsigned int nvm_write_calls;
+size_t nvm_write_bytes;
+
+void nvm_write(void *dst, void *src, unsigned int len) {
+    if (len == 0u) {
+        return;
+    }
+    nvm_write_calls++;
+    nvm_write_bytes += len;
+    unlock_nvram(dst, len);
+    if (src == NULL) {
+        memset(dst, 0, len);
+    } else {
+        memmove(dst, src, len);
+    }
+}
+
+unsigned int os_global_pin_is_validated(void) {
+    return BOLOS_UX_OK;
+}
+
+size_t strlcpy(char *dst, const char *src, size_t size) {
+    size_t const len = strlen(src);
+    if (size != 0u) {
+        size_t const n = (len < size) ? len : (size - 1u);
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+int io_send_sw(uint16_t sw) {
+    (void) sw;
+    return 0;
+}
+
+int io_send_response_pointer(const uint8_t *ptr, size_t size, uint16_t sw) {
+    (void) ptr;
+    (void) size;
+    (void) sw;
+    return 0;
+}
+
+/***** Buffer *****/
+
+bool buffer_can_read(const buffer_t *buffer, size_t n) {
+    return (buffer->size >= buffer->offset) && ((buffer->size - buffer->offset) >= n);
+}
+
+bool buffer_seek_cur(buffer_t *buffer, size_t offset) {
+    if (!buffer_can_read(buffer, offset)) {
+        return false;
+    }
+    buffer->offset += offset;
+    return true;
+}
+
+bool buffer_move(buffer_t *buffer, uint8_t *out, size_t out_len) {
+    if (!buffer_can_read(buffer, out_len)) {
+        return false;
+    }
+    memmove(out, buffer->ptr + buffer->offset, out_len);
+    buffer->offset += out_len;
+    return true;
+}
+
+bool buffer_peek(const buffer_t *buffer, uint8_t *value) {
+    if (!buffer_can_read(buffer, 1u)) {
+        *value = 0;
+        return false;
+    }
+    *value = buffer->ptr[buffer->offset];
+    return true;
+}
+
+bool buffer_read_u8(buffer_t *buffer, uint8_t *value) {
+    if (!buffer_peek(buffer, value)) {
+        return false;
+    }
+    buffer->offset++;
+    return true;
+}
+
+bool buffer_read_u16(buffer_t *buffer, uint16_t *value, endianness_t endianness) {
+    if (!buffer_can_read(buffer, 2u)) {
+        *value = 0;
+        return false;
+    }
+    uint8_t const *p = buffer->ptr + buffer->offset;
+    *value = (endianness == BE) ? (uint16_t) ((p[0] << 8) | p[1]) : (uint16_t) ((p[1] << 8) | p[0]);
+    buffer->offset += 2u;
+    return true;
+}
+
+bool buffer_read_u32(buffer_t *buffer, uint32_t *value, endianness_t endianness) {
+    if (!buffer_can_read(buffer, 4u)) {
+        *value = 0;
+        return false;
+    }
+    uint8_t const *p = buffer->ptr + buffer->offset;
+    if (endianness == BE) {
+        *value = ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+    } else {
+        *value = ((uint32_t) p[3] << 24) | ((uint32_t) p[2] << 16) | ((uint32_t) p[1] << 8) | p[0];
+    }
+    buffer->offset += 4u;
+    return true;
+}
+
+/***** Read / write *****/
+
+uint16_t read_u16_be(const uint8_t *ptr, size_t offset) {
+    return (uint16_t) ((ptr[offset] << 8) | ptr[offset + 1u]);
+}
+
+uint32_t read_u32_be(const uint8_t *ptr, size_t offset) {
+    return ((uint32_t) ptr[offset] << 24) | ((uint32_t) ptr[offset + 1u] << 16) |
+           ((uint32_t) ptr[offset + 2u] << 8) | ptr[offset + 3u];
+}
+
+void write_u16_be(uint8_t *ptr, size_t offset, uint16_t value) {
+    ptr[offset] = (uint8_t) (value >> 8);
+    ptr[offset + 1u] = (uint8_t) value;
+}
+
+void write_u32_be(uint8_t *ptr, size_t offset, uint32_t value) {
+    ptr[offset] = (uint8_t) (value >> 24);
+    ptr[offset + 1u] = (uint8_t) (value >> 16);
+    ptr[offset + 2u] = (uint8_t) (value >> 8);
+    ptr[offset + 3u] = (uint8_t) value;
+}
+
+/***** Base58 *****/
+
+static const char BASE58_ALPHABET[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+#define MAX_BASE58_INPUT 120u
+
+int base58_encode(const uint8_t *in, size_t in_len, char *out, size_t out_len) {
+    uint8_t buffer[MAX_BASE58_INPUT * 138u / 100u + 1u] = {0};
+    size_t zeros = 0;
+    size_t length = 0;
+
+    if (in_len > MAX_BASE58_INPUT) {
+        return -1;
+    }
+
+    while ((zeros < in_len) && (in[zeros] == 0u)) {
+        zeros++;
+    }
+
+    for (size_t i = zeros; i < in_len; i++) {
+        uint32_t carry = in[i];
+        size_t j = 0;
+        for (; (carry != 0u) || (j < length); j++) {
+            carry += 256u * buffer[j];
+            buffer[j] = (uint8_t) (carry % 58u);
+            carry /= 58u;
+        }
+        length = j;
+    }
+
+    if ((zeros + length) >= out_len) {
+        return -1;
+    }
+
+    size_t offset = 0;
+    for (; offset < zeros; offset++) {
+        out[offset] = '1';
+    }
+    for (size_t j = 0; j < length; j++) {
+        out[offset] = BASE58_ALPHABET[buffer[length - 1u - j]];
+        offset++;
+    }
+    out[offset] = '\0';
+
+    return (int) offset;
+}
+
+/***** SHA-256 *****/
+
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u, 0x3956c25bu, 0x59f111f1u, 0x923f82a4u,
+    0xab1c5ed5u, 0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u, 0x72be5d74u, 0x80deb1feu,
+    0x9bdc06a7u, 0xc19bf174u, 0xe49b69c1u, 0xefbe4786u, 0x0fc19dc6u, 0x240ca1ccu, 0x2de92c6fu,
+    0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau, 0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u,
+    0xc6e00bf3u, 0xd5a79147u, 0x06ca6351u, 0x14292967u, 0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu,
+    0x53380d13u, 0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u, 0xa2bfe8a1u, 0xa81a664bu,
+    0xc24b8b70u, 0xc76c51a3u, 0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u, 0x19a4c116u,
+    0x1e376c08u, 0x2748774cu, 0x34b0bcb5u, 0x391c0cb3u, 0x4ed8aa4au, 0x5b9cca4fu, 0x682e6ff3u,
+    0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u, 0x90befffau, 0xa4506cebu, 0xbef9a3f7u,
+    0xc67178f2u};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32u - (n))))
+
+static void sha256_block(cx_sha256_t *ctx, const uint8_t block[64]) {
+    uint32_t w[64];
+    uint32_t s[8];
+
+    for (size_t i = 0; i < 16u; i++) {
+        w[i] = read_u32_be(block, 4u * i);
+    }
+    for (size_t i = 16; i < 64u; i++) {
+        uint32_t const s0 = ROTR(w[i - 15u], 7u) ^ ROTR(w[i - 15u], 18u) ^ (w[i - 15u] >> 3);
+        uint32_t const s1 = ROTR(w[i - 2u], 17u) ^ ROTR(w[i - 2u], 19u) ^ (w[i - 2u] >> 10);
+        w[i] = w[i - 16u] + s0 + w[i - 7u] + s1;
+    }
+
+    memcpy(s, ctx->h, sizeof(s));
+    for (size_t i = 0; i < 64u; i++) {
+        uint32_t const t1 = s[7] + (ROTR(s[4], 6u) ^ ROTR(s[4], 11u) ^ ROTR(s[4], 25u)) +
+                            ((s[4] & s[5]) ^ (~s[4] & s[6])) + SHA256_K[i] + w[i];
+        uint32_t const t2 = (ROTR(s[0], 2u) ^ ROTR(s[0], 13u) ^ ROTR(s[0], 22u)) +
+                            ((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+        memmove(s + 1, s, 7u * sizeof(uint32_t));
+        s[4] += t1;
+        s[0] = t1 + t2;
+    }
+    for (size_t i = 0; i < 8u; i++) {
+        ctx->h[i] += s[i];
+    }
+}
+
+static void sha256_init(cx_sha256_t *ctx) {
+    static const uint32_t H0[8] = {0x6a09e667u,
+                                   0xbb67ae85u,
+                                   0x3c6ef372u,
+                                   0xa54ff53au,
+                                   0x510e527fu,
+                                   0x9b05688cu,
+                                   0x1f83d9abu,
+                                   0x5be0cd19u};
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->header.algo = CX_SHA256;
+    memcpy(ctx->h, H0, sizeof(H0));
+}
+
+static void sha256_update(cx_sha256_t *ctx, const uint8_t *in, size_t len) {
+    ctx->length += len;
+    while (len != 0u) {
+        size_t n = 64u - ctx->block_len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(ctx->block + ctx->block_len, in, n);
+        ctx->block_len += n;
+        in += n;
+        len -= n;
+        if (ctx->block_len == 64u) {
+            sha256_block(ctx, ctx->block);
+            ctx->block_len = 0;
+        }
+    }
+}
+
+static void sha256_final(cx_sha256_t *ctx, uint8_t out[CX_SHA256_SIZE]) {
+    uint8_t pad[72] = {0x80u};
+    uint8_t length[8];
+    uint64_t const bits = ctx->length * 8u;
+    size_t const pad_len =
+        (ctx->block_len < 56u) ? (56u - ctx->block_len) : (120u - ctx->block_len);
+
+    write_u32_be(length, 0, (uint32_t) (bits >> 32));
+    write_u32_be(length, 4, (uint32_t) bits);
+    sha256_update(ctx, pad, pad_len);
+    sha256_update(ctx, length, sizeof(length));
+    for (size_t i = 0; i < 8u; i++) {
+        write_u32_be(out, 4u * i, ctx->h[i]);
+    }
+}
+
+size_t cx_hash_sha256(const uint8_t *in, size_t len, uint8_t *out, size_t out_len) {
+    cx_sha256_t ctx;
+    uint8_t digest[CX_SHA256_SIZE];
+
+    if (out_len < CX_SHA256_SIZE) {
+        return 0;
+    }
+    sha256_init(&ctx);
+    sha256_update(&ctx, in, len);
+    sha256_final(&ctx, digest);
+    memcpy(out, digest, sizeof(digest));
+    return CX_SHA256_SIZE;
+}
+
+cx_err_t cx_sha256_init_no_throw(cx_sha256_t *hash) {
+    if (hash == NULL) {
+        return CX_INVALID_PARAMETER;
+    }
+    sha256_init(hash);
+    return CX_OK;
+}
+
+cx_err_t cx_hash_no_throw(cx_hash_t *hash,
+                          uint32_t mode,
+                          const uint8_t *in,
+                          size_t len,
+                          uint8_t *out,
+                          size_t out_len) {
+    cx_sha256_t *const ctx = (cx_sha256_t *) hash;
+
+    if ((hash == NULL) || (hash->algo != CX_SHA256) || ((in == NULL) && (len != 0u))) {
+        return CX_INVALID_PARAMETER;
+    }
+    sha256_update(ctx, in, len);
+    if ((mode & CX_LAST) != 0u) {
+        if ((out == NULL) || (out_len < CX_SHA256_SIZE)) {
+            return CX_INVALID_PARAMETER_SIZE;
+        }
+        sha256_final(ctx, out);
+    }
+    return CX_OK;
+}
+
+/***** Big numbers *****/
+
+#define BN_MAX_SIZE  64u  ///< maximum size of a big number, in bytes
+#define BN_MAX_COUNT 8u   ///< maximum number of big numbers allocated at once
+
+/// Big numbers allocated, big endian, stored on their last bytes
+static uint8_t bn_values[BN_MAX_COUNT][BN_MAX_SIZE];
+static size_t bn_count;
+static bool bn_locked;
+
+cx_err_t cx_bn_lock(size_t word_nbytes, uint32_t flags) {
+    UNUSED(word_nbytes);
+    UNUSED(flags);
+    if (bn_locked) {
+        return CX_INTERNAL_ERROR;
+    }
+    bn_locked = true;
+    bn_count = 0;
+    return CX_OK;
+}
+
+uint32_t cx_bn_unlock(void) {
+    if (!bn_locked) {
+        return CX_INTERNAL_ERROR;
+    }
+    memset(bn_values, 0, sizeof(bn_values));
+    bn_locked = false;
+    return CX_OK;
+}
+
+bool cx_bn_is_locked(void) {
+    return bn_locked;
+}
+
+cx_err_t cx_bn_alloc(cx_bn_t *x, size_t nbytes) {
+    if (!bn_locked || (x == NULL) || (nbytes > BN_MAX_SIZE) || (bn_count >= BN_MAX_COUNT)) {
+        return CX_INTERNAL_ERROR;
+    }
+    *x = (cx_bn_t) bn_count;
+    memset(bn_values[bn_count], 0, BN_MAX_SIZE);
+    bn_count++;
+    return CX_OK;
+}
+
+cx_err_t cx_bn_alloc_init(cx_bn_t *x, size_t nbytes, const uint8_t *value, size_t value_nbytes) {
+    cx_err_t const error = cx_bn_alloc(x, nbytes);
+
+    if (error != CX_OK) {
+        return error;
+    }
+    if ((value == NULL) || (value_nbytes > nbytes)) {
+        return CX_INVALID_PARAMETER;
+    }
+    memcpy(bn_values[*x] + (BN_MAX_SIZE - value_nbytes), value, value_nbytes);
+    return CX_OK;
+}
+
+/**
+ * @brief Compares two big numbers of BN_MAX_SIZE + 1 bytes
+ */
+static int bn_cmp(uint8_t const a[BN_MAX_SIZE + 1u], uint8_t const b[BN_MAX_SIZE + 1u]) {
+    return memcmp(a, b, BN_MAX_SIZE + 1u);
+}
+
+cx_err_t cx_bn_reduce(cx_bn_t r, const cx_bn_t d, const cx_bn_t n) {
+    // Schoolbook division, bit by bit: slow but obviously right
+    uint8_t rem[BN_MAX_SIZE + 1u] = {0};
+    uint8_t mod[BN_MAX_SIZE + 1u] = {0};
+    uint8_t const zero[BN_MAX_SIZE] = {0};
+
+    if (!bn_locked || (r >= bn_count) || (d >= bn_count) || (n >= bn_count) ||
+        (memcmp(bn_values[n], zero, BN_MAX_SIZE) == 0)) {
+        return CX_INVALID_PARAMETER;
+    }
+    memcpy(mod + 1, bn_values[n], BN_MAX_SIZE);
+
+    for (size_t i = 0; i < (8u * BN_MAX_SIZE); i++) {
+        uint8_t const bit = (bn_values[d][i / 8u] >> (7u - (i % 8u))) & 1u;
+        // rem = 2 * rem + bit
+        for (size_t j = 0; j < BN_MAX_SIZE; j++) {
+            rem[j] = (uint8_t) ((rem[j] << 1) | (rem[j + 1u] >> 7));
+        }
+        rem[BN_MAX_SIZE] = (uint8_t) ((rem[BN_MAX_SIZE] << 1) | bit);
+        if (bn_cmp(rem, mod) >= 0) {
+            // rem -= mod
+            unsigned int borrow = 0;
+            for (size_t j = BN_MAX_SIZE + 1u; j-- > 0u;) {
+                unsigned int const sub = (unsigned int) mod[j] + borrow;
+                borrow = (rem[j] < sub) ? 1u : 0u;
+                rem[j] = (uint8_t) (rem[j] + (borrow << 8) - sub);
+            }
+        }
+    }
+
+    memcpy(bn_values[r], rem + 1, BN_MAX_SIZE);
+    return CX_OK;
+}
+
+cx_err_t cx_bn_export(const cx_bn_t x, uint8_t *bytes, size_t nbytes) {
+    if (!bn_locked || (x >= bn_count) || (bytes == NULL) || (nbytes > BN_MAX_SIZE)) {
+        return CX_INVALID_PARAMETER;
+    }
+    memcpy(bytes, bn_values[x] + (BN_MAX_SIZE - nbytes), nbytes);
+    return CX_OK;
+}
+
+/***** Key derivation and curves *****/
+
+void io_seproxyhal_io_heartbeat(void) {
+}
+
+cx_err_t os_derive_eip2333_no_throw(cx_curve_t curve,
+                                    const uint32_t *path,
+                                    size_t path_len,
+                                    uint8_t *private_key) {
+    return CX_INTERNAL_ERROR;
+}
+
+cx_err_t cx_ecfp_init_private_key_no_throw(cx_curve_t curve,
+                                           const uint8_t *raw_key,
+                                           size_t key_len,
+                                           cx_ecfp_private_key_t *pvkey) {
+    return CX_INTERNAL_ERROR;
+}
+
+cx_err_t cx_ecfp_generate_pair_no_throw(cx_curve_t curve,
+                                        cx_ecfp_public_key_t *pubkey,
+                                        cx_ecfp_private_key_t *privkey,
+                                        bool keepprivate) {
+    return CX_INTERNAL_ERROR;
+}
+
+cx_err_t cx_math_mult_no_throw(uint8_t *r, const uint8_t *a, const uint8_t *b, size_t len) {
+    return CX_INTERNAL_ERROR;
+}
+
+cx_err_t cx_ecdomain_parameter(cx_curve_t cv,
+                               cx_curve_domain_param_t id,
+                               uint8_t *p,
+                               uint32_t p_len) {
+    return CX_INTERNAL_ERROR;
+}
+
+cx_err_t cx_math_cmp_no_throw(const uint8_t *a, const uint8_t *b, size_t length, int *diff) {
+    return CX_INTERNAL_ERROR;
+}
+
+cx_err_t ox_bls12381_sign(const cx_ecfp_384_private_key_t *key,
+                          const uint8_t *message,
+                          size_t message_len,
+                          uint8_t *signature,
+                          size_t signature_len) {
+    return CX_INTERNAL_ERROR;
+}
+
+/***** CRC16 *****/
+
+uint16_t cx_crc16(const void *buf, size_t len) {
+    // CRC-16/CCITT-FALSE, as the SDK
+    uint8_t const *p = buf;
+    uint16_t crc = 0xFFFFu;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t) (p[i] << 8);
+        for (uint8_t bit = 0; bit < 8u; bit++) {
+            crc = ((crc & 0x8000u) != 0u) ? (uint16_t) ((crc << 1) ^ 0x1021u)
+                                          : (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
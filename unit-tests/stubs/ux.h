@@ -0,0 +1,3 @@
+/* Host stubs of the Ledger SDK: not used by the host build */
+
+#pragma once
@@ -0,0 +1,8 @@
+/* Host stubs of the Ledger SDK: big-endian writers */
+
+#pragma once
+
+#include "os.h"
+
+void write_u16_be(uint8_t *ptr, size_t offset, uint16_t value);
+void write_u32_be(uint8_t *ptr, size_t offset, uint32_t value);